@@ -13,6 +13,7 @@ protected:
   float                   eyeHeight{ OVR_DEFAULT_EYE_HEIGHT };
   float                   ipd{ OVR_DEFAULT_IPD };
   glm::mat4               player;
+  RenderQueue             sceneQueue;
 
 public:
   HelloRift() {
@@ -117,6 +118,10 @@ public:
       eyeProjections[eye] = ovr::toGlm(
           ovrMatrix4f_Projection(eyeFovPorts[eye], 0.01f, 1000.0f, true));
     });
+
+    // Decode the skybox, floor and manikin together now, rather than one
+    // at a time in the first frame
+    oria::loadSceneAssets();
   }
 
   void onKey(int key, int scancode, int action, int mods) {
@@ -168,6 +173,13 @@ public:
     ovrHmd_BeginFrame(hmd, frameIndex);
     glEnable(GL_DEPTH_TEST);
 
+    // The scene is the same for both eyes, so record it once and
+    // replay it with each eye's view
+    sceneQueue.clear();
+    Stacks::modelview().withIdentity([&]{
+      oria::queueManikinScene(sceneQueue, ipd, eyeHeight);
+    });
+
     for (int i = 0; i < 2; ++i) {
       ovrEyeType eye = hmd->EyeRenderOrder[i];
 
@@ -190,7 +202,7 @@ public:
 
   virtual void renderScene() {
     oglplus::Context::Clear().DepthBuffer().ColorBuffer();
-    oria::renderManikinScene(ipd, eyeHeight);
+    sceneQueue.execute();
   }
 };
 
@@ -14,6 +14,7 @@ struct PerEyeArg {
 
 class CubeScene_Stereo : public GlfwApp {
   PerEyeArg eyes[2];
+  RenderQueue sceneQueue;
 
 public:
   CubeScene_Stereo() {
@@ -47,14 +48,19 @@ public:
   virtual void draw() {
     oglplus::Context::Clear().ColorBuffer().DepthBuffer();
     MatrixStack & mv = Stacks::modelview();
+    // The scene is the same for both eyes, so record it once and
+    // replay it with each eye's view
+    sceneQueue.clear();
+    mv.withIdentity([&]{
+      oria::queueExampleScene(sceneQueue, OVR_DEFAULT_IPD, OVR_DEFAULT_EYE_HEIGHT);
+    });
 
     for (int i = 0; i < 2; ++i) {
       PerEyeArg & eyeArgs = eyes[i];
       viewport(EYE_SIZE, eyeArgs.viewportPosition);
       Stacks::withPush(mv, [&]{
         mv.preMultiply(eyeArgs.modelviewOffset);
-        oria::renderExampleScene(
-          OVR_DEFAULT_IPD, OVR_DEFAULT_EYE_HEIGHT);
+        sceneQueue.execute();
       });
     }
   }
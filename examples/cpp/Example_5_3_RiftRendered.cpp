@@ -11,6 +11,7 @@ class CubeScene_Rift: public RiftGlfwApp {
   ovrTexture eyeTextures[2];
 
   float ipd, eyeHeight;
+  RenderQueue sceneQueue;
 
 public:
   CubeScene_Rift() {
@@ -69,6 +70,12 @@ public:
 
     ovrHmd_BeginFrame(hmd, getFrame());
     MatrixStack & mv = Stacks::modelview();
+    // The scene is the same for both eyes, so record it once and
+    // replay it with each eye's view
+    sceneQueue.clear();
+    mv.withIdentity([&]{
+      oria::queueExampleScene(sceneQueue, ipd, eyeHeight);
+    });
     for (int i = 0; i < ovrEye_Count; ++i) {
       ovrEyeType eye = hmd->EyeRenderOrder[i];
       PerEyeArg & eyeArgs = eyes[eye];
@@ -78,7 +85,7 @@ public:
       oglplus::Context::Clear().DepthBuffer();
       Stacks::withPush(mv, [&]{
         mv.preMultiply(eyeArgs.modelviewOffset);
-        oria::renderExampleScene(ipd, eyeHeight);
+        sceneQueue.execute();
       });
     }
     ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
@@ -11,6 +11,7 @@ class CubeScene_RiftSensors : public RiftGlfwApp {
   ovrVector3f eyeOffsets[2];
 
   float ipd, eyeHeight;
+  RenderQueue sceneQueue;
 
 public:
   CubeScene_RiftSensors() {
@@ -75,17 +76,25 @@ public:
 
     ovrHmd_BeginFrame(hmd, getFrame());
     MatrixStack & mv = Stacks::modelview();
+    // The scene is the same for both eyes, so record it once and
+    // replay it with each eye's view
+    sceneQueue.clear();
+    mv.withIdentity([&]{
+      oria::queueExampleScene(sceneQueue, ipd, eyeHeight);
+    });
+    glm::mat4 views[2];
+    for_each_eye([&](ovrEyeType eye){
+      views[eye] = glm::inverse(ovr::toGlm(eyePoses[eye])) * mv.top();
+    });
+    // One visibility test covers both eyes
+    sceneQueue.cull(ovr::getStereoFrustum(hmd->DefaultEyeFov, views, 0.01f, 100));
     for (int i = 0; i < ovrEye_Count; ++i) {
       ovrEyeType eye = hmd->EyeRenderOrder[i];
       PerEyeArg & eyeArgs = eyes[eye];
-      Stacks::projection().top() = eyeArgs.projection;
 
       eyeArgs.framebuffer->Bind();
       oglplus::Context::Clear().DepthBuffer();
-      Stacks::withPush(mv, [&]{
-        mv.preMultiply(glm::inverse(ovr::toGlm(eyePoses[eye])));
-        oria::renderExampleScene(ipd, eyeHeight);
-      });
+      sceneQueue.execute(eyeArgs.projection, views[eye]);
     }
     ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
   }
@@ -55,13 +55,29 @@ public:
   }
 
 
+  virtual void update() {
+    RiftApp::update();
+    for_each_eye([&](ovrEyeType eye) {
+      ovrTexture & eyeTex = eyeTextures[eye];
+      ovrRecti & rvp = eyeTex.Header.RenderViewport;
+      const ovrSizei & texSize = eyeTex.Header.TextureSize;
+      rvp.Size.w = texSize.w * texRes;
+      rvp.Size.h = texSize.h * texRes;
+    });
+  }
+
+  // Lets F6 switch to drawing both eyes in a single pass.  The text
+  // overlay is only drawn in the two pass mode.
+  virtual bool queueScene(RenderQueue & queue) {
+    MatrixStack & mv = Stacks::modelview();
+    mv.postMultiply(glm::inverse(player));
+    oria::queueManikinScene(queue, ipd, eyeHeight);
+    return true;
+  }
+
   void renderScene() {
     int currentEye = getCurrentEye();
-    ovrTexture & eyeTex = eyeTextures[currentEye];
-    ovrRecti & rvp = eyeTex.Header.RenderViewport;
-    const ovrSizei & texSize = eyeTex.Header.TextureSize;
-    rvp.Size.w = texSize.w * texRes;
-    rvp.Size.h = texSize.h * texRes;
+    ovrRecti & rvp = eyeTextures[currentEye].Header.RenderViewport;
     glViewport(
       rvp.Pos.x, rvp.Pos.y,
       rvp.Size.w, rvp.Size.h);
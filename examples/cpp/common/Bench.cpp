@@ -0,0 +1,45 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+
+BenchReport::BenchReport(const char * outputVariable, const std::string & defaultPath,
+  const std::string & tableHeader, const std::string & csvHeader)
+  : outputVariable(outputVariable), defaultPath(defaultPath), table(tableHeader), csv(csvHeader) {
+}
+
+void BenchReport::addRow(const std::string & tableRow, const std::string & csvRow) {
+  table += tableRow;
+  csv += csvRow;
+}
+
+void BenchReport::addTableRow(const std::string & tableRow) {
+  table += tableRow;
+}
+
+bool BenchReport::save() const {
+  SAY("%s", table.c_str());
+  const char * output = getenv(outputVariable);
+  std::string outputPath = output ? output : defaultPath;
+  if (!oria::writeFile(outputPath, csv)) {
+    SAY_ERR("Unable to write %s", outputPath.c_str());
+    return false;
+  }
+  return true;
+}
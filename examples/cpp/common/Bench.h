@@ -0,0 +1,65 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * The results of one of the Example_X_*Bench programs, built up a row at
+ * a time as both an aligned table for the log and CSV.  save() logs the
+ * table and writes the CSV to the path in the given environment variable,
+ * or to the default path if it isn't set.
+ *
+ * The rows are formatted by the bench itself, since every bench has its
+ * own columns.
+ */
+class BenchReport {
+  const char * outputVariable;
+  std::string defaultPath;
+  std::string table;
+  std::string csv;
+
+public:
+  BenchReport(const char * outputVariable, const std::string & defaultPath,
+    const std::string & tableHeader, const std::string & csvHeader);
+
+  void addRow(const std::string & tableRow, const std::string & csvRow);
+  // For totals and the like, which only belong in the table
+  void addTableRow(const std::string & tableRow);
+
+  // False, after logging why, if the CSV couldn't be written
+  bool save() const;
+
+  // The best time of a number of calls to f, which keeps the numbers
+  // clear of the one-off costs of caches warming up and of the scheduler
+  template <typename Function>
+  static int64_t bestNanos(int repeats, Function f) {
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (int r = 0; r < repeats; ++r) {
+      int64_t start = Platform::elapsedNanos();
+      f();
+      best = std::min(best, Platform::elapsedNanos() - start);
+    }
+    return best;
+  }
+
+  template <typename Function>
+  static float bestMillis(int repeats, Function f) {
+    return (float)bestNanos(repeats, f) / 1e6f;
+  }
+};
@@ -27,21 +27,34 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <queue>
 #include <set>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define HAVE_SSE 1
+#include <xmmintrin.h>
+#endif
+
 #include <GL/glew.h>
 #define OGLPLUS_USE_GLEW 1
 #define OGLPLUS_USE_GLCOREARB_H 0
@@ -106,7 +119,10 @@ public:
 };
 
 #include "Platform.h"
+#include "Trace.h"
 #include "Utils.h"
+#include "JobSystem.h"
+#include "Bench.h"
 
 #include "rendering/Lights.h"
 #include "rendering/MatrixStack.h"
@@ -114,12 +130,21 @@ public:
 #include "rendering/Colors.h"
 #include "rendering/Vectors.h"
 #include "rendering/Interaction.h"
+#include "rendering/Frustum.h"
+#include "rendering/MeshOptimizer.h"
 
 #include "opengl/Constants.h"
+#include "opengl/Handles.h"
 #include "opengl/Textures.h"
+#include "opengl/TextureLoader.h"
+#include "opengl/StreamingTexture.h"
+#include "opengl/FrameTiming.h"
 #include "opengl/Shaders.h"
 #include "opengl/Framebuffer.h"
 #include "opengl/GlUtils.h"
+#include "opengl/Mesh.h"
+#include "opengl/SceneAssets.h"
+#include "opengl/RenderQueue.h"
 
 #include "glfw/GlfwUtils.h"
 #include "glfw/GlfwApp.h"
@@ -136,7 +161,13 @@ public:
 #include <OVR_CAPI_GL.h>
 
 #include "ovr/OvrUtils.h"
+#include "ovr/HeadlessBenchmark.h"
+#include "ovr/TrackingRecording.h"
+#include "ovr/PosePredictor.h"
+#include "ovr/PredictionEvaluator.h"
 #include "ovr/RiftManagerApp.h"
+#include "ovr/SinglePassStereo.h"
+#include "ovr/HiddenAreaMask.h"
 #include "ovr/RiftGlfwApp.h"
 #include "ovr/RiftApp.h"
 #include "ovr/RiftRenderingApp.h"
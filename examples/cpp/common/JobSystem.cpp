@@ -0,0 +1,356 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+class JobSystem::Job {
+public:
+  Lambda task;
+  Affinity affinity{ ANY_THREAD };
+  // Unfinished dependencies, plus one while the job is being submitted
+  std::atomic<int> blockers{ 1 };
+  std::atomic<bool> finished{ false };
+  // Whatever the task threw, rethrown to anyone waiting on it.  Only
+  // written before finished is set.
+  std::exception_ptr error;
+  std::mutex mutex;
+  JobList dependents;
+};
+
+static const char * WORKER_NAMES[] = {
+  "Worker 0", "Worker 1", "Worker 2", "Worker 3",
+  "Worker 4", "Worker 5", "Worker 6", "Worker 7",
+  "Worker 8", "Worker 9", "Worker 10", "Worker 11",
+  "Worker 12", "Worker 13", "Worker 14", "Worker 15",
+};
+
+JobSystem::JobSystem(int threadCount) {
+  if (threadCount < 0) {
+    unsigned int cores = std::thread::hardware_concurrency();
+    threadCount = cores > 1 ? cores - 1 : 1;
+  }
+  mainThread.store(std::this_thread::get_id());
+  glThread.store(std::this_thread::get_id());
+
+  for (int i = 0; i < threadCount; ++i) {
+    workers.push_back(std::unique_ptr<Worker>(new Worker()));
+  }
+  for (int i = 0; i < threadCount; ++i) {
+    workers[i]->thread = std::thread([=] {
+      workerLoop(i);
+    });
+    workers[i]->id = workers[i]->thread.get_id();
+  }
+  // The workers wait for this, so every worker's id is set before any
+  // of them can look for its own
+  {
+    Locker lock(sleepMutex);
+    started = true;
+  }
+  wake.notify_all();
+}
+
+JobSystem::~JobSystem() {
+  {
+    Locker lock(sleepMutex);
+    shuttingDown = true;
+  }
+  wake.notify_all();
+  for (auto & worker : workers) {
+    worker->thread.join();
+  }
+  // Anything still queued, with no workers left to run it
+  while (JobPtr job = take(-1)) {
+    run(job);
+  }
+}
+
+JobSystem & JobSystem::get() {
+  // Never destroyed, so objects torn down late, like a TextureLoader
+  // owned by a static, can still wait on their jobs.  The idle workers
+  // don't keep the process alive.
+  static JobSystem * instance = nullptr;
+  static std::mutex mutex;
+  std::unique_lock<std::mutex> lock(mutex);
+  if (!instance) {
+    instance = new JobSystem();
+  }
+  return *instance;
+}
+
+int JobSystem::findWorker() const {
+  std::thread::id self = std::this_thread::get_id();
+  for (size_t i = 0; i < workers.size(); ++i) {
+    if (workers[i]->id == self) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+void JobSystem::workerLoop(int index) {
+  Platform::setThreadPriority(Platform::LOW);
+  if (index < (int)(sizeof(WORKER_NAMES) / sizeof(WORKER_NAMES[0]))) {
+    Trace::setThreadName(WORKER_NAMES[index]);
+  }
+  {
+    Locker lock(sleepMutex);
+    wake.wait(lock, [&] {
+      return started;
+    });
+  }
+
+  while (true) {
+    JobPtr job = take(index);
+    if (job) {
+      run(job);
+      continue;
+    }
+    // Only stop once the queues are drained
+    Locker lock(sleepMutex);
+    if (shuttingDown) {
+      return;
+    }
+    wake.wait(lock, [&] {
+      return shuttingDown || queued > 0;
+    });
+  }
+}
+
+// The worker's own newest job first, while it's still warm in the cache,
+// then the oldest submitted from outside, then the oldest of another
+// worker's
+JobSystem::JobPtr JobSystem::take(int worker) {
+  JobPtr result;
+  if (worker >= 0) {
+    Worker & own = *workers[worker];
+    Locker lock(own.mutex);
+    if (!own.jobs.empty()) {
+      result = own.jobs.back();
+      own.jobs.pop_back();
+    }
+  }
+  if (!result) {
+    Locker lock(injectedMutex);
+    if (!injected.empty()) {
+      result = injected.front();
+      injected.pop_front();
+    }
+  }
+  // Start from the next worker along, so thieves spread out
+  size_t count = workers.size();
+  size_t first = worker >= 0 ? worker + 1 : 0;
+  for (size_t i = 0; !result && i < count; ++i) {
+    size_t index = (first + i) % count;
+    if ((int)index == worker) {
+      continue;
+    }
+    Worker & victim = *workers[index];
+    Locker lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      result = victim.jobs.front();
+      victim.jobs.pop_front();
+      ++steals;
+    }
+  }
+  if (result) {
+    --queued;
+  }
+  return result;
+}
+
+void JobSystem::schedule(const JobPtr & job) {
+  if (MAIN_THREAD == job->affinity || GL_THREAD == job->affinity) {
+    TaskQueueWrapper & queue = MAIN_THREAD == job->affinity ? mainThreadJobs : glThreadJobs;
+    queue.queueTask([=] {
+      run(job);
+    });
+    notifyWaiters();
+    return;
+  }
+
+  int worker = findWorker();
+  if (worker >= 0) {
+    Locker lock(workers[worker]->mutex);
+    workers[worker]->jobs.push_back(job);
+  } else {
+    Locker lock(injectedMutex);
+    injected.push_back(job);
+  }
+  {
+    Locker lock(sleepMutex);
+    ++queued;
+  }
+  wake.notify_one();
+  notifyWaiters();
+}
+
+void JobSystem::notifyWaiters() {
+  if (waiters > 0) {
+    {
+      Locker lock(sleepMutex);
+    }
+    progress.notify_all();
+  }
+}
+
+void JobSystem::run(const JobPtr & job) {
+  // Logged as well, since not every job is waited on
+  try {
+    job->task();
+  } catch (std::exception & error) {
+    SAY_ERR("Job failed: %s", error.what());
+    job->error = std::current_exception();
+  } catch (...) {
+    SAY_ERR("Job failed");
+    job->error = std::current_exception();
+  }
+  // Free whatever the task captured
+  job->task = Lambda();
+
+  JobList dependents;
+  {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished = true;
+    std::swap(dependents, job->dependents);
+  }
+  for (const JobPtr & dependent : dependents) {
+    if (0 == --dependent->blockers) {
+      schedule(dependent);
+    }
+  }
+  notifyWaiters();
+}
+
+JobSystem::JobPtr JobSystem::submit(Lambda task, const JobList & dependencies, Affinity affinity) {
+  JobPtr job = std::make_shared<Job>();
+  job->task = task;
+  job->affinity = affinity;
+  for (const JobPtr & dependency : dependencies) {
+    std::unique_lock<std::mutex> lock(dependency->mutex);
+    if (!dependency->finished) {
+      ++job->blockers;
+      dependency->dependents.push_back(job);
+    }
+  }
+  if (0 == --job->blockers) {
+    schedule(job);
+  }
+  return job;
+}
+
+bool JobSystem::isFinished(const JobPtr & job) {
+  return job->finished;
+}
+
+void JobSystem::wait(const JobPtr & job) {
+  wait(JobList({ job }));
+}
+
+void JobSystem::wait(const JobList & jobs) {
+  int worker = findWorker();
+  std::thread::id self = std::this_thread::get_id();
+  auto allFinished = [&] {
+    return std::all_of(jobs.begin(), jobs.end(), [](const JobPtr & job) {
+      return (bool)job->finished;
+    });
+  };
+  while (!allFinished()) {
+    if (self == mainThread.load()) {
+      runMainThreadJobs();
+    }
+    if (self == glThread.load()) {
+      runGlThreadJobs();
+    }
+    JobPtr job = take(worker);
+    if (job) {
+      run(job);
+      continue;
+    }
+    // The timeout covers jobs queued for this thread after the check
+    Locker lock(sleepMutex);
+    ++waiters;
+    progress.wait_for(lock, std::chrono::milliseconds(1), [&] {
+      return queued > 0 || allFinished();
+    });
+    --waiters;
+  }
+  for (const JobPtr & job : jobs) {
+    if (job->error) {
+      std::rethrow_exception(job->error);
+    }
+  }
+}
+
+void JobSystem::parallelFor(size_t count, RangeFunction body, size_t grain) {
+  if (!count) {
+    return;
+  }
+  grain = std::max(grain, (size_t)1);
+  // A few ranges per thread, so a thread which finishes early can steal
+  // from one which hasn't
+  size_t ranges = std::min((count + grain - 1) / grain, (workers.size() + 1) * 4);
+  if (ranges <= 1) {
+    body(0, count);
+    return;
+  }
+  JobList jobs;
+  jobs.reserve(ranges - 1);
+  for (size_t r = 1; r < ranges; ++r) {
+    size_t begin = count * r / ranges;
+    size_t end = count * (r + 1) / ranges;
+    jobs.push_back(submit([=, &body] {
+      body(begin, end);
+    }));
+  }
+  // The other ranges use body, so they must all finish before anything
+  // is thrown past it
+  std::exception_ptr error;
+  try {
+    body(0, count / ranges);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  try {
+    wait(jobs);
+  } catch (...) {
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::setMainThread() {
+  mainThread.store(std::this_thread::get_id());
+}
+
+void JobSystem::setGlThread() {
+  glThread.store(std::this_thread::get_id());
+}
+
+void JobSystem::runMainThreadJobs() {
+  mainThreadJobs.drainTaskQueue();
+}
+
+void JobSystem::runGlThreadJobs() {
+  glThreadJobs.drainTaskQueue();
+}
@@ -0,0 +1,143 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * A shared pool of worker threads for fanning work out across cores.
+ *
+ * Each worker keeps its own queue of jobs, taking the newest from the
+ * back, while idle workers steal the oldest from the front of the
+ * others' queues.  Jobs submitted from outside the pool go to a shared
+ * queue any worker can take from.  A job can depend on other jobs, and
+ * only becomes runnable once they've all finished.
+ *
+ * Jobs which must run on a particular thread, like anything touching
+ * the GL context, can be queued for the main thread or the GL thread
+ * instead.  Those threads run them by calling runMainThreadJobs() and
+ * runGlThreadJobs(), typically once per frame.
+ *
+ * Waiting for a job runs other jobs in the meantime, so a thread can
+ * wait on work it has fanned out without idling a core.  An exception
+ * thrown by a job is logged and then rethrown to whoever waits on it.
+ * Its dependents still run.
+ */
+class JobSystem {
+public:
+  enum Affinity {
+    ANY_THREAD,
+    MAIN_THREAD,
+    GL_THREAD,
+  };
+
+  class Job;
+  typedef std::shared_ptr<Job> JobPtr;
+  typedef std::vector<JobPtr> JobList;
+  // Called with a half open range of indices
+  typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+
+private:
+  typedef std::mutex Mutex;
+  typedef std::unique_lock<Mutex> Locker;
+
+  struct Worker {
+    std::deque<JobPtr> jobs;
+    Mutex mutex;
+    std::thread thread;
+    std::thread::id id;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  // Jobs submitted from threads outside the pool
+  std::deque<JobPtr> injected;
+  Mutex injectedMutex;
+
+  Mutex sleepMutex;
+  std::condition_variable wake;
+  std::condition_variable progress;
+  // Runnable jobs in the worker and injected queues
+  std::atomic<int> queued{ 0 };
+  std::atomic<int> waiters{ 0 };
+  std::atomic<size_t> steals{ 0 };
+  bool started{ false };
+  bool shuttingDown{ false };
+
+  TaskQueueWrapper mainThreadJobs;
+  TaskQueueWrapper glThreadJobs;
+  // Set again by setMainThread() and setGlThread(), which may be called
+  // while other threads are waiting on jobs
+  std::atomic<std::thread::id> mainThread;
+  std::atomic<std::thread::id> glThread;
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem & operator=(const JobSystem &) = delete;
+
+  int findWorker() const;
+  void schedule(const JobPtr & job);
+  JobPtr take(int worker);
+  void run(const JobPtr & job);
+  void notifyWaiters();
+  void workerLoop(int index);
+
+public:
+  // By default, one worker per core, less one for the thread submitting
+  // the work.  With no workers, jobs only run while some thread waits.
+  JobSystem(int threadCount = -1);
+  // Runs any jobs still queued before returning, except those queued for
+  // the main or GL thread
+  virtual ~JobSystem();
+
+  // The pool shared by the common library, created by the first call.
+  // The calling thread becomes its main and GL thread.  It lasts for the
+  // life of the process.
+  static JobSystem & get();
+
+  size_t getThreadCount() const {
+    return workers.size();
+  }
+
+  // The number of jobs taken from another worker's queue so far
+  size_t getStealCount() const {
+    return steals;
+  }
+
+  JobPtr submit(Lambda task, const JobList & dependencies = JobList(), Affinity affinity = ANY_THREAD);
+  JobPtr submit(Lambda task, Affinity affinity) {
+    return submit(task, JobList(), affinity);
+  }
+  static bool isFinished(const JobPtr & job);
+
+  // Runs other jobs until the given ones have finished.  On the main or
+  // GL thread, that includes the jobs queued for it.  Then rethrows the
+  // exception of the first job in the list which threw one.
+  void wait(const JobPtr & job);
+  void wait(const JobList & jobs);
+
+  // Splits [0, count) into ranges of at least grain indices and runs
+  // them across the pool and the calling thread, returning when they're
+  // all done.  If any range throws, the exception is rethrown once every
+  // range has finished.
+  void parallelFor(size_t count, RangeFunction body, size_t grain = 1);
+
+  // Make the calling thread the one running the main or GL thread jobs
+  void setMainThread();
+  void setGlThread();
+  void runMainThreadJobs();
+  void runGlThreadJobs();
+};
@@ -24,7 +24,9 @@
 #include <Windows.h>
 #define snprintf _snprintf
 #else
-#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <cstdarg>
@@ -38,21 +40,19 @@ void Platform::sleepMillis(int millis) {
 #endif
 }
 
+int64_t Platform::elapsedNanos() {
+  typedef std::chrono::steady_clock Clock;
+  static const Clock::time_point start = Clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    Clock::now() - start).count();
+}
+
 long Platform::elapsedMillis() {
-#ifdef OS_WIN
-  static long start = GetTickCount();
-  return GetTickCount() - start;
-#else
-  timeval time;
-  gettimeofday(&time, NULL);
-  long millis = (time.tv_sec * 1000) + (time.tv_usec / 1000);
-  static long start = millis;
-  return millis - start;
-#endif
+  return (long)(elapsedNanos() / 1000000);
 }
 
-float Platform::elapsedSeconds() {
-  return (float)elapsedMillis() / 1000.0f;
+double Platform::elapsedSeconds() {
+  return (double)elapsedNanos() / 1e9;
 }
 
 static const size_t BUFFER_SIZE = 8192;
@@ -92,12 +92,24 @@ void Platform::say(std::ostream & out, const char * message, ...) {
   out << std::string(SAY_BUFFER) << std::endl;
 }
 
+ResourceStats & Platform::getResourceStats() {
+  static ResourceStats stats;
+  return stats;
+}
+
+static void countResourceCopy(size_t size) {
+  ResourceStats & stats = Platform::getResourceStats();
+  ++stats.copies;
+  stats.bytesCopied += size;
+}
+
 std::string Platform::getResourceString(Resource resource) {
   size_t size = Resources::getResourceSize(resource);
-  char * data = new char[size];
-  Resources::getResourceData(resource, data);
-  std::string dataStr(data, size);
-  delete[] data;
+  std::string dataStr(size, '\0');
+  if (size) {
+    Resources::getResourceData(resource, &dataStr[0]);
+  }
+  countResourceCopy(size);
   return dataStr;
 }
 
@@ -105,17 +117,195 @@ std::vector<uint8_t> Platform::getResourceByteVector(Resource resource) {
   size_t size = Resources::getResourceSize(resource);
   std::vector<uint8_t> data; 
   data.resize(size);
-  Resources::getResourceData(resource, &data[0]);
+  if (size) {
+    Resources::getResourceData(resource, &data[0]);
+  }
+  countResourceCopy(size);
   return data;
 }
 
-std::stringstream && Platform::getResourceStream(Resource resource) {
-  std::string data = Platform::getResourceString(resource);
-  std::stringstream result;
-  result.str(data);
-  return std::move(result);
+ResourceView Platform::getResourceView(Resource resource) {
+  // Builds which load resources from disk get a mapping of the file, with
+  // no copies at all.  Embedded resources can only be copied out, so they
+  // cost a single read into a shared buffer.  The size check keeps a stray
+  // file with the same name from standing in for an embedded resource.
+  size_t size = Resources::getResourceSize(resource);
+  std::string path = Resources::getResourcePath(resource);
+  if (size && !path.empty()) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (file->open(path) && file->size() == size) {
+      ResourceStats & stats = getResourceStats();
+      ++stats.maps;
+      stats.bytesMapped += size;
+      const uint8_t * data = file->data();
+      return ResourceView(file, data, size);
+    }
+  }
+  return ResourceView(std::make_shared<const std::vector<uint8_t>>(
+    getResourceByteVector(resource)));
+}
+
+MappedFile::~MappedFile() {
+  close();
 }
 
+bool MappedFile::open(const std::string & path) {
+  close();
+#ifdef OS_WIN
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (INVALID_HANDLE_VALUE == file) {
+    file = nullptr;
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || 0 == fileSize.QuadPart) {
+    close();
+    return false;
+  }
+  mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (nullptr == mapping) {
+    close();
+    return false;
+  }
+  mapped = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (nullptr == mapped) {
+    close();
+    return false;
+  }
+  mappedSize = (size_t)fileSize.QuadPart;
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) || 0 == fileStat.st_size) {
+    ::close(fd);
+    return false;
+  }
+  void * result = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping holds its own reference to the file
+  ::close(fd);
+  if (MAP_FAILED == result) {
+    return false;
+  }
+  mapped = (const uint8_t *)result;
+  mappedSize = fileStat.st_size;
+#endif
+  return true;
+}
+
+void MappedFile::close() {
+#ifdef OS_WIN
+  if (mapped) {
+    UnmapViewOfFile(mapped);
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+  }
+  if (file) {
+    CloseHandle(file);
+    file = nullptr;
+  }
+#else
+  if (mapped) {
+    munmap((void *)mapped, mappedSize);
+  }
+#endif
+  mapped = nullptr;
+  mappedSize = 0;
+}
+
+// The caches hold program binaries and meshes which are loaded without
+// further checks, so they live in a directory only the current user can
+// write to.  Anything else disables the disk caches.
+static std::string rejectCacheDirectory(const std::string & path) {
+  SAY_ERR("Not using %s for caching, it isn't a private directory owned by this user", path.c_str());
+  return std::string();
+}
+
+static std::string findCacheDirectory() {
+#ifdef OS_WIN
+  // Per user, and not readable by other users by default
+  const char * base = getenv("LOCALAPPDATA");
+  if (!base || !*base) {
+    return std::string();
+  }
+  std::string path = std::string(base) + "\\OculusRiftInAction";
+  CreateDirectoryA(path.c_str(), NULL);
+  DWORD attributes = GetFileAttributesA(path.c_str());
+  if (INVALID_FILE_ATTRIBUTES == attributes
+    || !(attributes & FILE_ATTRIBUTE_DIRECTORY)
+    || (attributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+    return rejectCacheDirectory(path);
+  }
+  return path + "\\";
+#else
+  std::string base;
+  const char * xdgCache = getenv("XDG_CACHE_HOME");
+  // The spec says to ignore relative paths
+  if (xdgCache && '/' == xdgCache[0]) {
+    base = xdgCache;
+  } else {
+    const char * home = getenv("HOME");
+    if (!home || !*home) {
+      return std::string();
+    }
+    base = std::string(home) + "/.cache";
+    mkdir(base.c_str(), 0700);
+  }
+  std::string path = base + "/OculusRiftInAction";
+  mkdir(path.c_str(), 0700);
+  // lstat, so a planted symlink is rejected rather than followed
+  struct stat info;
+  if (0 != lstat(path.c_str(), &info)
+    || !S_ISDIR(info.st_mode)
+    || info.st_uid != geteuid()
+    || (info.st_mode & (S_IWGRP | S_IWOTH))) {
+    return rejectCacheDirectory(path);
+  }
+  return path + "/";
+#endif
+}
+
+// Checked once, rather than on every program and mesh load
+static std::once_flag cacheDirectoryOnce;
+static std::string cacheDirectory;
+
+std::string Platform::getCacheDirectory() {
+  std::call_once(cacheDirectoryOnce, [] {
+    cacheDirectory = findCacheDirectory();
+  });
+  return cacheDirectory;
+}
+
+static std::atomic<int> replaceFileCount{ 0 };
+
+bool Platform::replaceFile(const std::string & path, const std::string & data) {
+#ifdef OS_WIN
+  int process = (int)GetCurrentProcessId();
+#else
+  int process = (int)getpid();
+#endif
+  // Unique per writer, so threads and processes writing the same file
+  // don't interleave
+  std::string temporary = path + format(".%d.%d.tmp", process, replaceFileCount++);
+  if (!oria::writeFile(temporary, data)) {
+    remove(temporary.c_str());
+    return false;
+  }
+#ifdef OS_WIN
+  bool result = 0 != MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+  bool result = 0 == rename(temporary.c_str(), path.c_str());
+#endif
+  if (!result) {
+    remove(temporary.c_str());
+  }
+  return result;
+}
 
 std::string Platform::format(const char * fmt_str, ...) {
     int final_n, n = (int)strlen(fmt_str) * 2; /* reserve 2 times as much as the length of the fmt_str */
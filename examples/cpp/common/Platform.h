@@ -19,6 +19,111 @@
 
 #pragma once
 
+// A read-only view of the bytes of a resource.  Copies of a view share
+// the same buffer or file mapping, so decoders can hold on to one without
+// duplicating the data.
+class ResourceView {
+  std::shared_ptr<const void> owner;
+  const uint8_t * bytes{ nullptr };
+  size_t length{ 0 };
+
+public:
+  ResourceView() {}
+  explicit ResourceView(std::shared_ptr<const std::vector<uint8_t>> buffer)
+    : owner(buffer), bytes(buffer->empty() ? nullptr : &(*buffer)[0]), length(buffer->size()) {}
+  // For memory which stays valid as long as 'owner' does
+  ResourceView(std::shared_ptr<const void> owner, const uint8_t * bytes, size_t length)
+    : owner(owner), bytes(bytes), length(length) {}
+
+  const uint8_t * data() const {
+    return bytes;
+  }
+
+  size_t size() const {
+    return length;
+  }
+
+  bool empty() const {
+    return 0 == size();
+  }
+
+  const uint8_t * begin() const {
+    return data();
+  }
+
+  const uint8_t * end() const {
+    return data() + size();
+  }
+};
+
+// An input stream over memory owned by someone else, for decoders that
+// only accept a std::istream
+class MemoryStream : public std::istream {
+  struct MemoryBuffer : public std::streambuf {
+    MemoryBuffer(const void * data, size_t size) {
+      char * begin = (char*)data;
+      setg(begin, begin, begin + size);
+    }
+  };
+
+  MemoryBuffer memoryBuffer;
+
+public:
+  MemoryStream(const void * data, size_t size)
+    : std::istream(nullptr), memoryBuffer(data, size) {
+    rdbuf(&memoryBuffer);
+  }
+};
+
+// A stream that keeps the view it reads from alive
+class ResourceStream : public MemoryStream {
+  ResourceView view;
+
+public:
+  ResourceStream(const ResourceView & view)
+    : MemoryStream(view.data(), view.size()), view(view) {
+  }
+};
+
+// A read-only memory mapping of a whole file
+class MappedFile {
+  const uint8_t * mapped{ nullptr };
+  size_t mappedSize{ 0 };
+#ifdef OS_WIN
+  void * file{ nullptr };
+  void * mapping{ nullptr };
+#endif
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile & operator=(const MappedFile &) = delete;
+
+public:
+  MappedFile() {}
+  virtual ~MappedFile();
+
+  // Returns false if the file doesn't exist, is empty or can't be mapped
+  bool open(const std::string & path);
+  void close();
+
+  const uint8_t * data() const {
+    return mapped;
+  }
+
+  size_t size() const {
+    return mappedSize;
+  }
+};
+
+// Counters for how much resource data has been copied, to compare the
+// cost of startup between the different loading paths
+struct ResourceStats {
+  std::atomic<size_t> copies{ 0 };
+  std::atomic<size_t> bytesCopied{ 0 };
+  // Views served straight from a mapping of the resource file
+  std::atomic<size_t> maps{ 0 };
+  std::atomic<size_t> bytesMapped{ 0 };
+};
+
 class Platform {
 
 public:
@@ -29,14 +134,29 @@ public:
     HIGH
   };
   static void sleepMillis(int millis);
+  // All of the elapsed functions measure from the same monotonic clock,
+  // starting at the first call, so they never jump with the wall clock.
+  static int64_t elapsedNanos();
   static long elapsedMillis();
-  static float elapsedSeconds();
+  static double elapsedSeconds();
   static void fail(const char * file, int line, const char * message, ...);
   static void say(std::ostream & out, const char * message, ...);
   static std::string format(const char * formatString, ...);
   static std::string getResourceString(Resource resource);
   static std::vector<uint8_t> getResourceByteVector(Resource resource);
-  static std::stringstream && getResourceStream(Resource resource);
+  // Reads the resource once and shares the result, prefer this over the
+  // functions above when the consumer can work from a pointer and size
+  static ResourceView getResourceView(Resource resource);
+  static ResourceStats & getResourceStats();
+
+  // Returns a private, per user directory (with a trailing separator) for
+  // persistent caches, created and checked on the first call.  Empty if
+  // there's no safe directory, in which case nothing should be cached on
+  // disk
+  static std::string getCacheDirectory();
+  // Writes the data to a temporary file beside 'path' and renames it into
+  // place, so a reader sees either the old file or all of the new one
+  static bool replaceFile(const std::string & path, const std::string & data);
 
   static std::string replaceAll(const std::string & in, const std::string & from, const std::string & to);
   static void setThreadPriority(ThreadPriority priority = MEDIUM);
@@ -0,0 +1,209 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+
+struct TraceEvent {
+  std::atomic<bool> ready{ false };
+  char phase{ 0 };
+  const char * name{ nullptr };
+  uint32_t threadId{ 0 };
+  int64_t start{ 0 };
+  int64_t duration{ 0 };
+  double value{ 0 };
+};
+
+struct ThreadName {
+  std::atomic<bool> ready{ false };
+  uint32_t threadId{ 0 };
+  const char * name{ nullptr };
+};
+
+static const size_t MAX_THREAD_NAMES = 64;
+
+struct TraceBuffer {
+  // Thread names are kept across recordings, since threads usually
+  // name themselves once when they start
+  ThreadName threadNames[MAX_THREAD_NAMES];
+  std::atomic<size_t> nextThreadName{ 0 };
+  std::unique_ptr<TraceEvent[]> events;
+  size_t capacity{ 0 };
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> dropped{ 0 };
+  std::atomic<bool> recording{ false };
+};
+
+static TraceBuffer & getBuffer() {
+  static TraceBuffer buffer;
+  return buffer;
+}
+
+static uint32_t currentThreadId() {
+  return (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+// Claims a slot, or returns null if we aren't recording or are full
+static TraceEvent * claim(char phase, const char * name) {
+  TraceBuffer & buffer = getBuffer();
+  if (!buffer.recording.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  size_t index = buffer.next.fetch_add(1, std::memory_order_relaxed);
+  if (index >= buffer.capacity) {
+    ++buffer.dropped;
+    return nullptr;
+  }
+  TraceEvent * event = &buffer.events[index];
+  event->phase = phase;
+  event->name = name;
+  event->threadId = currentThreadId();
+  return event;
+}
+
+static void publish(TraceEvent * event) {
+  event->ready.store(true, std::memory_order_release);
+}
+
+void Trace::start(size_t capacity) {
+  TraceBuffer & buffer = getBuffer();
+  if (buffer.recording) {
+    return;
+  }
+  // Never reallocated, since a late writer may still hold a slot
+  if (!buffer.events) {
+    buffer.events = std::unique_ptr<TraceEvent[]>(new TraceEvent[capacity]);
+    buffer.capacity = capacity;
+  }
+  for (size_t i = 0; i < buffer.capacity; ++i) {
+    buffer.events[i].ready = false;
+  }
+  buffer.dropped = 0;
+  buffer.next = 0;
+  buffer.recording = true;
+}
+
+void Trace::stop() {
+  getBuffer().recording = false;
+}
+
+bool Trace::isRecording() {
+  return getBuffer().recording;
+}
+
+void Trace::complete(const char * name, int64_t startNanos, int64_t endNanos) {
+  TraceEvent * event = claim('X', name);
+  if (event) {
+    event->start = startNanos;
+    event->duration = endNanos - startNanos;
+    publish(event);
+  }
+}
+
+void Trace::instant(const char * name) {
+  TraceEvent * event = claim('i', name);
+  if (event) {
+    event->start = Platform::elapsedNanos();
+    publish(event);
+  }
+}
+
+void Trace::counter(const char * name, double value) {
+  TraceEvent * event = claim('C', name);
+  if (event) {
+    event->start = Platform::elapsedNanos();
+    event->value = value;
+    publish(event);
+  }
+}
+
+void Trace::setThreadName(const char * name) {
+  TraceBuffer & buffer = getBuffer();
+  size_t index = buffer.nextThreadName.fetch_add(1);
+  if (index >= MAX_THREAD_NAMES) {
+    return;
+  }
+  ThreadName & threadName = buffer.threadNames[index];
+  threadName.threadId = currentThreadId();
+  threadName.name = name;
+  threadName.ready.store(true, std::memory_order_release);
+}
+
+size_t Trace::getDroppedCount() {
+  return getBuffer().dropped;
+}
+
+std::string Trace::toJson() {
+  TraceBuffer & buffer = getBuffer();
+  size_t count = std::min(buffer.next.load(), buffer.capacity);
+  std::string result = "{ \"traceEvents\": [\n";
+  bool first = true;
+  size_t names = std::min(buffer.nextThreadName.load(), MAX_THREAD_NAMES);
+  for (size_t i = 0; i < names; ++i) {
+    const ThreadName & threadName = buffer.threadNames[i];
+    if (!threadName.ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (!first) {
+      result += ",\n";
+    }
+    first = false;
+    result += Platform::format(
+      "{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"name\": \"%s\" } }",
+      threadName.threadId, threadName.name);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const TraceEvent & event = buffer.events[i];
+    // Skip any event still being written
+    if (!event.ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (!first) {
+      result += ",\n";
+    }
+    first = false;
+    double ts = (double)event.start / 1000.0;
+    switch (event.phase) {
+    case 'X':
+      result += Platform::format(
+        "{ \"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f }",
+        event.name, event.threadId, ts, (double)event.duration / 1000.0);
+      break;
+    case 'i':
+      result += Platform::format(
+        "{ \"name\": \"%s\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f }",
+        event.name, event.threadId, ts);
+      break;
+    case 'C':
+      result += Platform::format(
+        "{ \"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"args\": { \"value\": %f } }",
+        event.name, event.threadId, ts, event.value);
+      break;
+    }
+  }
+  result += "\n], \"displayTimeUnit\": \"ms\" }\n";
+  return result;
+}
+
+bool Trace::save(const std::string & path) {
+  size_t dropped = getDroppedCount();
+  if (dropped) {
+    SAY_ERR("Trace buffer overflowed, %lu events dropped", (unsigned long)dropped);
+  }
+  return oria::writeFile(path, toJson());
+}
@@ -0,0 +1,81 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Records trace events in memory and writes them out in the Chrome trace
+ * event format, for viewing in chrome://tracing.
+ *
+ * Any thread can record events.  Recording only claims a slot with an
+ * atomic increment, so it never takes a lock.  Once the buffer is full,
+ * further events are counted as dropped.  Names are stored as pointers,
+ * so they must be string literals or otherwise outlive the recording.
+ *
+ * Call start(), stop() and save() from a single thread.
+ */
+class Trace {
+public:
+  static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+  // The capacity is fixed by the first call
+  static void start(size_t capacity = DEFAULT_CAPACITY);
+  static void stop();
+  static bool isRecording();
+
+  // Times are from Platform::elapsedNanos()
+  static void complete(const char * name, int64_t startNanos, int64_t endNanos);
+  static void instant(const char * name);
+  static void counter(const char * name, double value);
+  // Labels the calling thread in the trace viewer
+  static void setThreadName(const char * name);
+
+  static size_t getDroppedCount();
+  static std::string toJson();
+  static bool save(const std::string & path);
+};
+
+// Measures the time until it goes out of scope, recording it as a trace
+// event and optionally adding the seconds to an accumulator
+class ScopedTimer {
+  const char * name;
+  int64_t start;
+  double * accumulator;
+
+public:
+  ScopedTimer(const char * name, double * accumulator = nullptr)
+    : name(name), start(Platform::elapsedNanos()), accumulator(accumulator) {
+  }
+
+  ~ScopedTimer() {
+    int64_t end = Platform::elapsedNanos();
+    Trace::complete(name, start, end);
+    if (accumulator) {
+      *accumulator += (double)(end - start) / 1e9;
+    }
+  }
+
+  double elapsedSeconds() const {
+    return (double)(Platform::elapsedNanos() - start) / 1e9;
+  }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a ## b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ScopedTimer TRACE_CONCAT(scopedTimer, __LINE__)(name)
@@ -14,4 +14,164 @@ namespace oria {
     sstr << ins.rdbuf();
     return sstr.str();
   }
-}
\ No newline at end of file
+
+  bool writeFile(const std::string & filename, const std::string & data) {
+    using namespace std;
+    ofstream outs(filename.c_str(), ios::binary | ios::trunc);
+    if (!outs) {
+      return false;
+    }
+    outs.write(data.data(), data.size());
+    return (bool)outs;
+  }
+
+  uint64_t hash(const void * data, size_t size, uint64_t seed) {
+    const uint8_t * bytes = (const uint8_t *)data;
+    uint64_t result = seed;
+    for (size_t i = 0; i < size; ++i) {
+      result ^= bytes[i];
+      result *= 0x100000001b3ULL;
+    }
+    return result;
+  }
+
+  uint64_t hash(const std::string & data, uint64_t seed) {
+    return hash(data.data(), data.size(), seed);
+  }
+}
+
+void TaskQueueWrapper::Task::finish(bool run) {
+  Operation current = operation;
+  operation = nullptr;
+  if (current) {
+    current(storage, run);
+  }
+}
+
+TaskQueueWrapper::TaskQueueWrapper() : cells(new Cell[CAPACITY]) {
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+// Claims the next free cell, or returns false if the ring is full.  A
+// cell is free for a position once the drain has released it, one lap
+// after its previous use.
+bool TaskQueueWrapper::claim(size_t & position) {
+  position = enqueuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    Cell & cell = cells[position % CAPACITY];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (0 == difference) {
+      if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        return true;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void TaskQueueWrapper::publish(size_t position) {
+  cells[position % CAPACITY].sequence.store(position + 1, std::memory_order_release);
+}
+
+// Once a thread has had to use the overflow list, everything it queues
+// goes there until the drain empties it, so its tasks stay in order
+void TaskQueueWrapper::pushOverflow(std::unique_ptr<Task> & task) {
+  Locker lock(overflowMutex);
+  overflow.push_back(std::move(task));
+  overflowing = true;
+  ++overflowTasks;
+}
+
+// Runs the task in the next cell, if it's been written
+bool TaskQueueWrapper::runNext() {
+  size_t position = dequeuePosition.load(std::memory_order_relaxed);
+  Cell & cell = cells[position % CAPACITY];
+  if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+    return false;
+  }
+  dequeuePosition.store(position + 1, std::memory_order_relaxed);
+  try {
+    cell.task.run();
+  } catch (...) {
+    cell.sequence.store(position + CAPACITY, std::memory_order_release);
+    throw;
+  }
+  cell.sequence.store(position + CAPACITY, std::memory_order_release);
+  return true;
+}
+
+// Overflowed tasks were queued after everything in the ring from the
+// same thread, so they only run once the ring is empty
+bool TaskQueueWrapper::runNextOverflow() {
+  std::unique_ptr<Task> task;
+  {
+    Locker lock(overflowMutex);
+    if (overflow.empty() || dequeuePosition.load(std::memory_order_relaxed) != enqueuePosition.load(std::memory_order_acquire)) {
+      return false;
+    }
+    task = std::move(overflow.front());
+    overflow.pop_front();
+    if (overflow.empty()) {
+      overflowing = false;
+    }
+  }
+  task->run();
+  return true;
+}
+
+void TaskQueueWrapper::drainTaskQueue(float budgetMs) {
+  int64_t start = Platform::elapsedNanos();
+  int64_t deadline = budgetMs > 0 ? start + (int64_t)(budgetMs * 1e6f) : std::numeric_limits<int64_t>::max();
+
+  // Only the tasks queued so far
+  size_t end = enqueuePosition.load(std::memory_order_acquire);
+  size_t overflowed = 0;
+  if (overflowing) {
+    Locker lock(overflowMutex);
+    overflowed = overflow.size();
+  }
+
+  size_t run = 0;
+  while (!run || Platform::elapsedNanos() < deadline) {
+    if (dequeuePosition.load(std::memory_order_relaxed) != end) {
+      if (!runNext()) {
+        break;
+      }
+    } else if (!overflowed || !runNextOverflow()) {
+      break;
+    } else {
+      --overflowed;
+    }
+    ++run;
+  }
+
+  lastRun = run;
+  lastDrainMs = (float)(Platform::elapsedNanos() - start) / 1e6f;
+}
+
+size_t TaskQueueWrapper::getDepth() {
+  size_t dequeued = dequeuePosition.load(std::memory_order_acquire);
+  size_t enqueued = enqueuePosition.load(std::memory_order_acquire);
+  size_t result = enqueued > dequeued ? enqueued - dequeued : 0;
+  if (overflowing) {
+    Locker lock(overflowMutex);
+    result += overflow.size();
+  }
+  return result;
+}
+
+TaskQueueWrapper::Stats TaskQueueWrapper::getStats() {
+  Stats result;
+  result.depth = getDepth();
+  result.lastRun = lastRun;
+  result.lastDrainMs = lastDrainMs;
+  result.heapTasks = heapTasks;
+  result.overflowTasks = overflowTasks;
+  return result;
+}
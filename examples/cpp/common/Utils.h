@@ -2,39 +2,175 @@
 
 namespace oria {
   std::string readFile(const std::string & filename);
+  bool writeFile(const std::string & filename, const std::string & data);
+
+  // 64 bit FNV-1a hash, suitable for keying on-disk caches
+  uint64_t hash(const void * data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+  uint64_t hash(const std::string & data, uint64_t seed = 0xcbf29ce484222325ULL);
 }
 
+/**
+ * Tasks for one thread to run, queued from any number of others.
+ *
+ * Queueing doesn't lock or allocate in the usual case: tasks go into a
+ * fixed ring of slots, claimed with a compare and swap, and a task whose
+ * captures fit in INLINE_SIZE bytes is stored in its slot.  Larger tasks
+ * fall back to the heap.  If the ring fills up, tasks go to a locked
+ * overflow list until the draining thread has caught up, which keeps
+ * the tasks from each thread in order.
+ *
+ * Only one thread may drain the queue at a time.  A drain with a time
+ * budget stops once the budget is spent, leaving the remaining tasks for
+ * the next one.  It always runs at least one task, so a slow task can't
+ * stall the queue.
+ */
 class TaskQueueWrapper {
+public:
+  static const size_t CAPACITY = 256;
+  static const size_t INLINE_SIZE = 64;
+
+  struct Stats {
+    // Tasks still queued after the last drain
+    size_t depth{ 0 };
+    // Tasks run by the last drain, and how long it took
+    size_t lastRun{ 0 };
+    float lastDrainMs{ 0 };
+    // Tasks too large to store inline, and tasks queued while the ring
+    // was full, since the queue was created
+    size_t heapTasks{ 0 };
+    size_t overflowTasks{ 0 };
+  };
+
+private:
+  // Type erased storage for a callable, run or destroyed exactly once
+  class Task {
+    union Storage {
+      char bytes[INLINE_SIZE];
+      void * pointer;
+      double alignDouble;
+      long long alignLong;
+    };
+    typedef void(*Operation)(Storage & storage, bool run);
+
+    Storage storage;
+    Operation operation{ nullptr };
+
+    template <typename F>
+    static void inlineOperation(Storage & storage, bool run) {
+      F & f = *reinterpret_cast<F *>(storage.bytes);
+      struct Destroyer {
+        F & f;
+        ~Destroyer() {
+          f.~F();
+        }
+      } destroyer = { f };
+      if (run) {
+        f();
+      }
+    }
+
+    template <typename F>
+    static void heapOperation(Storage & storage, bool run) {
+      std::unique_ptr<F> f(static_cast<F *>(storage.pointer));
+      if (run) {
+        (*f)();
+      }
+    }
+
+    void finish(bool run);
+
+  public:
+    ~Task() {
+      finish(false);
+    }
+
+    // Returns false if the task had to go on the heap
+    template <typename F>
+    bool set(F && f) {
+      typedef typename std::decay<F>::type Function;
+      if (sizeof(Function) <= INLINE_SIZE &&
+        std::alignment_of<Function>::value <= std::alignment_of<Storage>::value) {
+        new (storage.bytes) Function(std::forward<F>(f));
+        operation = &inlineOperation<Function>;
+        return true;
+      }
+      storage.pointer = new Function(std::forward<F>(f));
+      operation = &heapOperation<Function>;
+      return false;
+    }
+
+    void run() {
+      finish(true);
+    }
+  };
+
+  struct Cell {
+    // Equal to the position the cell is free for, or one past it once
+    // the task is written
+    std::atomic<size_t> sequence;
+    Task task;
+  };
+
   typedef std::mutex Mutex;
   typedef std::unique_lock<Mutex> Locker;
-  typedef std::queue<Lambda> TaskQueue;
 
-  TaskQueue queue;
-  Mutex mutex;
+  std::unique_ptr<Cell[]> cells;
+  std::atomic<size_t> enqueuePosition{ 0 };
+  // Only changed by the draining thread
+  std::atomic<size_t> dequeuePosition{ 0 };
+
+  std::deque<std::unique_ptr<Task>> overflow;
+  Mutex overflowMutex;
+  std::atomic<bool> overflowing{ false };
+
+  std::atomic<size_t> heapTasks{ 0 };
+  std::atomic<size_t> overflowTasks{ 0 };
+  std::atomic<size_t> lastRun{ 0 };
+  std::atomic<float> lastDrainMs{ 0 };
+
+  TaskQueueWrapper(const TaskQueueWrapper &) = delete;
+  TaskQueueWrapper & operator=(const TaskQueueWrapper &) = delete;
+
+  bool claim(size_t & position);
+  void publish(size_t position);
+  void pushOverflow(std::unique_ptr<Task> & task);
+  bool runNext();
+  bool runNextOverflow();
 
 public:
-  void drainTaskQueue() {
-    TaskQueue copy;
-    {
-      Locker lock(mutex);
-      std::swap(copy, queue);
+  TaskQueueWrapper();
+  // Tasks still queued are destroyed without running
+  virtual ~TaskQueueWrapper() {}
+
+  // Runs the queued tasks, stopping early once the budget is spent if
+  // it's positive.  Tasks queued by the tasks it runs wait for the next
+  // drain.
+  void drainTaskQueue(float budgetMs = 0);
+
+  template <typename F>
+  void queueTask(F && task) {
+    size_t position;
+    if (!overflowing && claim(position)) {
+      if (!cells[position % CAPACITY].task.set(std::forward<F>(task))) {
+        ++heapTasks;
+      }
+      publish(position);
+      return;
     }
-    while (!copy.empty()) {
-      copy.front()();
-      copy.pop();
+    std::unique_ptr<Task> overflowTask(new Task());
+    if (!overflowTask->set(std::forward<F>(task))) {
+      ++heapTasks;
     }
+    pushOverflow(overflowTask);
   }
 
-  void queueTask(Lambda task) {
-    Locker locker(mutex);
-    queue.push(task);
-  }
-
+  // The number of tasks waiting, approximate while tasks are being queued
+  size_t getDepth();
+  Stats getStats();
 };
 
-
 class RateCounter {
-  std::vector<float> times;
+  std::vector<double> times;
 
 public:
   void reset() {
@@ -45,8 +181,7 @@ public:
     if (times.size() < 1) {
       return 0.0f;
     }
-    float elapsed = *times.rbegin() - *times.begin();
-    return elapsed;
+    return (float)(*times.rbegin() - *times.begin());
   }
 
   void increment() {
@@ -60,3 +195,78 @@ public:
     return (times.size() - 1) / elapsed();
   }
 };
+
+// Lock-free exchange of the latest value between exactly one producer
+// thread and one consumer thread.  Each side owns one of the three slots
+// and the third is swapped atomically between them, so the producer can
+// always write without waiting and the consumer always sees a complete
+// value.  The slots are reused, so a T holding buffers (like cv::Mat)
+// stops allocating once each slot has been written.
+template <typename T>
+class TripleBuffer {
+  static const uint8_t INDEX_MASK = 0x03;
+  static const uint8_t FRESH = 0x04;
+
+  T slots[3];
+  // Index of the shared slot, plus a flag marking it as not yet consumed
+  std::atomic<uint8_t> shared{ 1 };
+  uint8_t writeIndex{ 0 };
+  uint8_t readIndex{ 2 };
+
+  std::atomic<size_t> published{ 0 };
+  std::atomic<size_t> dropped{ 0 };
+  std::atomic<size_t> duplicated{ 0 };
+
+public:
+  // Producer: the slot to fill before calling publish()
+  T & back() {
+    return slots[writeIndex];
+  }
+
+  // Producer: hand the back slot over to the consumer
+  void publish() {
+    uint8_t previous = shared.exchange(writeIndex | FRESH);
+    if (previous & FRESH) {
+      // The consumer never picked up the previous value
+      ++dropped;
+    }
+    writeIndex = previous & INDEX_MASK;
+    ++published;
+  }
+
+  // Consumer: swap in the most recently published value, if there's one
+  // that hasn't been seen yet.  Returns false when front() is unchanged.
+  bool fetch() {
+    if (!(shared.load() & FRESH)) {
+      ++duplicated;
+      return false;
+    }
+    readIndex = shared.exchange(readIndex) & INDEX_MASK;
+    return true;
+  }
+
+  // Consumer: the value returned by the last successful fetch()
+  const T & front() const {
+    return slots[readIndex];
+  }
+
+  // Producer, before any other thread is using the buffer
+  template <typename F>
+  void forEachSlot(F f) {
+    std::for_each(slots, slots + 3, f);
+  }
+
+  size_t getPublishedCount() const {
+    return published;
+  }
+
+  // Values overwritten before the consumer saw them
+  size_t getDroppedCount() const {
+    return dropped;
+  }
+
+  // Consumer polls that found nothing new, so the old value was reused
+  size_t getDuplicatedCount() const {
+    return duplicated;
+  }
+};
@@ -70,6 +70,11 @@ GlfwApp::~GlfwApp() {
   }
 
 int GlfwApp::run() {
+  long startMillis = Platform::elapsedMillis();
+  // The jobs queued for the main and GL threads run here, between frames
+  JobSystem & jobs = JobSystem::get();
+  jobs.setMainThread();
+  jobs.setGlThread();
   try {
     preCreate();
     window = createRenderingTarget(windowSize, windowPosition);
@@ -90,10 +95,19 @@ int GlfwApp::run() {
 
     while (!glfwWindowShouldClose(window)) {
       glfwPollEvents();
+      jobs.runMainThreadJobs();
+      jobs.runGlThreadJobs();
       ++frame;
       update();
       draw();
       finishFrame();
+      if (1 == frame) {
+        const ResourceStats & stats = Platform::getResourceStats();
+        SAY("First frame after %ld ms, %lu resource bytes copied in %lu reads, %lu mapped in %lu views",
+          Platform::elapsedMillis() - startMillis,
+          (unsigned long)stats.bytesCopied, (unsigned long)stats.copies,
+          (unsigned long)stats.bytesMapped, (unsigned long)stats.maps);
+      }
       fpsCounter.increment();
       if (fpsCounter.elapsed() >= 2.0f) {
         fps = fpsCounter.getRate();
@@ -38,16 +38,6 @@ Font::Font(void)
 Font::~Font(void) {
 }
 
-struct TextureVertex {
-  glm::vec4 pos;
-  glm::vec4 tex;
-  TextureVertex() {
-  }
-  TextureVertex(const glm::vec2 & pos, const glm::vec2 & tex)
-      : pos(pos, 0, 0), tex(tex, 0, 0) {
-  }
-};
-
 struct QuadBuilder {
   TextureVertex vertices[4];
   QuadBuilder(const rectf & r, const rectf & tr) {
@@ -178,6 +168,29 @@ void Font::read(const void * data, size_t size) {
   GLsizei stride = (GLsizei)sizeof(TextureVertex);
   void* offset = (void*)offsetof(TextureVertex, tex);
 
+  VertexArrayAttrib(oria::Layout::Attribute::Position)
+    .Pointer(3, DataType::Float, false, stride, 0)
+    .Enable();
+
+  VertexArrayAttrib(oria::Layout::Attribute::TexCoord0)
+    .Pointer(2, DataType::Float, false, stride, (void*)offset)
+    .Enable();
+
+  // The batch VAO points at buffers whose contents are re-specified
+  // every time queued text is flushed
+  mBatchVao = VertexArrayPtr(new VertexArray());
+  mBatchVao->Bind();
+  Platform::addShutdownHook([&]{
+    mBatchVao.reset();
+    mBatchVertexBuffer.reset();
+    mBatchIndexBuffer.reset();
+  });
+
+  mBatchVertexBuffer = BufferPtr(new Buffer());
+  mBatchVertexBuffer->Bind(Buffer::Target::Array);
+  mBatchIndexBuffer = BufferPtr(new Buffer());
+  mBatchIndexBuffer->Bind(Buffer::Target::ElementArray);
+
   VertexArrayAttrib(oria::Layout::Attribute::Position)
     .Pointer(3, DataType::Float, false, stride, 0)
     .Enable();
@@ -280,83 +293,152 @@ void Font::renderString(
     glm::vec2 & cursor,
     float fontSize,
     float maxWidth) {
+  queueString(str, cursor, fontSize, maxWidth);
+  flush();
+}
+
+void Font::queueString(
+    const std::string & str,
+    glm::vec2 & cursor,
+    float fontSize,
+    float maxWidth) {
+  queueString(toUtf16(str), cursor, fontSize, maxWidth);
+}
+
+void Font::queueString(
+    const std::wstring & str,
+    glm::vec2 & cursor,
+    float fontSize,
+    float maxWidth) {
+  size_t startIndex = mBatchIndices.size();
+  layoutString(str, cursor, fontSize, maxWidth,
+    Stacks::modelview().top(), mBatchVertices, mBatchIndices);
+  size_t indexCount = mBatchIndices.size() - startIndex;
+  if (!indexCount) {
+    return;
+  }
+
+  // Strings queued under the same projection share a single draw call
+  const glm::mat4 & projection = Stacks::projection().top();
+  if (mBatchRuns.empty() || mBatchRuns.back().projection != projection) {
+    BatchRun run;
+    run.projection = projection;
+    run.indexOffset = startIndex;
+    run.indexCount = 0;
+    mBatchRuns.push_back(run);
+  }
+  mBatchRuns.back().indexCount += indexCount;
+}
+
+size_t Font::layoutString(
+    const std::wstring & str,
+    const glm::vec2 & cursor,
+    float fontSize,
+    float maxWidth,
+    const glm::mat4 & transform,
+    VertexList & outVertices,
+    IndexList & outIndices) const {
   float scale = Text::Font::DTP_TO_METERS * fontSize / mFontSize;
   bool wrap = (maxWidth == maxWidth);
   if (wrap) {
     maxWidth /= scale;
   }
 
-  MatrixStack & mv = Stacks::modelview();
-  // FIXME?
-//  size_t mvDepth = mv.size();
-//  glm::vec4 aspectTest = Stacks::projection().top() * glm::vec4(1, 1, 0, 1);
-//  float aspect = std::abs(aspectTest.x / aspectTest.y);
-  std::vector<std::wstring> tokens = Tokenize(str);
-
-  using namespace oglplus;
-  TEXT_PROGRAM->Use();
-  Uniform<vec4>(*TEXT_PROGRAM, "Color").Set(vec4(1));
-  //  Uniform<int>(*program, "Font").Set(0);
-  Mat4Uniform(*TEXT_PROGRAM, "Projection").Set(Stacks::projection().top());
-
-  mTexture->Bind(Texture::Target::_2D);
-  mVao->Bind();
+  // scale the modelview from into font units
+  glm::mat4 fontTransform = transform *
+    glm::scale(glm::translate(glm::mat4(),
+      glm::vec3(cursor + glm::vec2(0, scale * -mAscent), 0)), glm::vec3(scale));
 
-  mv.withPush([&]{
-    // scale the modelview from into font units
-    mv.translate(cursor).translate(glm::vec2(0, scale * -mAscent)).scale(scale);
+  std::vector<std::wstring> tokens = Tokenize(str);
+  size_t glyphs = 0;
+  // Stores how far we've moved from the start of the string, in DTP units
+  glm::vec2 advance;
+  for_each(tokens.begin(), tokens.end(), [&](const std::wstring & token) {
+    float tokenWidth = measureWidth(token, fontSize);
+    if (wrap && 0 != advance.x && (advance.x + tokenWidth) > maxWidth) {
+      advance.x = 0;
+      advance.y -= (mAscent + mDescent);
+    }
 
-    // Stores how far we've moved from the start of the string, in DTP units
-    glm::vec2 advance;
-    static std::wstring SPACE = toUtf16(" ");
-    for_each(tokens.begin(), tokens.end(), [&](const std::wstring & token) {
-      float tokenWidth = measureWidth(token, fontSize);
-      if (wrap && 0 != advance.x && (advance.x + tokenWidth) > maxWidth) {
+    for_each(token.begin(), token.end(), [&](::uint16_t id) {
+      if ('\n' == id) {
         advance.x = 0;
         advance.y -= (mAscent + mDescent);
+        return;
       }
 
-      for_each(token.begin(), token.end(), [&](::uint16_t id) {
-        if ('\n' == id) {
-          advance.x = 0;
-          advance.y -= (mAscent + mDescent);
+      MetricsData::const_iterator itr = mMetrics.find(id);
+      if (itr == mMetrics.end()) {
+        itr = mMetrics.find('?');
+        if (itr == mMetrics.end()) {
           return;
         }
+      }
+      const Font::Metrics & m = itr->second;
 
-        if (!contains(id)) {
-          id = '?';
-        }
+      if (wrap && ((advance.x + m.d) > maxWidth)) {
+        advance.x = 0;
+        advance.y -= (mAscent + mDescent);
+      }
 
-        // get metrics for this character to speed up measurements
-        const Font::Metrics & m = getMetrics(id);
+      // We create an offset vec2 to hold the local offset of this character
+      // This includes compensating for the inverted Y axis of the font
+      // coordinates
+      glm::vec2 offset(advance);
+      offset.y -= m.size.y;
+
+      GLuint index = (GLuint)outVertices.size();
+      QuadBuilder qb(getBounds(m, mFontSize), getTexCoords(m));
+      for (int i = 0; i < 4; ++i) {
+        TextureVertex & v = qb.vertices[i];
+        v.pos = fontTransform * glm::vec4(glm::vec2(v.pos) + offset, 0, 1);
+        outVertices.push_back(v);
+      }
+      outIndices.push_back(index + 0);
+      outIndices.push_back(index + 1);
+      outIndices.push_back(index + 2);
+      outIndices.push_back(index + 0);
+      outIndices.push_back(index + 2);
+      outIndices.push_back(index + 3);
+      ++glyphs;
+      advance.x += m.d;
+    });
+    advance.x += getMetrics(' ').d;
+  });
+  return glyphs;
+}
 
-        if (wrap && ((advance.x + m.d) > maxWidth)) {
-          advance.x = 0;
-          advance.y -= (mAscent + mDescent);
-        }
+void Font::flush() {
+  if (mBatchRuns.empty()) {
+    return;
+  }
 
-        // We create an offset vec2 to hold the local offset of this character
-        // This includes compensating for the inverted Y axis of the font
-        // coordinates
-        glm::vec2 offset(advance);
-        offset.y -= m.size.y;
-        // Bind the new position
-        mv.withPush([&]{
-          mv.translate(offset);
-          Mat4Uniform(*TEXT_PROGRAM, "ModelView").Set(mv.top());
-          // Render the item
-          glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(m.indexOffset * sizeof(GLuint)));
-        });
-        advance.x += m.d;//+ m.offset.x;// font->getAdvance(m, mFontSize);
-      });
-      advance.x += getMetrics(' ').d;
-    });
+  using namespace oglplus;
+  TEXT_PROGRAM->Use();
+  const oria::ProgramUniforms & uniforms = oria::getUniforms(*TEXT_PROGRAM);
+  glUniform4fv(uniforms.color, 1, glm::value_ptr(vec4(1)));
+  // Glyph positions are already in eye space
+  glUniformMatrix4fv(uniforms.modelView, 1, GL_FALSE, glm::value_ptr(glm::mat4()));
 
-    NoVertexArray().Bind();
-    NoProgram().Use();
+  mTexture->Bind(Texture::Target::_2D);
+  mBatchVao->Bind();
+  mBatchVertexBuffer->Bind(Buffer::Target::Array);
+  Buffer::Data(Buffer::Target::Array, mBatchVertices, BufferUsage::StreamDraw);
+  Buffer::Data(Buffer::Target::ElementArray, mBatchIndices, BufferUsage::StreamDraw);
+
+  for_each(mBatchRuns.begin(), mBatchRuns.end(), [&](const BatchRun & run) {
+    oria::setProjection(*TEXT_PROGRAM, run.projection);
+    glDrawElements(GL_TRIANGLES, (GLsizei)run.indexCount, GL_UNSIGNED_INT,
+      (void*)(run.indexOffset * sizeof(GLuint)));
+    ++mDrawCalls;
   });
 
-  //cursor.x += advance * scale;
+  NoVertexArray().Bind();
+  NoProgram().Use();
+
+  mBatchVertices.clear();
+  mBatchIndices.clear();
+  mBatchRuns.clear();
 }
 
 //rectf Font::measure(const std::wstring &text, float fontSize) const {
@@ -30,6 +30,16 @@
 
 namespace Text {
 
+struct TextureVertex {
+  glm::vec4 pos;
+  glm::vec4 tex;
+  TextureVertex() {
+  }
+  TextureVertex(const glm::vec2 & pos, const glm::vec2 & tex)
+      : pos(pos, 0, 0), tex(tex, 0, 0) {
+  }
+};
+
 class Font {
 public:
   static const float DTP_TO_METERS; // = 0.003528f;
@@ -47,6 +57,16 @@ public:
   };
 
   typedef std::unordered_map<uint16_t, Metrics> MetricsData;
+  typedef std::vector<TextureVertex> VertexList;
+  typedef std::vector<GLuint> IndexList;
+
+  // A range of queued glyph indices sharing a single projection matrix
+  struct BatchRun {
+    glm::mat4 projection;
+    size_t indexOffset;
+    size_t indexCount;
+  };
+  typedef std::vector<BatchRun> BatchRunList;
   public:
   Font();
   virtual ~Font();
@@ -133,6 +153,43 @@ public:
       float fontSize = 12.0f,
       float maxWidth = NAN);
 
+  //! lays out a string as glyph quads, pre-transformed by 'transform'.
+  //! returns the number of glyphs emitted
+  size_t layoutString(
+      const std::wstring & str,
+      const glm::vec2 & cursor,
+      float fontSize,
+      float maxWidth,
+      const glm::mat4 & transform,
+      VertexList & outVertices,
+      IndexList & outIndices) const;
+
+  //! lays out a string against the current modelview and queues it for
+  //! rendering on the next call to 'flush'
+  void queueString(
+      const std::string & str,
+      glm::vec2 & cursor,
+      float fontSize = 12.0f,
+      float maxWidth = NAN);
+
+  void queueString(
+      const std::wstring & str,
+      glm::vec2 & cursor,
+      float fontSize = 12.0f,
+      float maxWidth = NAN);
+
+  //! renders all queued strings, using one draw call per distinct projection
+  void flush();
+
+  //! the number of draw calls issued by this font since the last reset
+  size_t getDrawCallCount() const {
+    return mDrawCalls;
+  }
+
+  void resetDrawCallCount() {
+    mDrawCalls = 0;
+  }
+
 public:
   std::string mFamily;
 
@@ -148,6 +205,15 @@ public:
   glm::vec2 mTextureSize;
 
   MetricsData mMetrics;
+
+  // Streamed geometry for batched rendering
+  VertexArrayPtr mBatchVao;
+  BufferPtr mBatchVertexBuffer;
+  BufferPtr mBatchIndexBuffer;
+  VertexList mBatchVertices;
+  IndexList mBatchIndices;
+  BatchRunList mBatchRuns;
+  size_t mDrawCalls{ 0 };
 };
 
 typedef std::shared_ptr<Font> FontPtr;
@@ -0,0 +1,262 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+
+void TimingHistogram::add(float ms) {
+  samples[next] = ms;
+  next = (next + 1) % samples.size();
+  count = std::min(count + 1, samples.size());
+}
+
+void TimingHistogram::clear() {
+  next = 0;
+  count = 0;
+}
+
+float TimingHistogram::last() const {
+  if (!count) {
+    return 0;
+  }
+  return samples[(next + samples.size() - 1) % samples.size()];
+}
+
+float TimingHistogram::average() const {
+  if (!count) {
+    return 0;
+  }
+  float total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    total += samples[i];
+  }
+  return total / count;
+}
+
+float TimingHistogram::maximum() const {
+  if (!count) {
+    return 0;
+  }
+  return *std::max_element(samples.begin(), samples.begin() + count);
+}
+
+float TimingHistogram::percentile(float p) const {
+  if (!count) {
+    return 0;
+  }
+  std::vector<float> sorted(samples.begin(), samples.begin() + count);
+  size_t rank = std::min(count - 1, (size_t)(p * count));
+  std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+  return sorted[rank];
+}
+
+std::vector<float> TimingHistogram::getSamples() const {
+  std::vector<float> result;
+  result.reserve(count);
+  size_t first = (next + samples.size() - count) % samples.size();
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back(samples[(first + i) % samples.size()]);
+  }
+  return result;
+}
+
+static const char * METRIC_NAMES[FrameTiming::METRIC_COUNT] = {
+  "frameInterval",
+  "cpuFrame",
+  "leftEye",
+  "rightEye",
+  "gpuFrame",
+  "poseToEndFrame",
+  "taskDrain",
+  "taskQueueDepth",
+  "visibleItems",
+  "culledItems",
+};
+
+static const char * METRIC_UNITS[FrameTiming::METRIC_COUNT] = {
+  "ms",
+  "ms",
+  "ms",
+  "ms",
+  "ms",
+  "ms",
+  "ms",
+  "",
+  "",
+  "",
+};
+
+const char * FrameTiming::getMetricName(Metric metric) {
+  return METRIC_NAMES[metric];
+}
+
+const char * FrameTiming::getMetricUnits(Metric metric) {
+  return METRIC_UNITS[metric];
+}
+
+FrameTiming::FrameTiming() {
+  memset(queries, 0, sizeof(queries));
+  memset(queryPending, 0, sizeof(queryPending));
+}
+
+void FrameTiming::setGpuTiming(bool enabled) {
+  assert(!gpuActive);
+  gpuTiming = enabled;
+}
+
+float FrameTiming::millisBetween(const Clock::time_point & start, const Clock::time_point & end) {
+  return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void FrameTiming::beginFrame() {
+  lastFrameStart = frameStart;
+  frameStart = Clock::now();
+  if (started) {
+    histograms[FRAME_INTERVAL].add(millisBetween(lastFrameStart, frameStart));
+  }
+  started = true;
+
+  if (!gpuTiming) {
+    return;
+  }
+  if (!queriesCreated) {
+    glGenQueries(QUERY_COUNT, queries);
+    queriesCreated = true;
+  }
+  collectGpuResults();
+  // If the oldest query still hasn't come back, skip timing this frame
+  // rather than waiting for it
+  if (!queryPending[queryIndex]) {
+    glBeginQuery(GL_TIME_ELAPSED, queries[queryIndex]);
+    gpuActive = true;
+  }
+}
+
+void FrameTiming::markPoses() {
+  poseTime = Clock::now();
+}
+
+void FrameTiming::beginEye(int eye) {
+  eyeStart = Clock::now();
+}
+
+void FrameTiming::endEye(int eye) {
+  histograms[0 == eye ? LEFT_EYE : RIGHT_EYE].add(millisBetween(eyeStart, Clock::now()));
+}
+
+void FrameTiming::endRendering() {
+  if (gpuActive) {
+    glEndQuery(GL_TIME_ELAPSED);
+    queryPending[queryIndex] = true;
+    queryIndex = (queryIndex + 1) % QUERY_COUNT;
+    gpuActive = false;
+  }
+}
+
+void FrameTiming::endFrame() {
+  Clock::time_point now = Clock::now();
+  histograms[CPU_FRAME].add(millisBetween(frameStart, now));
+  histograms[POSE_TO_END_FRAME].add(millisBetween(poseTime, now));
+}
+
+void FrameTiming::recordTaskQueue(float drainMs, size_t depth) {
+  histograms[TASK_DRAIN].add(drainMs);
+  histograms[TASK_QUEUE_DEPTH].add((float)depth);
+}
+
+void FrameTiming::recordCulling(size_t visible, size_t culled) {
+  histograms[VISIBLE_ITEMS].add((float)visible);
+  histograms[CULLED_ITEMS].add((float)culled);
+}
+
+void FrameTiming::collectGpuResults() {
+  // Walk the ring from the oldest query, stopping at the first one which
+  // isn't available yet so the results stay in order
+  for (int i = 0; i < QUERY_COUNT; ++i) {
+    int index = (queryIndex + i) % QUERY_COUNT;
+    if (!queryPending[index]) {
+      continue;
+    }
+    GLint available = 0;
+    glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+    GLuint64 nanos = 0;
+    glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &nanos);
+    histograms[GPU_FRAME].add((float)nanos / 1e6f);
+    queryPending[index] = false;
+  }
+}
+
+float FrameTiming::getFps() const {
+  float interval = histograms[FRAME_INTERVAL].average();
+  return interval > 0 ? 1000.0f / interval : 0;
+}
+
+std::string FrameTiming::getSummary() const {
+  std::string result = Platform::format("FPS %0.1f\n", getFps());
+  for (int i = 0; i < METRIC_COUNT; ++i) {
+    const TimingHistogram & h = histograms[i];
+    if (!h.size()) {
+      continue;
+    }
+    result += Platform::format("%-15s %5.2f %5.2f %5.2f %s\n",
+      METRIC_NAMES[i], h.percentile(0.50f), h.percentile(0.95f), h.percentile(0.99f),
+      METRIC_UNITS[i]);
+  }
+  return result;
+}
+
+std::string FrameTiming::toCsv() const {
+  std::string result = "metric,samples,last,average,p50,p95,p99,max\n";
+  for (int i = 0; i < METRIC_COUNT; ++i) {
+    const TimingHistogram & h = histograms[i];
+    result += Platform::format("%s,%d,%f,%f,%f,%f,%f,%f\n",
+      METRIC_NAMES[i], (int)h.size(), h.last(), h.average(),
+      h.percentile(0.50f), h.percentile(0.95f), h.percentile(0.99f), h.maximum());
+  }
+  return result;
+}
+
+std::string FrameTiming::toJson() const {
+  std::string result = "{\n";
+  for (int i = 0; i < METRIC_COUNT; ++i) {
+    const TimingHistogram & h = histograms[i];
+    result += Platform::format(
+      "  \"%s\": { \"average\": %f, \"p50\": %f, \"p95\": %f, \"p99\": %f, \"max\": %f, \"samples\": [",
+      METRIC_NAMES[i], h.average(),
+      h.percentile(0.50f), h.percentile(0.95f), h.percentile(0.99f), h.maximum());
+    std::vector<float> samples = h.getSamples();
+    for (size_t j = 0; j < samples.size(); ++j) {
+      result += Platform::format(j ? ", %f" : "%f", samples[j]);
+    }
+    result += (i + 1 < METRIC_COUNT) ? "] },\n" : "] }\n";
+  }
+  result += "}\n";
+  return result;
+}
+
+void FrameTiming::shutdownGl() {
+  if (queriesCreated) {
+    glDeleteQueries(QUERY_COUNT, queries);
+    memset(queries, 0, sizeof(queries));
+    memset(queryPending, 0, sizeof(queryPending));
+    queriesCreated = false;
+  }
+}
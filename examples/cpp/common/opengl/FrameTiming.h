@@ -0,0 +1,139 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+// Keeps the most recent samples of a measurement, in milliseconds, in a
+// fixed size ring so it can run for the life of the application
+class TimingHistogram {
+  std::vector<float> samples;
+  size_t next{ 0 };
+  size_t count{ 0 };
+
+public:
+  static const size_t DEFAULT_CAPACITY = 512;
+
+  TimingHistogram(size_t capacity = DEFAULT_CAPACITY) : samples(capacity) {}
+
+  void add(float ms);
+  void clear();
+
+  size_t size() const {
+    return count;
+  }
+
+  float last() const;
+  float average() const;
+  float maximum() const;
+  // p in the range [0, 1]
+  float percentile(float p) const;
+  // The samples in the order they were taken
+  std::vector<float> getSamples() const;
+};
+
+/**
+ * Collects per frame timings for the Rift rendering loop: CPU frame time,
+ * the interval between frames, CPU time spent on each eye, GPU time for
+ * the scene via GL_TIME_ELAPSED queries, and the latency between fetching
+ * the eye poses and the SDK returning from ovrHmd_EndFrame.  Owners of a render
+ * thread task queue can also report how long it took to drain and how many
+ * tasks were left over for the next frame, and the render loop reports how
+ * many render queue items were drawn and culled.
+ *
+ * All calls must come from the thread owning the GL context.  GPU results
+ * are collected a few frames late, so the queries never stall.
+ */
+class FrameTiming {
+public:
+  enum Metric {
+    FRAME_INTERVAL,
+    CPU_FRAME,
+    LEFT_EYE,
+    RIGHT_EYE,
+    GPU_FRAME,
+    POSE_TO_END_FRAME,
+    TASK_DRAIN,
+    TASK_QUEUE_DEPTH,
+    VISIBLE_ITEMS,
+    CULLED_ITEMS,
+    METRIC_COUNT
+  };
+
+  static const char * getMetricName(Metric metric);
+  // "ms" for the timings, empty for counts
+  static const char * getMetricUnits(Metric metric);
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  static const int QUERY_COUNT = 4;
+
+  TimingHistogram histograms[METRIC_COUNT];
+  Clock::time_point frameStart;
+  Clock::time_point lastFrameStart;
+  Clock::time_point eyeStart;
+  Clock::time_point poseTime;
+  bool started{ false };
+
+  GLuint queries[QUERY_COUNT];
+  bool queryPending[QUERY_COUNT];
+  int queryIndex{ 0 };
+  bool queriesCreated{ false };
+  bool gpuActive{ false };
+  bool gpuTiming{ true };
+
+  static float millisBetween(const Clock::time_point & start, const Clock::time_point & end);
+  void collectGpuResults();
+
+public:
+  FrameTiming();
+
+  // GL_TIME_ELAPSED queries can't nest, so turn the GPU timer off when
+  // something else is timing the same frames.  Call between frames.
+  void setGpuTiming(bool enabled);
+
+  void beginFrame();
+  void markPoses();
+  void beginEye(int eye);
+  void endEye(int eye);
+  // Ends the GPU timer.  Call before submitting the frame to the SDK
+  void endRendering();
+  // Call once the frame has been submitted
+  void endFrame();
+  // Time spent running queued render thread tasks, and the tasks still
+  // pending afterwards
+  void recordTaskQueue(float drainMs, size_t depth);
+  // The render queue items drawn and culled this frame
+  void recordCulling(size_t visible, size_t culled);
+
+  const TimingHistogram & get(Metric metric) const {
+    return histograms[metric];
+  }
+
+  // Frames per second, based on the average frame interval
+  float getFps() const;
+
+  // One line per metric with samples, for the text overlay
+  std::string getSummary() const;
+  // Per metric statistics, one row each
+  std::string toCsv() const;
+  // Per metric statistics and the raw samples
+  std::string toJson() const;
+
+  void shutdownGl();
+};
@@ -26,6 +26,8 @@ struct FramebufferWrapper {
   oglplus::Framebuffer    fbo;
   oglplus::Texture        color;
   oglplus::Renderbuffer   depth;
+  // Whether the depth buffer has stencil bits as well
+  bool                    stencil{ false };
 
   FramebufferWrapper() {
   }
@@ -52,7 +54,7 @@ struct FramebufferWrapper {
       using namespace oglplus;
       Context::Bound(Renderbuffer::Target::Renderbuffer, depth)
           .Storage(
-          PixelDataInternalFormat::DepthComponent,
+          stencil ? PixelDataInternalFormat::Depth24Stencil8 : PixelDataInternalFormat::DepthComponent,
           size.x, size.y);
   }
 
@@ -60,14 +62,16 @@ struct FramebufferWrapper {
       using namespace oglplus;
       Bound([&] {
           fbo.AttachTexture(Framebuffer::Target::Draw, FramebufferAttachment::Color, color, 0);
-          fbo.AttachRenderbuffer(Framebuffer::Target::Draw, FramebufferAttachment::Depth, depth);
+          fbo.AttachRenderbuffer(Framebuffer::Target::Draw,
+            stencil ? FramebufferAttachment::DepthStencil : FramebufferAttachment::Depth, depth);
           fbo.Complete(Framebuffer::Target::Draw);
       });
   }
   
-  void init(const glm::uvec2 & size) {
+  void init(const glm::uvec2 & size, bool stencil = false) {
     using namespace oglplus;
     this->size = size;
+    this->stencil = stencil;
     initColor();
     initDepth();
     initDone();
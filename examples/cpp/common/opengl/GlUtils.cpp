@@ -105,13 +105,17 @@ namespace oglplus {
         }
       };
 
-      /// The type of the index container returned by Indices()
+      // The decoded arrays are read straight out of the importer, which
+      // is kept alive for as long as the mesh
+      std::shared_ptr<CTMimporter> _importer;
+      size_t _vert_count{ 0 };
       // vertex positions
-      std::vector<float> _pos_data;
+      const float * _pos_data{ nullptr };
       // vertex normals
-      std::vector<float> _nml_data;
+      const float * _nml_data{ nullptr };
       // vertex tex coords
-      std::vector<float> _tex_data;
+      const float * _tex_data{ nullptr };
+      /// The type of the index container returned by Indices()
       IndexArray _idx_data;
       unsigned int _prim_count;
 
@@ -145,22 +149,19 @@ namespace oglplus {
         _loading_options opts
         ) {
 
-        CTMimporter importer;
-        importer.LoadData(Platform::getResourceString(resource));
-        int vertexCount = importer.GetInteger(CTM_VERTEX_COUNT);
-        {
-          const float * ctmData = importer.GetFloatArray(CTM_VERTICES);
-          _pos_data = std::vector<float>(ctmData, ctmData + (vertexCount * 3));
-        }
+        _importer = std::make_shared<CTMimporter>();
+        CTMimporter & importer = *_importer;
+        ResourceView view = Platform::getResourceView(resource);
+        importer.LoadData(view.data(), view.size());
+        _vert_count = importer.GetInteger(CTM_VERTEX_COUNT);
+        _pos_data = importer.GetFloatArray(CTM_VERTICES);
 
         if (opts.load_texcoords && importer.GetInteger(CTM_UV_MAP_COUNT)) {
-          const float * ctmData = importer.GetFloatArray(CTM_UV_MAP_1);
-          _tex_data = std::vector<float>(ctmData, ctmData + (vertexCount * 2));
+          _tex_data = importer.GetFloatArray(CTM_UV_MAP_1);
         }
 
         if (opts.load_normals && importer.GetInteger(CTM_HAS_NORMALS)) {
-          const float * ctmData = importer.GetFloatArray(CTM_NORMALS);
-          _nml_data = std::vector<float>(ctmData, ctmData + (vertexCount * 3));
+          _nml_data = importer.GetFloatArray(CTM_NORMALS);
         }
 
         {
@@ -195,8 +196,7 @@ namespace oglplus {
       template <typename T>
       GLuint Positions(std::vector<T>& dest) const
       {
-        dest.clear();
-        dest.insert(dest.begin(), _pos_data.begin(), _pos_data.end());
+        dest.assign(_pos_data, _pos_data + _vert_count * 3);
         return 3;
       }
 
@@ -205,7 +205,9 @@ namespace oglplus {
       GLuint Normals(std::vector<T>& dest) const
       {
         dest.clear();
-        dest.insert(dest.begin(), _nml_data.begin(), _nml_data.end());
+        if (_nml_data) {
+          dest.assign(_nml_data, _nml_data + _vert_count * 3);
+        }
         return 3;
       }
 
@@ -230,7 +232,9 @@ namespace oglplus {
       GLuint TexCoordinates(std::vector<T>& dest) const
       {
         dest.clear();
-        dest.insert(dest.begin(), _tex_data.begin(), _tex_data.end());
+        if (_tex_data) {
+          dest.assign(_tex_data, _tex_data + _vert_count * 2);
+        }
         return 2;
       }
 
@@ -249,7 +253,7 @@ namespace oglplus {
           GLfloat min_x = _pos_data[3], max_x = _pos_data[3];
           GLfloat min_y = _pos_data[4], max_y = _pos_data[4];
           GLfloat min_z = _pos_data[5], max_z = _pos_data[5];
-          for (std::size_t v = 0, vn = _pos_data.size() / 3; v != vn; ++v)
+          for (std::size_t v = 0, vn = _vert_count; v != vn; ++v)
           {
             GLfloat x = _pos_data[v * 3 + 0];
             GLfloat y = _pos_data[v * 3 + 1];
@@ -323,55 +327,144 @@ namespace oria {
     return wide;
   }
 
-  Text::FontPtr getFont(Resource fontName) {
-    static std::map<Resource, Text::FontPtr> fonts;
-    if (fonts.find(fontName) == fonts.end()) {
-      std::string fontData = Platform::getResourceString(fontName);
-      Text::FontPtr result(new Text::Font());
-      result->read((const void*)fontData.data(), fontData.size());
-      fonts[fontName] = result;
+  typedef HandleTable<Text::FontPtr, FontHandle> FontTable;
+  typedef std::map<Resource, FontHandle> FontIndex;
+
+  // Resources are only looked up in the index when they're resolved,
+  // drawing and flushing go through the table
+  struct FontCache {
+    FontTable table;
+    FontIndex index;
+    FontHandle defaultFont;
+  };
+
+  static FontCache & getFontCache() {
+    static FontCache cache;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
+      Platform::addShutdownHook([&]{
+        cache.table.clear();
+        cache.index.clear();
+        cache.defaultFont = FontHandle();
+      });
+      registeredShutdown = true;
+    }
+    return cache;
+  }
+
+  FontHandle resolveFont(Resource fontName) {
+    FontCache & cache = getFontCache();
+    FontIndex::iterator itr = cache.index.find(fontName);
+    if (itr != cache.index.end()) {
+      return itr->second;
+    }
+    ResourceView fontData = Platform::getResourceView(fontName);
+    Text::FontPtr font(new Text::Font());
+    font->read((const void*)fontData.data(), fontData.size());
+    FontHandle result = cache.table.add(font);
+    cache.index[fontName] = result;
+    return result;
+  }
+
+  // An invalid handle is the default font, resolved on first use
+  const Text::FontPtr & getFont(FontHandle font) {
+    FontCache & cache = getFontCache();
+    if (!font.isValid()) {
+      if (!cache.defaultFont.isValid()) {
+        cache.defaultFont = resolveFont(Resource::FONTS_INCONSOLATA_MEDIUM_SDFF);
+      }
+      font = cache.defaultFont;
     }
-    return fonts[fontName];
+    return cache.table.get(font);
+  }
+
+  Text::FontPtr getFont(Resource fontName) {
+    return getFont(resolveFont(fontName));
   }
 
   Text::FontPtr getDefaultFont() {
-    return getFont(Resource::FONTS_INCONSOLATA_MEDIUM_SDFF);
+    return getFont(FontHandle());
   }
 
+  void renderString(const std::string & cstr, glm::vec2 & cursor,
+    float fontSize, FontHandle font) {
+    getFont(font)->renderString(toUtf16(cstr), cursor, fontSize);
+  }
 
   void renderString(const std::string & cstr, glm::vec2 & cursor,
     float fontSize, Resource fontResource) {
-    getFont(fontResource)->renderString(toUtf16(cstr), cursor, fontSize);
+    renderString(cstr, cursor, fontSize, resolveFont(fontResource));
   }
 
-  void renderString(const std::string & str, glm::vec3 & cursor3d,
+  void queueString(const std::string & cstr, glm::vec2 & cursor,
+    float fontSize, FontHandle font) {
+    getFont(font)->queueString(toUtf16(cstr), cursor, fontSize);
+  }
+
+  void queueString(const std::string & cstr, glm::vec2 & cursor,
     float fontSize, Resource fontResource) {
+    queueString(cstr, cursor, fontSize, resolveFont(fontResource));
+  }
+
+  void flushStrings() {
+    getFontCache().table.forEach([&](Text::FontPtr & font) {
+      font->flush();
+    });
+  }
+
+  void renderString(const std::string & str, glm::vec3 & cursor3d,
+    float fontSize, FontHandle font) {
     glm::vec4 target = glm::vec4(cursor3d, 0);
     target = Stacks::projection().top() * Stacks::modelview().top() * target;
     glm::vec2 newCursor(target.x, target.y);
-    renderString(str, newCursor, fontSize, fontResource);
+    renderString(str, newCursor, fontSize, font);
   }
 
-  void bindLights(ProgramPtr & program) {
-    using namespace oglplus;
+  void renderString(const std::string & str, glm::vec3 & cursor3d,
+    float fontSize, Resource fontResource) {
+    renderString(str, cursor3d, fontSize, resolveFont(fontResource));
+  }
+
+  void bindLights(oglplus::Program & program) {
     Lights & lights = Stacks::lights();
-    int count = (int)lights.lightPositions.size();
-    Uniform<vec4>(*program, "Ambient").Set(lights.ambient);
-    Uniform<int>(*program, "LightCount").Set(count);
+    const ProgramUniforms & uniforms = getUniforms(program);
+    if (uniforms.lightsBlock) {
+      updateLightsBlock(lights);
+      return;
+    }
+    int count = std::min((int)lights.lightPositions.size(), MAX_LIGHTS);
+    glUniform4fv(uniforms.ambient, 1, glm::value_ptr(lights.ambient));
+    glUniform1i(uniforms.lightCount, count);
     if (count) {
-      Uniform<Vec4f>(*program, "LightColor[0]").SetValues(count, (Vec4f*)&lights.lightColors.at(0).r);
-      Uniform<Vec4f>(*program, "LightPosition[0]").SetValues(count, (Vec4f*)&lights.lightPositions.at(0).x);
+      glUniform4fv(uniforms.lightColors, count, glm::value_ptr(lights.lightColors.at(0)));
+      glUniform4fv(uniforms.lightPositions, count, glm::value_ptr(lights.lightPositions.at(0)));
     }
   }
 
+  void bindLights(ProgramPtr & program) {
+    bindLights(*program);
+  }
+
+  // Runs the queue functions immediately, for the render functions.  The
+  // recorded model transforms already include the view.
+  template <typename F>
+  static void renderImmediate(F f) {
+    static RenderQueue queue;
+    queue.clear();
+    f(queue);
+    queue.cull(Frustum(Stacks::projection().top()));
+    queue.execute(Stacks::projection().top(), glm::mat4());
+  }
+
   typedef std::function<void()> Lambda;
   typedef std::list<Lambda> LambdaList;
   template <typename Iter>
   void renderGeometryWithLambdas(ShapeWrapperPtr & shape, ProgramPtr & program, Iter begin, const Iter & end) {
     program->Use();
 
-    Mat4Uniform(*program, "ModelView").Set(Stacks::modelview().top());
-    Mat4Uniform(*program, "Projection").Set(Stacks::projection().top());
+    const ProgramUniforms & uniforms = getUniforms(*program);
+    glUniformMatrix4fv(uniforms.modelView, 1, GL_FALSE, glm::value_ptr(Stacks::modelview().top()));
+    setProjection(*program, Stacks::projection().top());
 
     std::for_each(begin, end, [&](const std::function<void()>&f){
       f();
@@ -397,8 +490,43 @@ namespace oria {
     renderGeometryWithLambdas(shape, program, EMPTY_LIST.begin(), EMPTY_LIST.end());
   }
 
+  typedef HandleTable<ShapeWrapperPtr, ShapeHandle> ShapeTable;
+  typedef std::map<std::pair<Resource, uint32_t>, ShapeHandle> ShapeIndex;
 
-  void renderCube(const glm::vec3 & color) {
+  static ShapeTable & getShapeTable() {
+    static ShapeTable table;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
+      Platform::addShutdownHook([&]{
+        table.clear();
+      });
+      registeredShutdown = true;
+    }
+    return table;
+  }
+
+  ShapeHandle addShape(ShapeWrapperPtr shape) {
+    return getShapeTable().add(shape);
+  }
+
+  ShapeWrapperPtr & getShape(ShapeHandle handle) {
+    return getShapeTable().get(handle);
+  }
+
+  void renderGeometry(ShapeHandle shape, ProgramHandle program) {
+    renderGeometry(getShape(shape), getProgram(program));
+  }
+
+  void renderGeometry(ShapeHandle shape, ProgramHandle program, std::function<void()> lambda) {
+    renderGeometry(getShape(shape), getProgram(program), lambda);
+  }
+
+
+  // The unit cube and the unit plane / grid, centered on the origin
+  static const glm::vec4 CUBE_BOUNDS(0, 0, 0, 0.8660254f);
+  static const glm::vec4 PLANE_BOUNDS(0, 0, 0, 1.4142136f);
+
+  void queueCube(RenderQueue & queue, const glm::vec3 & color) {
     using namespace oglplus;
 
     static ProgramPtr program;
@@ -411,12 +539,16 @@ namespace oria {
         shape.reset();
       });
     }
-    program->Use();
-    Uniform<vec4>(*program, "Color").Set(vec4(color, 1));
-    renderGeometry(shape, program);
+    queue.submit(program, shape).setColor(vec4(color, 1)).setBounds(CUBE_BOUNDS);
   }
 
-  void renderColorCube() {
+  void renderCube(const glm::vec3 & color) {
+    renderImmediate([&](RenderQueue & queue) {
+      queueCube(queue, color);
+    });
+  }
+
+  void queueColorCube(RenderQueue & queue) {
     using namespace oglplus;
 
     static ProgramPtr program;
@@ -430,7 +562,13 @@ namespace oria {
       });
     }
 
-    renderGeometry(shape, program);
+    queue.submit(program, shape).setBounds(CUBE_BOUNDS);
+  }
+
+  void renderColorCube() {
+    renderImmediate([&](RenderQueue & queue) {
+      queueColorCube(queue);
+    });
   }
 
   ShapeWrapperPtr loadSkybox(ProgramPtr program) {
@@ -458,61 +596,65 @@ namespace oria {
     );
   }
 
-  void renderSkybox(Resource firstImageResource) {
+  void queueSkybox(RenderQueue & queue, TextureHandle cubemap) {
     using namespace oglplus;
 
-    static ProgramPtr program;
-    static ShapeWrapperPtr shape;
-    if (!program) {
-      program = loadProgram(Resource::SHADERS_CUBEMAP_VS, Resource::SHADERS_CUBEMAP_FS);
-      shape = ShapeWrapperPtr(new shapes::ShapeWrapper(List("Position").Get(), shapes::SkyBox(), *program));
+    static ProgramHandle program;
+    static ShapeHandle shape;
+    if (!program.isValid()) {
+      program = createProgram(Resource::SHADERS_CUBEMAP_VS, Resource::SHADERS_CUBEMAP_FS);
+      shape = addShape(ShapeWrapperPtr(new shapes::ShapeWrapper(List("Position").Get(), shapes::SkyBox(), *getProgram(program))));
       Platform::addShutdownHook([&]{
-        program.reset();
-        shape.reset();
+        program = ProgramHandle();
+        shape = ShapeHandle();
       });
     }
 
-    TexturePtr texture = loadCubemapTexture(firstImageResource);
-    texture->Bind(TextureTarget::CubeMap);
-    MatrixStack & mv = Stacks::modelview();
-    mv.withPush([&]{
-      Context::Disable(Capability::DepthTest);
-      Context::Disable(Capability::CullFace);
-      renderGeometry(shape, program);
-      Context::Enable(Capability::CullFace);
-      Context::Enable(Capability::DepthTest);
+    RenderQueue::Item & item = queue.submit(getProgram(program), getShape(shape));
+    item.setTexture(GL_TEXTURE_CUBE_MAP, GetName(*getTexture(cubemap)));
+    item.layer = RenderQueue::BACKGROUND;
+    item.state = RenderQueue::NO_DEPTH_TEST | RenderQueue::NO_CULL_FACE;
+  }
+
+  void renderSkybox(TextureHandle cubemap) {
+    renderImmediate([&](RenderQueue & queue) {
+      queueSkybox(queue, cubemap);
     });
-    DefaultTexture().Bind(TextureTarget::CubeMap);
   }
 
-  void renderFloor() {
+  void renderSkybox(Resource firstImageResource) {
+    renderSkybox(resolveCubemapTexture(firstImageResource));
+  }
+
+  void queueFloor(RenderQueue & queue) {
     using namespace oglplus;
     const float SIZE = 100;
     static ProgramPtr program;
     static ShapeWrapperPtr shape;
-    static TexturePtr texture;
     if (!program) {
       program = loadProgram(Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS);
       shape = ShapeWrapperPtr(new shapes::ShapeWrapper(List("Position")("TexCoord").Get(), shapes::Plane(), *program));
-      texture = load2dTexture(Resource::IMAGES_FLOOR_PNG);
-      Context::Bound(TextureTarget::_2D, *texture).MinFilter(TextureMinFilter::LinearMipmapNearest).GenerateMipmap();
       Platform::addShutdownHook([&]{
         program.reset();
         shape.reset();
-        texture.reset();
       });
     }
+    const TexturePtr & texture = getSceneFloor();
 
-    texture->Bind(TextureTarget::_2D);
     MatrixStack & mv = Stacks::modelview();
     mv.withPush([&]{
       mv.scale(vec3(SIZE));
-      renderGeometry(shape, program, [&]{
-        oglplus::Uniform<vec2>(*program, "UvMultiplier").Set(vec2(SIZE * 2.0f));
-      });
+      queue.submit(program, shape)
+        .setTexture(GL_TEXTURE_2D, GetName(*texture))
+        .setUvMultiplier(vec2(SIZE * 2.0f))
+        .setBounds(PLANE_BOUNDS);
     });
+  }
 
-    DefaultTexture().Bind(TextureTarget::_2D);
+  void renderFloor() {
+    renderImmediate([&](RenderQueue & queue) {
+      queueFloor(queue);
+    });
   }
 
   ShapeWrapperPtr loadShape(const std::initializer_list<const GLchar*>& names, Resource resource) {
@@ -525,45 +667,58 @@ namespace oria {
     return ShapeWrapperPtr(new shapes::ShapeWrapper(names, shapes::CtmMesh(resource), *program));
   }
 
-  void renderManikin() {
-    static ProgramPtr program;
-    static ShapeWrapperPtr shape;
-
-    if (!program) {
-      program = loadProgram(Resource::SHADERS_LIT_VS, Resource::SHADERS_LITCOLORED_FS);
-      shape = loadShape({ "Position", "Normal" }, Resource::MESHES_MANIKIN_CTM, program);
+  ShapeHandle resolveShape(const std::initializer_list<const GLchar*>& names, Resource resource, ProgramHandle program) {
+    // The vertex array binds attribute locations from the program, so a
+    // mesh is only shared between callers using the same program
+    static ShapeIndex index;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
       Platform::addShutdownHook([&]{
-        program.reset();
-        shape.reset();
+        index.clear();
       });
+      registeredShutdown = true;
     }
 
+    ShapeIndex::key_type key(resource, program.index);
+    ShapeIndex::iterator itr = index.find(key);
+    if (itr != index.end()) {
+      return itr->second;
+    }
+    ShapeHandle result = addShape(loadShape(names, resource, getProgram(program)));
+    index[key] = result;
+    return result;
+  }
 
-    renderGeometry(shape, program, [&]{
-      bindLights(program);
+  void queueManikin(RenderQueue & queue) {
+    // The mesh has faces wound both ways, so it's drawn without culling
+    queue.submit(getManikinProgram(), getManikinMesh()).state = RenderQueue::LIGHTS | RenderQueue::NO_CULL_FACE;
+  }
+
+  void renderManikin() {
+    renderImmediate([&](RenderQueue & queue) {
+      queueManikin(queue);
     });
   }
 
   void renderRift(float alpha) {
     using namespace oglplus;
     static ProgramPtr program;
-    static ShapeWrapperPtr shape;
+    static MeshPtr mesh;
     if (!program) {
       Platform::addShutdownHook([&]{
         program.reset();
-        shape.reset();
+        mesh.reset();
       });
 
       program = loadProgram(Resource::SHADERS_LIT_VS, Resource::SHADERS_LITCOLORED_FS);
-      shape = ::oria::loadShape({ "Position", "Normal" }, Resource::MESHES_RIFT_CTM, program);
+      mesh = loadMesh({ "Position", "Normal" }, Resource::MESHES_RIFT_CTM, program);
     }
 
     auto & mv = Stacks::modelview();
     mv.withPush([&]{
       mv.rotate(-HALF_PI - 0.22f, Vectors::X_AXIS).scale(0.5f);
-      renderGeometry(shape, program, [&] {
-        Uniform<float>(*program, "ForceAlpha").Set(alpha);
-        oria::bindLights(program);
+      renderImmediate([&](RenderQueue & queue) {
+        queue.submit(program, mesh).setForceAlpha(alpha).state = RenderQueue::LIGHTS;
       });
     });
   }
@@ -587,7 +742,7 @@ namespace oria {
       });
 
       program = loadProgram(Resource::SHADERS_LITMATERIALS_VS, Resource::SHADERS_LITCOLORED_FS);
-      std::stringstream && stream = Platform::getResourceStream(Resource::MESHES_ARTIFICIAL_HORIZON_OBJ);
+      ResourceStream stream(Platform::getResourceView(Resource::MESHES_ARTIFICIAL_HORIZON_OBJ));
       shapes::ObjMesh mesh(stream);
       shape = ShapeWrapperPtr(new shapes::ShapeWrapper({ "Position", "Normal", "Material" }, mesh, *program));
       Uniform<Vec4f>(*program, "Materials[0]").Set(materials);
@@ -596,35 +751,40 @@ namespace oria {
     auto & mv = Stacks::modelview();
     mv.withPush([&]{
       renderGeometry(shape, program, [&]{
-        Uniform<float>(*program, "ForceAlpha").Set(alpha);
+        glUniform1f(getUniforms(*program).forceAlpha, alpha);
         oria::bindLights(program);
       });
     });
 
   }
   
-  void renderManikinScene(float ipd, float eyeHeight) {
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
-    oria::renderFloor();
+  void queueManikinScene(RenderQueue & queue, float ipd, float eyeHeight) {
+    queueSkybox(queue, getSceneSkybox());
+    queueFloor(queue);
     
     // Scale the size of the cube to the distance between the eyes
     MatrixStack & mv = Stacks::modelview();
     
     mv.withPush([&]{
       mv.translate(glm::vec3(0, eyeHeight, 0)).scale(glm::vec3(ipd));
-      oria::renderColorCube();
+      queueColorCube(queue);
     });
     
     mv.withPush([&]{
       mv.translate(glm::vec3(0, 0, ipd * -5.0));
-      oglplus::Context::Disable(oglplus::Capability::CullFace);
-      oria::renderManikin();
+      queueManikin(queue);
     });
   }
 
-  void renderExampleScene(float ipd, float eyeHeight) {
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
-    oria::renderFloor();
+  void renderManikinScene(float ipd, float eyeHeight) {
+    renderImmediate([&](RenderQueue & queue) {
+      queueManikinScene(queue, ipd, eyeHeight);
+    });
+  }
+
+  void queueExampleScene(RenderQueue & queue, float ipd, float eyeHeight) {
+    queueSkybox(queue, getSceneSkybox());
+    queueFloor(queue);
 
     MatrixStack & mv = Stacks::modelview();
     for (int j = -1; j <= 1; j++) {
@@ -633,17 +793,23 @@ namespace oria {
           mv.translate(glm::vec3(0, 0.01, 0));
           mv.scale(glm::vec3(4));
           mv.translate(glm::vec3(j, 0, k));
-          oria::draw3dGrid();
+          queueGrid(queue);
         });
       }
     }
     mv.withPush([&]{
       mv.translate(glm::vec3(0, eyeHeight, 0)).scale(glm::vec3(ipd));
-      oria::renderColorCube();
+      queueColorCube(queue);
     });
     mv.withPush([&]{
       mv.translate(glm::vec3(0, eyeHeight / 2, 0)).scale(glm::vec3(ipd / 2, eyeHeight, ipd / 2));
-      oria::renderColorCube();
+      queueColorCube(queue);
+    });
+  }
+
+  void renderExampleScene(float ipd, float eyeHeight) {
+    renderImmediate([&](RenderQueue & queue) {
+      queueExampleScene(queue, ipd, eyeHeight);
     });
   }
 
@@ -710,7 +876,7 @@ namespace oria {
       8), *program));
   }
 
-  void draw3dGrid() {
+  void queueGrid(RenderQueue & queue) {
     static ProgramPtr program;
     static ShapeWrapperPtr grid;
     if (!program) {
@@ -721,7 +887,13 @@ namespace oria {
         grid.reset();
       });
     }
-    renderGeometry(grid, program);
+    queue.submit(program, grid).setBounds(PLANE_BOUNDS);
+  }
+
+  void draw3dGrid() {
+    renderImmediate([&](RenderQueue & queue) {
+      queueGrid(queue);
+    });
   }
 
   /*
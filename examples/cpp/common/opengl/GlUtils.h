@@ -23,6 +23,13 @@ typedef std::shared_ptr<oglplus::shapes::ShapeWrapper> ShapeWrapperPtr;
 typedef std::shared_ptr<oglplus::Buffer> BufferPtr;
 typedef std::shared_ptr<oglplus::VertexArray> VertexArrayPtr;
 
+class RenderQueue;
+
+namespace Text {
+  class Font;
+  typedef std::shared_ptr<Font> FontPtr;
+}
+
 namespace oria {
   inline void viewport(const uvec2 & size) {
     oglplus::Context::Viewport(0, 0, size.x, size.y);
@@ -33,12 +40,22 @@ namespace oria {
   ShapeWrapperPtr loadSkybox(ProgramPtr program);
   ShapeWrapperPtr loadPlane(ProgramPtr program, float aspect);
   void bindLights(ProgramPtr & program);
+  void bindLights(oglplus::Program & program);
+
+  ShapeHandle addShape(ShapeWrapperPtr shape);
+  ShapeHandle resolveShape(const std::initializer_list<const GLchar*>& names, Resource resource, ProgramHandle program);
+  ShapeWrapperPtr & getShape(ShapeHandle handle);
 
   void renderGeometry(ShapeWrapperPtr & shape, ProgramPtr & program);
   void renderGeometry(ShapeWrapperPtr & shape, ProgramPtr & program, const std::list<std::function<void()>> & list);
   void renderGeometry(ShapeWrapperPtr & shape, ProgramPtr & program, std::function<void()> lambda);
+  void renderGeometry(ShapeHandle shape, ProgramHandle program);
+  void renderGeometry(ShapeHandle shape, ProgramHandle program, std::function<void()> lambda);
   void renderCube(const glm::vec3 & color = Colors::white);
   void renderColorCube();
+  void renderSkybox(TextureHandle cubemap);
+  // Resolves the cubemap on every call, prefer the handle version when
+  // rendering each frame
   void renderSkybox(Resource firstImageResource);
   void renderFloor();
   void renderManikin();
@@ -47,13 +64,44 @@ namespace oria {
   void renderManikinScene(float ipd, float eyeHeight);
   void renderExampleScene(float ipd, float eyeHeight);
 
+  // Record the same objects as the render functions into a queue, using
+  // the current modelview matrix as the model transform.  To render a
+  // scene for both eyes, record it once against an identity modelview and
+  // execute the queue for each eye.
+  void queueCube(RenderQueue & queue, const glm::vec3 & color = Colors::white);
+  void queueColorCube(RenderQueue & queue);
+  void queueSkybox(RenderQueue & queue, TextureHandle cubemap);
+  void queueFloor(RenderQueue & queue);
+  void queueManikin(RenderQueue & queue);
+  void queueGrid(RenderQueue & queue);
+  void queueManikinScene(RenderQueue & queue, float ipd, float eyeHeight);
+  void queueExampleScene(RenderQueue & queue, float ipd, float eyeHeight);
+
+  // Resolve a font once and draw with the handle.  An invalid handle
+  // stands for the default font.
+  FontHandle resolveFont(Resource font);
+  const Text::FontPtr & getFont(FontHandle font);
+  Text::FontPtr getFont(Resource font);
+  Text::FontPtr getDefaultFont();
+
+  void renderString(const std::string & str, glm::vec2 & cursor,
+      float fontSize = 12.0f, FontHandle font = FontHandle());
   void renderString(const std::string & str, glm::vec2 & cursor,
-      float fontSize = 12.0f, Resource font =
-          Resource::FONTS_INCONSOLATA_MEDIUM_SDFF);
+      float fontSize, Resource font);
 
   void renderString(const std::string & str, glm::vec3 & cursor,
-      float fontSize = 12.0f, Resource font =
-          Resource::FONTS_INCONSOLATA_MEDIUM_SDFF);
+      float fontSize = 12.0f, FontHandle font = FontHandle());
+  void renderString(const std::string & str, glm::vec3 & cursor,
+      float fontSize, Resource font);
+
+  // Lay out a string against the current matrices without drawing it.
+  // All strings queued for a font are drawn together by flushStrings()
+  void queueString(const std::string & str, glm::vec2 & cursor,
+      float fontSize = 12.0f, FontHandle font = FontHandle());
+  void queueString(const std::string & str, glm::vec2 & cursor,
+      float fontSize, Resource font);
+
+  void flushStrings();
 
   void draw3dGrid();
   void draw3dVector(const glm::vec3 & end, const glm::vec3 & col = glm::vec3(1));
@@ -0,0 +1,86 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+namespace oria {
+
+  // A stable index into one of the global resource tables.  Resolve a
+  // Resource to a handle once during setup and then use the handle when
+  // rendering, so that the per-frame path is a plain vector index rather
+  // than a map lookup.  The tag type only exists to keep texture, program,
+  // shape and font handles from being mixed up.
+  template <typename Tag>
+  struct Handle {
+    static const uint32_t INVALID = 0xFFFFFFFF;
+    uint32_t index{ INVALID };
+
+    Handle() {}
+    explicit Handle(uint32_t index) : index(index) {}
+
+    bool isValid() const {
+      return INVALID != index;
+    }
+
+    bool operator ==(const Handle & other) const {
+      return index == other.index;
+    }
+
+    bool operator !=(const Handle & other) const {
+      return index != other.index;
+    }
+  };
+
+  typedef Handle<struct TextureTag> TextureHandle;
+  typedef Handle<struct ProgramTag> ProgramHandle;
+  typedef Handle<struct ShapeTag> ShapeHandle;
+  typedef Handle<struct FontTag> FontHandle;
+
+  // Owns the items a handle refers to.  Items are never removed
+  // individually, so a handle stays valid until the table is cleared
+  // by a shutdown hook.
+  template <typename T, typename HandleType>
+  class HandleTable {
+    std::vector<T> items;
+
+  public:
+    HandleType add(const T & item) {
+      items.push_back(item);
+      return HandleType((uint32_t)(items.size() - 1));
+    }
+
+    T & get(HandleType handle) {
+      assert(handle.isValid() && handle.index < items.size());
+      return items[handle.index];
+    }
+
+    size_t size() const {
+      return items.size();
+    }
+
+    template <typename F>
+    void forEach(F f) {
+      std::for_each(items.begin(), items.end(), f);
+    }
+
+    void clear() {
+      items.clear();
+    }
+  };
+}
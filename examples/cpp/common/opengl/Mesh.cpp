@@ -0,0 +1,361 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+#include <openctmpp.h>
+
+enum MeshAttribute {
+  MESH_POSITION,
+  MESH_NORMAL,
+  MESH_TEXCOORD,
+};
+
+static const struct {
+  const char * name;
+  GLint size;
+} MESH_ATTRIBUTES[] = {
+  { "Position", 3 },
+  { "Normal", 3 },
+  { "TexCoord", 2 },
+};
+
+static const char MESH_CACHE_MAGIC[4] = { 'O', 'R', 'M', 'C' };
+// Bump whenever the layout or the optimizations change
+static const uint32_t MESH_CACHE_VERSION = 1;
+
+// Empty if there's nowhere safe to cache
+static std::string meshCachePath(uint64_t key) {
+  std::string directory = Platform::getCacheDirectory();
+  if (directory.empty()) {
+    return directory;
+  }
+  return directory + Platform::format("%016" PRIx64 ".mesh", key);
+}
+
+template <typename T>
+static bool indicesInRange(const uint8_t * data, uint64_t count, uint32_t vertexCount) {
+  const T * indices = (const T *)data;
+  for (uint64_t i = 0; i < count; ++i) {
+    if (indices[i] >= vertexCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks everything upload() trusts, including that every index names a
+// vertex in the file, so a truncated or corrupt file is decoded again
+// rather than uploaded and drawn
+static bool isValidCache(const MappedFile & file) {
+  if (file.size() < sizeof(Mesh::CacheHeader)) {
+    return false;
+  }
+  const Mesh::CacheHeader & header = *(const Mesh::CacheHeader *)file.data();
+  if (0 != memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC))
+    || MESH_CACHE_VERSION != header.version
+    || header.attributeCount > 3) {
+    return false;
+  }
+  uint32_t stride = 0;
+  for (uint32_t i = 0; i < header.attributeCount; ++i) {
+    if (header.attributes[i] > MESH_TEXCOORD) {
+      return false;
+    }
+    stride += MESH_ATTRIBUTES[header.attributes[i]].size;
+  }
+  uint64_t indexSize;
+  switch (header.indexType) {
+  case GL_UNSIGNED_SHORT:
+    indexSize = sizeof(uint16_t);
+    break;
+  case GL_UNSIGNED_INT:
+    indexSize = sizeof(uint32_t);
+    break;
+  default:
+    return false;
+  }
+  // The counts are 32 bit, so none of these products can overflow
+  if (stride != header.stride
+    || (uint64_t)header.vertexCount * stride * sizeof(float) != header.vertexBytes
+    || (uint64_t)header.triangleCount * 3 * indexSize != header.indexBytes
+    || sizeof(header) + header.vertexBytes + header.indexBytes != file.size()) {
+    return false;
+  }
+  const uint8_t * indexData = (const uint8_t *)file.data() + sizeof(header) + header.vertexBytes;
+  uint64_t indexCount = (uint64_t)header.triangleCount * 3;
+  if (GL_UNSIGNED_SHORT == header.indexType) {
+    return indicesInRange<uint16_t>(indexData, indexCount, header.vertexCount);
+  }
+  return indicesInRange<uint32_t>(indexData, indexCount, header.vertexCount);
+}
+
+// Decodes the OpenCTM data and runs the optimizations, producing exactly
+// what gets written to the cache
+static void prepareMesh(const std::initializer_list<const GLchar*> & names, const ResourceView & view,
+    Mesh::CacheHeader & header, std::vector<float> & vertices, std::vector<uint8_t> & indexData) {
+  CTMimporter importer;
+  importer.LoadData(view.data(), view.size());
+
+  size_t vertexCount = importer.GetInteger(CTM_VERTEX_COUNT);
+  const float * sources[3] = { importer.GetFloatArray(CTM_VERTICES), nullptr, nullptr };
+  if (importer.GetInteger(CTM_HAS_NORMALS)) {
+    sources[MESH_NORMAL] = importer.GetFloatArray(CTM_NORMALS);
+  }
+  if (importer.GetInteger(CTM_UV_MAP_COUNT)) {
+    sources[MESH_TEXCOORD] = importer.GetFloatArray(CTM_UV_MAP_1);
+  }
+  size_t triangleCount = importer.GetInteger(CTM_TRIANGLE_COUNT);
+  const CTMuint * ctmIndices = importer.GetIntegerArray(CTM_INDICES);
+  std::vector<uint32_t> indices(ctmIndices, ctmIndices + triangleCount * 3);
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+  header.version = MESH_CACHE_VERSION;
+  header.vertexCount = (uint32_t)vertexCount;
+  header.triangleCount = (uint32_t)triangleCount;
+
+  // Nothing to bound, optimize or lay out, and any indices would be out of
+  // range.  This still makes a valid, empty cache entry, so the mesh isn't
+  // decoded again every time it's loaded.
+  if (0 == vertexCount) {
+    header.triangleCount = 0;
+    header.indexType = GL_UNSIGNED_SHORT;
+    vertices.clear();
+    indexData.clear();
+    return;
+  }
+
+  glm::vec3 minimum = glm::make_vec3(sources[MESH_POSITION]);
+  glm::vec3 maximum = minimum;
+  for (size_t v = 1; v < vertexCount; ++v) {
+    glm::vec3 position = glm::make_vec3(sources[MESH_POSITION] + v * 3);
+    minimum = glm::min(minimum, position);
+    maximum = glm::max(maximum, position);
+  }
+  glm::vec3 center = (minimum + maximum) / 2.0f;
+  header.bounds[0] = center.x;
+  header.bounds[1] = center.y;
+  header.bounds[2] = center.z;
+  header.bounds[3] = glm::distance(minimum, maximum) / 2.0f;
+
+  header.acmrBefore = oria::computeAcmr(indices, vertexCount);
+  oria::optimizeVertexCache(indices, vertexCount);
+  oria::optimizeOverdraw(indices, sources[MESH_POSITION], vertexCount);
+  header.acmrAfter = oria::computeAcmr(indices, vertexCount);
+  std::vector<uint32_t> remap = oria::optimizeVertexFetch(indices, vertexCount);
+
+  // Work out the interleaved layout from the requested attributes the
+  // mesh actually has
+  for (const GLchar * name : names) {
+    for (int a = MESH_POSITION; a <= MESH_TEXCOORD; ++a) {
+      if (0 == strcmp(name, MESH_ATTRIBUTES[a].name) && sources[a] && header.attributeCount < 3) {
+        header.attributes[header.attributeCount++] = a;
+        header.stride += MESH_ATTRIBUTES[a].size;
+      }
+    }
+  }
+
+  vertices.assign(vertexCount * header.stride, 0.0f);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    if (~0u == remap[v]) {
+      continue;
+    }
+    float * out = &vertices[remap[v] * header.stride];
+    for (uint32_t i = 0; i < header.attributeCount; ++i) {
+      uint32_t a = header.attributes[i];
+      GLint size = MESH_ATTRIBUTES[a].size;
+      out = std::copy(sources[a] + v * size, sources[a] + (v + 1) * size, out);
+    }
+  }
+  header.vertexBytes = vertices.size() * sizeof(float);
+
+  if (vertexCount <= 0x10000) {
+    std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+    header.indexType = GL_UNSIGNED_SHORT;
+    indexData.assign((const uint8_t *)shortIndices.data(), (const uint8_t *)(shortIndices.data() + shortIndices.size()));
+  } else {
+    header.indexType = GL_UNSIGNED_INT;
+    indexData.assign((const uint8_t *)indices.data(), (const uint8_t *)(indices.data() + indices.size()));
+  }
+  header.indexBytes = indexData.size();
+}
+
+const void * Mesh::Source::getVertexData() const {
+  return fromCache ? (const void *)(file.data() + sizeof(CacheHeader)) : (const void *)vertices.data();
+}
+
+const void * Mesh::Source::getIndexData() const {
+  return fromCache ? (const void *)(file.data() + sizeof(CacheHeader) + header.vertexBytes) : (const void *)indexData.data();
+}
+
+void Mesh::prepare(const std::initializer_list<const GLchar*> & names, Resource resource, Source & source, bool useCache) {
+  int64_t start = Platform::elapsedNanos();
+  ResourceView view = Platform::getResourceView(resource);
+  std::string requested;
+  for (const GLchar * name : names) {
+    requested += name;
+    requested += ';';
+  }
+  uint64_t key = oria::hash(requested, oria::hash(view.data(), view.size()));
+  std::string cachePath = meshCachePath(key);
+  useCache = useCache && !cachePath.empty();
+
+  if (useCache && source.file.open(cachePath) && isValidCache(source.file)) {
+    source.header = *(const CacheHeader *)source.file.data();
+    source.fromCache = true;
+  } else {
+    source.file.close();
+    source.fromCache = false;
+    prepareMesh(names, view, source.header, source.vertices, source.indexData);
+
+    if (useCache) {
+      std::string fileData((const char *)&source.header, sizeof(source.header));
+      fileData.append((const char *)source.vertices.data(), source.header.vertexBytes);
+      fileData.append((const char *)source.indexData.data(), source.header.indexBytes);
+      // Never leave a half written file for another thread or process
+      // to map
+      if (!Platform::replaceFile(cachePath, fileData)) {
+        SAY_ERR("Unable to write mesh cache file");
+      }
+    }
+  }
+  source.loadMillis = (float)(Platform::elapsedNanos() - start) / 1e6f;
+}
+
+Mesh::Mesh(const std::initializer_list<const GLchar*> & names, Resource resource, const oglplus::Program & program) {
+  int64_t start = Platform::elapsedNanos();
+  Source source;
+  prepare(names, resource, source);
+  upload(source.header, source.getVertexData(), source.getIndexData(), program);
+  stats.fromCache = source.fromCache;
+  stats.loadMillis = (float)(Platform::elapsedNanos() - start) / 1e6f;
+}
+
+Mesh::Mesh(const Source & source, const oglplus::Program & program) {
+  int64_t start = Platform::elapsedNanos();
+  upload(source.header, source.getVertexData(), source.getIndexData(), program);
+  stats.fromCache = source.fromCache;
+  stats.loadMillis = source.loadMillis + (float)(Platform::elapsedNanos() - start) / 1e6f;
+}
+
+void Mesh::upload(const CacheHeader & header, const void * vertexData, const void * indexData, const oglplus::Program & program) {
+  bounds = glm::make_vec4(header.bounds);
+  stats.vertexCount = header.vertexCount;
+  stats.triangleCount = header.triangleCount;
+  stats.acmrBefore = header.acmrBefore;
+  stats.acmrAfter = header.acmrAfter;
+  stats.vertexBytes = (size_t)header.vertexBytes;
+  stats.indexBytes = (size_t)header.indexBytes;
+  indexType = header.indexType;
+  indexCount = (GLsizei)(header.triangleCount * 3);
+
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+  glGenBuffers(1, &vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, stats.vertexBytes, vertexData, GL_STATIC_DRAW);
+
+  GLuint programName = oglplus::GetName(program);
+  size_t offset = 0;
+  for (uint32_t i = 0; i < header.attributeCount; ++i) {
+    uint32_t a = header.attributes[i];
+    GLint location = glGetAttribLocation(programName, MESH_ATTRIBUTES[a].name);
+    if (location >= 0) {
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, MESH_ATTRIBUTES[a].size, GL_FLOAT, GL_FALSE,
+        header.stride * sizeof(float), (const GLvoid*)(offset * sizeof(float)));
+    }
+    offset += MESH_ATTRIBUTES[a].size;
+  }
+
+  glGenBuffers(1, &indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, stats.indexBytes, indexData, GL_STATIC_DRAW);
+
+  // The element buffer binding is part of the vertex array state
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+Mesh::~Mesh() {
+  if (vertexArray) {
+    glDeleteVertexArrays(1, &vertexArray);
+  }
+  if (vertexBuffer) {
+    glDeleteBuffers(1, &vertexBuffer);
+  }
+  if (indexBuffer) {
+    glDeleteBuffers(1, &indexBuffer);
+  }
+}
+
+void Mesh::use() const {
+  glBindVertexArray(vertexArray);
+}
+
+void Mesh::draw(GLuint instances) const {
+  if (instances > 1) {
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, nullptr, instances);
+  } else {
+    glDrawElements(GL_TRIANGLES, indexCount, indexType, nullptr);
+  }
+}
+
+static void reportMesh(const Mesh & mesh) {
+  const Mesh::Stats & stats = mesh.getStats();
+  SAY("Mesh with %d vertices, %d triangles loaded in %0.2f ms (%s): ACMR %0.3f -> %0.3f, %d vertex bytes, %d index bytes",
+    (int)stats.vertexCount, (int)stats.triangleCount, stats.loadMillis, stats.fromCache ? "cached" : "decoded",
+    stats.acmrBefore, stats.acmrAfter, (int)stats.vertexBytes, (int)stats.indexBytes);
+}
+
+namespace oria {
+
+  MeshPtr loadMesh(const std::initializer_list<const GLchar*> & names, Resource resource, ProgramPtr program) {
+    MeshPtr result(new Mesh(names, resource, *program));
+    reportMesh(*result);
+    return result;
+  }
+
+  MeshPtr loadMesh(const Mesh::Source & source, ProgramPtr program) {
+    MeshPtr result(new Mesh(source, *program));
+    reportMesh(*result);
+    return result;
+  }
+
+  std::vector<MeshPtr> loadMeshes(const std::initializer_list<const GLchar*> & names,
+      const std::vector<Resource> & resources, ProgramPtr program) {
+    std::vector<std::unique_ptr<Mesh::Source>> sources(resources.size());
+    JobSystem::get().parallelFor(resources.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        sources[i].reset(new Mesh::Source());
+        Mesh::prepare(names, resources[i], *sources[i]);
+      }
+    });
+
+    std::vector<MeshPtr> result;
+    for (auto & source : sources) {
+      result.push_back(loadMesh(*source, program));
+      // Unmaps the cache file, or frees the decoded data
+      source.reset();
+    }
+    return result;
+  }
+
+}
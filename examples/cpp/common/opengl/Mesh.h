@@ -0,0 +1,138 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * A static triangle mesh prepared for drawing: the attributes are
+ * interleaved in a single vertex buffer, the triangles are ordered for the
+ * post-transform vertex cache and then for overdraw, the vertices are
+ * ordered for fetching, and the indices are 16 bit whenever the vertex
+ * count allows.
+ *
+ * Preparing a mesh means decoding the OpenCTM data and running the
+ * optimizations, so the result is kept in a binary file in the cache
+ * directory, keyed by a hash of the resource and the requested
+ * attributes.  Later loads map that file and upload straight from it.
+ *
+ * Loading is split in two: the Source is prepared on any thread, and only
+ * the upload needs the context, so several meshes can be prepared in
+ * parallel with oria::loadMeshes.
+ *
+ * Meshes can be submitted to a RenderQueue in place of a ShapeWrapper.
+ */
+class Mesh {
+public:
+  struct Stats {
+    size_t vertexCount{ 0 };
+    size_t triangleCount{ 0 };
+    // Average cache misses per triangle, as loaded and as drawn
+    float acmrBefore{ 0 };
+    float acmrAfter{ 0 };
+    size_t vertexBytes{ 0 };
+    size_t indexBytes{ 0 };
+    // Whether the mesh came from the cache, and how long loading took
+    // either way, including the upload
+    bool fromCache{ false };
+    float loadMillis{ 0 };
+  };
+
+  // The header of a cached mesh, followed by the vertex and index data
+  struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    // In floats
+    uint32_t stride;
+    uint32_t attributeCount;
+    uint32_t attributes[3];
+    uint32_t indexType;
+    float bounds[4];
+    float acmrBefore;
+    float acmrAfter;
+    uint64_t vertexBytes;
+    uint64_t indexBytes;
+  };
+
+  // A prepared mesh, either mapped from the cache or freshly decoded
+  struct Source {
+    CacheHeader header;
+    MappedFile file;
+    std::vector<float> vertices;
+    std::vector<uint8_t> indexData;
+    bool fromCache{ false };
+    float loadMillis{ 0 };
+
+    const void * getVertexData() const;
+    const void * getIndexData() const;
+  };
+
+private:
+  GLuint vertexArray{ 0 };
+  GLuint vertexBuffer{ 0 };
+  GLuint indexBuffer{ 0 };
+  GLenum indexType{ GL_UNSIGNED_INT };
+  GLsizei indexCount{ 0 };
+  // A bounding sphere, with the radius in w
+  glm::vec4 bounds;
+  Stats stats;
+
+  Mesh(const Mesh &) = delete;
+  Mesh & operator=(const Mesh &) = delete;
+
+  void upload(const CacheHeader & header, const void * vertexData, const void * indexData, const oglplus::Program & program);
+
+public:
+  // Loads an OpenCTM mesh.  names picks the attributes to upload, out of
+  // "Position", "Normal" and "TexCoord", which are bound to the program's
+  // attributes of the same name.
+  Mesh(const std::initializer_list<const GLchar*> & names, Resource resource, const oglplus::Program & program);
+  Mesh(const Source & source, const oglplus::Program & program);
+  virtual ~Mesh();
+
+  // Prepares a mesh from the cache, or by decoding it and writing the
+  // result to the cache.  Safe to call from any thread.  Without the
+  // cache, it always decodes and writes nothing.
+  static void prepare(const std::initializer_list<const GLchar*> & names, Resource resource,
+    Source & source, bool useCache = true);
+
+  void use() const;
+  void draw(GLuint instances = 1) const;
+
+  const glm::vec4 & getBounds() const {
+    return bounds;
+  }
+
+  const Stats & getStats() const {
+    return stats;
+  }
+};
+
+typedef std::shared_ptr<Mesh> MeshPtr;
+
+namespace oria {
+  MeshPtr loadMesh(const std::initializer_list<const GLchar*> & names, Resource resource, ProgramPtr program);
+  // Uploads a mesh prepared with Mesh::prepare, which needs the context
+  MeshPtr loadMesh(const Mesh::Source & source, ProgramPtr program);
+  // Prepares the meshes in parallel on the JobSystem, then uploads them
+  // on the calling thread
+  std::vector<MeshPtr> loadMeshes(const std::initializer_list<const GLchar*> & names,
+    const std::vector<Resource> & resources, ProgramPtr program);
+}
@@ -0,0 +1,299 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+
+RenderQueue::Item & RenderQueue::submit(const ProgramPtr & program, const ShapeWrapperPtr & shape) {
+  items.push_back(Item());
+  Item & item = items.back();
+  item.program = program.get();
+  item.shape = shape.get();
+  item.model = Stacks::modelview().top();
+  sorted = false;
+  boundsValid = false;
+  culled = false;
+  return item;
+}
+
+RenderQueue::Item & RenderQueue::submit(const ProgramPtr & program, const MeshPtr & mesh) {
+  Item & item = submit(program, ShapeWrapperPtr());
+  item.mesh = mesh.get();
+  item.bounds = mesh->getBounds();
+  return item;
+}
+
+void RenderQueue::clear() {
+  items.clear();
+  sorted = true;
+  boundsValid = false;
+  culled = false;
+}
+
+// Below this many items, handing the work out costs more than it saves
+static const size_t PARALLEL_CULL_THRESHOLD = 4096;
+
+void RenderQueue::cull(const Frustum & frustum) {
+  sort();
+  size_t count = items.size();
+  visible.resize(count);
+  bool parallel = count >= PARALLEL_CULL_THRESHOLD;
+  if (!boundsValid) {
+    worldBounds.resize(count);
+    auto transform = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        worldBounds[i] = Frustum::transform(items[i].model, items[i].bounds);
+      }
+    };
+    if (parallel) {
+      JobSystem::get().parallelFor(count, transform, PARALLEL_CULL_THRESHOLD / 4);
+    } else {
+      transform(0, count);
+    }
+    boundsValid = true;
+  }
+  if (parallel) {
+    std::atomic<size_t> visibleCount{ 0 };
+    JobSystem::get().parallelFor(count, [&](size_t begin, size_t end) {
+      visibleCount += frustum.cull(worldBounds.data() + begin, end - begin, visible.data() + begin);
+    }, PARALLEL_CULL_THRESHOLD / 4);
+    culledCount = count - visibleCount;
+  } else {
+    culledCount = count - frustum.cull(worldBounds.data(), count, visible.data());
+  }
+  culled = true;
+}
+
+uint32_t RenderQueue::getShapeOrdinal(const void * shape) {
+  auto itr = shapeOrdinals.find(shape);
+  if (itr != shapeOrdinals.end()) {
+    return itr->second;
+  }
+  uint32_t result = (uint32_t)shapeOrdinals.size();
+  shapeOrdinals[shape] = result;
+  return result;
+}
+
+// Most significant first: layer, state, program, texture, shape.  A stable
+// sort keeps the submission order for otherwise identical draws.
+void RenderQueue::sort() {
+  if (sorted) {
+    return;
+  }
+  // Ordinals only need to group equal shapes within one sort, and must not
+  // outlive the shapes, since a freed shape's address can be reused
+  shapeOrdinals.clear();
+  for (size_t i = 0; i < items.size(); ++i) {
+    Item & item = items[i];
+    item.key =
+      ((uint64_t)(item.layer & 0x0F) << 60) |
+      ((uint64_t)(item.state & 0x0F) << 56) |
+      ((uint64_t)(oglplus::GetName(*item.program) & 0xFFFF) << 40) |
+      ((uint64_t)(item.texture & 0xFFFF) << 24) |
+      ((uint64_t)getShapeOrdinal(item.mesh ? (const void *)item.mesh : item.shape) & 0xFFFFFF);
+  }
+  std::stable_sort(items.begin(), items.end(), [](const Item & a, const Item & b) {
+    return a.key < b.key;
+  });
+  sorted = true;
+}
+
+// The defaults are depth testing and face culling enabled, which is what
+// the examples otherwise render with
+void RenderQueue::applyState(uint8_t from, uint8_t to) {
+  uint8_t changed = from ^ to;
+  if (changed & NO_DEPTH_TEST) {
+    if (to & NO_DEPTH_TEST) {
+      glDisable(GL_DEPTH_TEST);
+    } else {
+      glEnable(GL_DEPTH_TEST);
+    }
+  }
+  if (changed & NO_CULL_FACE) {
+    if (to & NO_CULL_FACE) {
+      glDisable(GL_CULL_FACE);
+    } else {
+      glEnable(GL_CULL_FACE);
+    }
+  }
+}
+
+void RenderQueue::execute() {
+  execute(Stacks::projection().top(), Stacks::modelview().top());
+}
+
+void RenderQueue::execute(const glm::mat4 & projection, const glm::mat4 & view) {
+  sort();
+  executeItems(projection, view, false);
+}
+
+bool RenderQueue::executeStereo(const glm::mat4 projections[2], const glm::mat4 views[2]) {
+  sort();
+  stereoPrograms.resize(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    stereoPrograms[i] = oria::getStereoProgram(*items[i].program);
+    if (nullptr == stereoPrograms[i]) {
+      return false;
+    }
+  }
+
+  glm::mat4 matrices[4] = { views[0], views[1], projections[0], projections[1] };
+  if (!stereoMatrices) {
+    glGenBuffers(1, &stereoMatrices);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, stereoMatrices);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(matrices), matrices, GL_STREAM_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, oria::STEREO_MATRICES_BINDING, stereoMatrices);
+
+  glEnable(GL_CLIP_DISTANCE0);
+  executeItems(glm::mat4(), glm::mat4(), true);
+  glDisable(GL_CLIP_DISTANCE0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, oria::STEREO_MATRICES_BINDING, 0);
+  return true;
+}
+
+void RenderQueue::shutdownGl() {
+  if (stereoMatrices) {
+    glDeleteBuffers(1, &stereoMatrices);
+    stereoMatrices = 0;
+  }
+}
+
+static RenderQueue::Stats & getFrameTotals() {
+  static RenderQueue::Stats totals;
+  return totals;
+}
+
+RenderQueue::Stats RenderQueue::endFrame() {
+  Stats result = getFrameTotals();
+  getFrameTotals() = Stats();
+  Trace::counter("visibleItems", (double)result.draws);
+  Trace::counter("culledItems", (double)result.culled);
+  return result;
+}
+
+void RenderQueue::executeItems(const glm::mat4 & projection, const glm::mat4 & view, bool stereo) {
+  stats = Stats();
+  if (items.empty()) {
+    return;
+  }
+
+  uint8_t currentState = DEFAULT_STATE;
+  GLuint currentProgram = 0;
+  const oria::ProgramUniforms * uniforms = nullptr;
+  const void * currentShape = nullptr;
+  GLenum currentTarget = GL_TEXTURE_2D;
+  GLuint currentTexture = 0;
+  if (!stereo) {
+    // Programs reading the shared block only need it uploaded once
+    oria::updatePerEyeBlock(projection, view);
+  }
+
+  stats.culled = culled ? culledCount : 0;
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (culled && !visible[i]) {
+      continue;
+    }
+    const Item & item = items[i];
+    bool stateChanged = item.state != currentState;
+    if (stateChanged) {
+      applyState(currentState, item.state);
+      currentState = item.state;
+      ++stats.stateChanges;
+    }
+
+    oglplus::Program & itemProgram = stereo ? *stereoPrograms[i] : *item.program;
+    GLuint program = oglplus::GetName(itemProgram);
+    bool programChanged = program != currentProgram;
+    if (programChanged) {
+      itemProgram.Use();
+      currentProgram = program;
+      uniforms = &oria::getUniforms(itemProgram);
+      if (!stereo && uniforms->projection >= 0) {
+        glUniformMatrix4fv(uniforms->projection, 1, GL_FALSE, glm::value_ptr(projection));
+      }
+      ++stats.programBinds;
+    }
+    if ((programChanged || stateChanged) && (item.state & LIGHTS)) {
+      oria::bindLights(itemProgram);
+    }
+
+    if (item.texture != currentTexture || item.textureTarget != currentTarget) {
+      if (currentTexture && item.textureTarget != currentTarget) {
+        glBindTexture(currentTarget, 0);
+      }
+      glBindTexture(item.textureTarget, item.texture);
+      currentTarget = item.textureTarget;
+      currentTexture = item.texture;
+      ++stats.textureBinds;
+    }
+
+    const void * shape = item.mesh ? (const void *)item.mesh : item.shape;
+    if (shape != currentShape) {
+      if (item.mesh) {
+        item.mesh->use();
+      } else {
+        item.shape->Use();
+      }
+      currentShape = shape;
+      ++stats.shapeBinds;
+    }
+
+    if (stereo) {
+      if (uniforms->model >= 0) {
+        glUniformMatrix4fv(uniforms->model, 1, GL_FALSE, glm::value_ptr(item.model));
+      }
+    } else if (uniforms->modelView >= 0) {
+      glm::mat4 modelView = view * item.model;
+      glUniformMatrix4fv(uniforms->modelView, 1, GL_FALSE, glm::value_ptr(modelView));
+    }
+    if ((item.uniforms & COLOR) && uniforms->color >= 0) {
+      glUniform4fv(uniforms->color, 1, glm::value_ptr(item.color));
+    }
+    if ((item.uniforms & UV_MULTIPLIER) && uniforms->uvMultiplier >= 0) {
+      glUniform2fv(uniforms->uvMultiplier, 1, glm::value_ptr(item.uvMultiplier));
+    }
+    if ((item.uniforms & FORCE_ALPHA) && uniforms->forceAlpha >= 0) {
+      glUniform1f(uniforms->forceAlpha, item.forceAlpha);
+    }
+
+    // One instance per eye
+    if (item.mesh) {
+      item.mesh->draw(stereo ? 2 : 1);
+    } else {
+      item.shape->Draw(stereo ? 2 : 1);
+    }
+    ++stats.draws;
+  }
+
+  if (currentTexture) {
+    glBindTexture(currentTarget, 0);
+  }
+  applyState(currentState, DEFAULT_STATE);
+  oglplus::NoProgram().Bind();
+  oglplus::NoVertexArray().Bind();
+
+  Stats & totals = getFrameTotals();
+  totals.draws += stats.draws;
+  totals.programBinds += stats.programBinds;
+  totals.shapeBinds += stats.shapeBinds;
+  totals.textureBinds += stats.textureBinds;
+  totals.stateChanges += stats.stateChanges;
+  totals.culled += stats.culled;
+}
@@ -0,0 +1,184 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * A retained list of draws.  Rather than binding the program, textures and
+ * vertex array for every object as the oria::render* functions do, the
+ * scene is recorded into the queue once per frame, sorted so that draws
+ * sharing state end up next to each other, and then executed (once for
+ * each eye) binding only what actually changes between consecutive draws.
+ *
+ * executeStereo() draws both eyes with a single traversal of the queue,
+ * using instanced stereo variants of the programs (see
+ * oria::getStereoProgram) with the per-eye matrices in a uniform buffer.
+ *
+ * Items given bounds can be culled against a frustum, typically the
+ * combined frustum of both eyes (see ovr::getStereoFrustum), once per frame
+ * before the queue is executed.
+ *
+ * The queue holds raw pointers to the programs and shapes (or meshes), so
+ * they must
+ * outlive the recording.
+ */
+class RenderQueue {
+public:
+  // Layers are drawn in order, regardless of the state they use
+  enum Layer {
+    BACKGROUND,
+    SCENE,
+  };
+
+  enum StateFlags {
+    DEFAULT_STATE = 0,
+    NO_DEPTH_TEST = 0x01,
+    NO_CULL_FACE = 0x02,
+    // Upload the Stacks::lights() to the program
+    LIGHTS = 0x04,
+  };
+
+  // Optional per-draw uniforms, only uploaded when set on the item
+  enum UniformFlags {
+    COLOR = 0x01,
+    UV_MULTIPLIER = 0x02,
+    FORCE_ALPHA = 0x04,
+  };
+
+  struct Item {
+    oglplus::Program * program{ nullptr };
+    // One of shape or mesh is set
+    oglplus::shapes::ShapeWrapper * shape{ nullptr };
+    const Mesh * mesh{ nullptr };
+    GLenum textureTarget{ GL_TEXTURE_2D };
+    GLuint texture{ 0 };
+    uint8_t layer{ SCENE };
+    uint8_t state{ DEFAULT_STATE };
+    uint8_t uniforms{ 0 };
+    uint64_t key{ 0 };
+
+    // Relative to the view the queue is executed with
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec2 uvMultiplier;
+    float forceAlpha{ 0 };
+    // A bounding sphere around the shape, in the model space, with the
+    // radius in w.  Items without one are never culled.
+    glm::vec4 bounds{ 0, 0, 0, -1 };
+
+    Item & setTexture(GLenum target, GLuint name) {
+      textureTarget = target;
+      texture = name;
+      return *this;
+    }
+
+    Item & setColor(const glm::vec4 & color) {
+      this->color = color;
+      uniforms |= COLOR;
+      return *this;
+    }
+
+    Item & setUvMultiplier(const glm::vec2 & uvMultiplier) {
+      this->uvMultiplier = uvMultiplier;
+      uniforms |= UV_MULTIPLIER;
+      return *this;
+    }
+
+    Item & setForceAlpha(float forceAlpha) {
+      this->forceAlpha = forceAlpha;
+      uniforms |= FORCE_ALPHA;
+      return *this;
+    }
+
+    Item & setBounds(const glm::vec4 & bounds) {
+      this->bounds = bounds;
+      return *this;
+    }
+  };
+
+  // What the last execute() actually did, compared to one bind of each
+  // kind per draw for the immediate functions
+  struct Stats {
+    size_t draws{ 0 };
+    size_t programBinds{ 0 };
+    size_t shapeBinds{ 0 };
+    size_t textureBinds{ 0 };
+    size_t stateChanges{ 0 };
+    // Items skipped because the last cull() found them outside the frustum
+    size_t culled{ 0 };
+  };
+
+private:
+  std::vector<Item> items;
+  bool sorted{ true };
+  // Rebuilt by every sort() from the items being sorted
+  std::unordered_map<const void *, uint32_t> shapeOrdinals;
+  // Parallel to the sorted items, and only valid once culled
+  std::vector<glm::vec4> worldBounds;
+  std::vector<uint8_t> visible;
+  bool boundsValid{ false };
+  bool culled{ false };
+  size_t culledCount{ 0 };
+  // Parallel to items, only filled in for stereo execution
+  std::vector<oglplus::Program *> stereoPrograms;
+  GLuint stereoMatrices{ 0 };
+  Stats stats;
+
+  uint32_t getShapeOrdinal(const void * shape);
+  static void applyState(uint8_t from, uint8_t to);
+  void executeItems(const glm::mat4 & projection, const glm::mat4 & view, bool stereo);
+
+public:
+  // Records a draw of the shape with the current modelview matrix as the
+  // model transform.  The returned item is only valid until the next
+  // submit.
+  Item & submit(const ProgramPtr & program, const ShapeWrapperPtr & shape);
+  // As above, with the mesh's bounds already set
+  Item & submit(const ProgramPtr & program, const MeshPtr & mesh);
+  void sort();
+  void clear();
+
+  // Marks the items outside the frustum so that execution skips them.
+  // Holds until the next submit() or clear().
+  void cull(const Frustum & frustum);
+
+  // Draw everything with the projection and modelview matrices on the
+  // stacks as the projection and view
+  void execute();
+  void execute(const glm::mat4 & projection, const glm::mat4 & view);
+
+  // Draw both eyes into a side by side target, with the viewport covering
+  // both halves.  Returns false without drawing anything if any of the
+  // programs has no stereo variant.
+  bool executeStereo(const glm::mat4 projections[2], const glm::mat4 views[2]);
+  void shutdownGl();
+
+  size_t size() const {
+    return items.size();
+  }
+
+  const Stats & getStats() const {
+    return stats;
+  }
+
+  // The totals of every queue's execute() calls since the last call,
+  // which are also recorded as trace counters.  Call once per frame from
+  // the render thread.
+  static Stats endFrame();
+};
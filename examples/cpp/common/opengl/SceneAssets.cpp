@@ -0,0 +1,108 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+static const Resource SKYBOX = Resource::IMAGES_SKY_CITY_XNEG_PNG;
+
+namespace oria {
+
+  struct SceneObjects {
+    bool loaded{ false };
+    TextureHandle skybox;
+    TexturePtr floor;
+    ProgramPtr manikinProgram;
+    MeshPtr manikinMesh;
+  };
+
+  static SceneObjects & getSceneObjects() {
+    static SceneObjects objects;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
+      Platform::addShutdownHook([&] {
+        objects = SceneObjects();
+      });
+      registeredShutdown = true;
+    }
+    return objects;
+  }
+
+}
+
+void SceneAssets::prepare(JobSystem & jobs, bool useMeshCache) {
+  // The six faces, the floor and the mesh, as one batch of jobs
+  jobs.parallelFor(8, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (i < 6) {
+        skyboxFaces[i] = oria::loadImage(static_cast<Resource>(SKYBOX + i));
+      } else if (6 == i) {
+        floor = oria::loadImage(Resource::IMAGES_FLOOR_PNG);
+      } else {
+        Mesh::prepare({ "Position", "Normal" }, Resource::MESHES_MANIKIN_CTM, manikin, useMeshCache);
+      }
+    }
+  });
+}
+
+void SceneAssets::upload() {
+  using namespace oglplus;
+  oria::SceneObjects & objects = oria::getSceneObjects();
+  objects.skybox = oria::resolveCubemapTexture(SKYBOX, skyboxFaces);
+  objects.floor = oria::getTexture(oria::resolve2dTexture(Resource::IMAGES_FLOOR_PNG, floor));
+  Context::Bound(TextureTarget::_2D, *objects.floor).MinFilter(TextureMinFilter::LinearMipmapNearest).GenerateMipmap();
+  objects.manikinProgram = oria::loadProgram(Resource::SHADERS_LIT_VS, Resource::SHADERS_LITCOLORED_FS);
+  objects.manikinMesh = oria::loadMesh(manikin, objects.manikinProgram);
+  objects.loaded = true;
+}
+
+namespace oria {
+
+  void loadSceneAssets() {
+    if (getSceneObjects().loaded) {
+      return;
+    }
+    TRACE_SCOPE("loadSceneAssets");
+    int64_t start = Platform::elapsedNanos();
+    SceneAssets assets;
+    assets.prepare();
+    assets.upload();
+    SAY("Scene assets loaded in %0.2f ms", (float)(Platform::elapsedNanos() - start) / 1e6f);
+  }
+
+  TextureHandle getSceneSkybox() {
+    loadSceneAssets();
+    return getSceneObjects().skybox;
+  }
+
+  const TexturePtr & getSceneFloor() {
+    loadSceneAssets();
+    return getSceneObjects().floor;
+  }
+
+  const ProgramPtr & getManikinProgram() {
+    loadSceneAssets();
+    return getSceneObjects().manikinProgram;
+  }
+
+  const MeshPtr & getManikinMesh() {
+    loadSceneAssets();
+    return getSceneObjects().manikinMesh;
+  }
+
+}
@@ -0,0 +1,54 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * The textures and mesh of the manikin scene: the skybox, the floor
+ * texture and the manikin.  The example scene shares the two textures.
+ *
+ * prepare() decodes the images and prepares the mesh together across the
+ * JobSystem, so they share the cores instead of each being decoded in
+ * turn on the render thread as it's first drawn.  upload() then creates
+ * the GL objects, so only it needs the context.
+ */
+struct SceneAssets {
+  // In GL face order
+  ImagePtr skyboxFaces[6];
+  ImagePtr floor;
+  Mesh::Source manikin;
+
+  // The mesh cache is only skipped to measure the full decode
+  void prepare(JobSystem & jobs = JobSystem::get(), bool useMeshCache = true);
+  void upload();
+};
+
+namespace oria {
+  // Prepares and uploads the scene assets on the first call, and does
+  // nothing after that.  The scenes call it when they're first drawn,
+  // which apps can avoid stalling their first frame on by calling it
+  // during startup.
+  void loadSceneAssets();
+
+  TextureHandle getSceneSkybox();
+  const TexturePtr & getSceneFloor();
+  // The manikin's mesh, and the lit program it was uploaded for
+  const ProgramPtr & getManikinProgram();
+  const MeshPtr & getManikinMesh();
+}
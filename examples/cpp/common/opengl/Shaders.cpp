@@ -18,13 +18,74 @@
  ************************************************************************************/
 
 #include "Common.h"
+#include <regex>
 
 namespace oria {
 
-  void compileProgram(ProgramPtr & result, std::string vs, std::string fs) {
+  static const ProgramUniforms & prepareProgram(GLuint program);
+
+  typedef std::pair<Resource, Resource> ProgramSources;
+
+  // What we know about each program created here, keyed by GL name.  The
+  // entry goes away as the program object is destroyed, so a name the
+  // driver hands out again never finds a dead program's data.
+  struct ProgramInfo {
+    // Created by newProgram, so the entry is erased with the program.
+    // Entries for other programs can't be trusted from one call to the next
+    bool managed{ false };
+    bool prepared{ false };
+    ProgramUniforms uniforms;
+    // Set for programs built by loadProgram(Resource, Resource), so that
+    // variants of them can be built later
+    bool hasSources{ false };
+    ProgramSources sources;
+    // Failures are remembered as well, so they're only attempted once
+    bool stereoBuilt{ false };
+    ProgramPtr stereo;
+  };
+
+  typedef std::unordered_map<GLuint, ProgramInfo> ProgramInfoMap;
+
+  // Leaked, since programs held in statics elsewhere may be destroyed
+  // after it would have been
+  static ProgramInfoMap & getProgramInfoMap() {
+    static ProgramInfoMap * infos = new ProgramInfoMap();
+    return *infos;
+  }
+
+  static void forgetProgram(GLuint name) {
+    ProgramInfoMap & infos = getProgramInfoMap();
+    ProgramInfoMap::iterator itr = infos.find(name);
+    if (itr == infos.end()) {
+      return;
+    }
+    // The stereo variant's own entry is erased as it's destroyed, which
+    // mustn't happen in the middle of erasing this one
+    ProgramPtr stereo = itr->second.stereo;
+    infos.erase(itr);
+  }
+
+  ProgramPtr newProgram() {
+    ProgramPtr result(new oglplus::Program(), [](oglplus::Program * program) {
+      forgetProgram(oglplus::GetName(*program));
+      delete program;
+    });
+    // Replaces whatever was left by an unmanaged program with this name
+    ProgramInfo & info = getProgramInfoMap()[oglplus::GetName(*result)];
+    info = ProgramInfo();
+    info.managed = true;
+    return result;
+  }
+
+  static std::string describeProgram(const ProgramSources & sources) {
+    return Resources::getResourcePath(sources.first) + " + " +
+      Resources::getResourcePath(sources.second);
+  }
+
+  void compileProgram(ProgramPtr & result, std::string vs, std::string fs, bool retrievable = false, bool reportErrors = true) {
     using namespace oglplus;
     try {
-      result = ProgramPtr(new Program());
+      result = newProgram();
       // attach the shaders to the program
       result->AttachShader(
         VertexShader()
@@ -36,46 +97,428 @@ namespace oria {
         .Source(GLSLSource(fs))
         .Compile()
         );
+      if (retrievable) {
+        glProgramParameteri(GetName(*result), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      }
       result->Link();
+      prepareProgram(GetName(*result));
     } catch (ProgramBuildError & err) {
-      SAY_ERR((const char*)err.Message);
+      if (reportErrors) {
+        SAY_ERR((const char*)err.Message);
+      }
       result.reset();
     }
   }
 
+  // A linked program image, as returned by glGetProgramBinary
+  struct ProgramBinary {
+    GLenum format{ 0 };
+    std::string data;
+  };
 
-  ProgramPtr loadProgram(Resource vs, Resource fs) {
-    typedef std::unordered_map<std::string, ProgramPtr> ProgramMap;
+  typedef std::unordered_map<uint64_t, ProgramBinary> ProgramBinaryMap;
+
+  static const char PROGRAM_BINARY_MAGIC[4] = { 'O', 'R', 'P', 'B' };
 
-    static ProgramMap programs;
+  static bool supportsProgramBinaries() {
+    static int supported = -1;
+    if (supported < 0) {
+      GLint formats = 0;
+      if (nullptr != glProgramBinary && nullptr != glGetProgramBinary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+      }
+      supported = formats > 0 ? 1 : 0;
+    }
+    return 0 != supported;
+  }
+
+  // Each part goes in after its length, so text moving from the end of
+  // one part to the start of the next still changes the key
+  static uint64_t hashKeyPart(const std::string & part, uint64_t key) {
+    uint64_t length = part.size();
+    key = oria::hash(&length, sizeof(length), key);
+    return oria::hash(part, key);
+  }
+
+  // Binaries are only valid for the driver that produced them, so the
+  // renderer and version strings are part of the key
+  static uint64_t programKey(const std::string & vs, const std::string & fs) {
+    const char * renderer = (const char*)glGetString(GL_RENDERER);
+    const char * version = (const char*)glGetString(GL_VERSION);
+    uint64_t key = 0;
+    key = hashKeyPart(renderer ? renderer : "", key);
+    key = hashKeyPart(version ? version : "", key);
+    key = hashKeyPart(vs, key);
+    return hashKeyPart(fs, key);
+  }
+
+  // Empty if there's nowhere safe to cache
+  static std::string programCachePath(uint64_t key) {
+    std::string directory = Platform::getCacheDirectory();
+    if (directory.empty()) {
+      return directory;
+    }
+    return directory + Platform::format("%016" PRIx64 ".glprogram", key);
+  }
+
+  static bool readProgramBinary(uint64_t key, ProgramBinary & out) {
+    std::string path = programCachePath(key);
+    if (path.empty()) {
+      return false;
+    }
+    std::string fileData;
+    try {
+      fileData = oria::readFile(path);
+    } catch (std::runtime_error &) {
+      return false;
+    }
+    size_t headerSize = sizeof(PROGRAM_BINARY_MAGIC) + sizeof(GLenum);
+    if (fileData.size() <= headerSize || memcmp(fileData.data(), PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC))) {
+      return false;
+    }
+    memcpy(&out.format, fileData.data() + sizeof(PROGRAM_BINARY_MAGIC), sizeof(GLenum));
+    out.data = fileData.substr(headerSize);
+    return true;
+  }
+
+  static void writeProgramBinary(uint64_t key, const ProgramBinary & binary) {
+    std::string fileData(PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC));
+    fileData.append((const char*)&binary.format, sizeof(GLenum));
+    fileData.append(binary.data);
+    std::string path = programCachePath(key);
+    if (path.empty()) {
+      return;
+    }
+    // Replaced in one step, so a crash or another instance writing the
+    // same program never leaves a truncated binary for glProgramBinary
+    if (!Platform::replaceFile(path, fileData)) {
+      SAY_ERR("Unable to write program binary cache file");
+    }
+  }
+
+  static bool getProgramBinary(ProgramPtr & program, ProgramBinary & out) {
+    GLuint name = oglplus::GetName(*program);
+    GLint length = 0;
+    glGetProgramiv(name, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+      return false;
+    }
+    out.data.resize(length);
+    glGetProgramBinary(name, length, nullptr, &out.format, &out.data[0]);
+    return true;
+  }
+
+  // Creates a brand new program object from a linked binary.  Fails (for
+  // instance after a driver update) if the driver rejects the binary.
+  static ProgramPtr loadProgramBinary(const ProgramBinary & binary) {
+    ProgramPtr result = newProgram();
+    GLuint name = oglplus::GetName(*result);
+    glProgramBinary(name, binary.format, binary.data.data(), (GLsizei)binary.data.size());
+    GLint status = GL_FALSE;
+    glGetProgramiv(name, GL_LINK_STATUS, &status);
+    if (GL_TRUE != status) {
+      result.reset();
+    } else {
+      prepareProgram(name);
+    }
+    return result;
+  }
+
+  ProgramCacheStats & getProgramCacheStats() {
+    static ProgramCacheStats stats;
+    return stats;
+  }
+
+  static bool bindUniformBlock(GLuint program, const char * blockName, GLuint binding) {
+    GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+    if (GL_INVALID_INDEX == blockIndex) {
+      return false;
+    }
+    glUniformBlockBinding(program, blockIndex, binding);
+    return true;
+  }
+
+  // Builds the location table for a newly linked program and attaches its
+  // uniform blocks to the shared binding points
+  static const ProgramUniforms & prepareProgram(GLuint program) {
+    ProgramInfo & info = getProgramInfoMap()[program];
+    info.prepared = true;
+    ProgramUniforms & result = info.uniforms;
+    result = ProgramUniforms();
+    result.modelView = glGetUniformLocation(program, "ModelView");
+    result.projection = glGetUniformLocation(program, "Projection");
+    result.model = glGetUniformLocation(program, "Model");
+    result.color = glGetUniformLocation(program, "Color");
+    result.uvMultiplier = glGetUniformLocation(program, "UvMultiplier");
+    result.forceAlpha = glGetUniformLocation(program, "ForceAlpha");
+    result.ambient = glGetUniformLocation(program, "Ambient");
+    result.lightCount = glGetUniformLocation(program, "LightCount");
+    result.lightColors = glGetUniformLocation(program, "LightColor[0]");
+    result.lightPositions = glGetUniformLocation(program, "LightPosition[0]");
+    result.perEyeBlock = bindUniformBlock(program, "PerEye", PER_EYE_BINDING);
+    result.lightsBlock = bindUniformBlock(program, "Lights", LIGHTS_BINDING);
+    bindUniformBlock(program, "StereoMatrices", STEREO_MATRICES_BINDING);
+    return result;
+  }
+
+  const ProgramUniforms & getUniforms(const oglplus::Program & program) {
+    GLuint name = oglplus::GetName(program);
+    ProgramInfoMap & infos = getProgramInfoMap();
+    ProgramInfoMap::iterator itr = infos.find(name);
+    // Nothing tells us when a program created elsewhere is destroyed, and
+    // its name may since have been reused, so its locations can't be kept.
+    // Every program in the tree comes from newProgram().
+    assert(itr != infos.end() && itr->second.managed);
+    // Programs linked by the caller are prepared on first use
+    if (itr == infos.end() || !itr->second.managed || !itr->second.prepared) {
+      return prepareProgram(name);
+    }
+    return itr->second.uniforms;
+  }
+
+  // The std140 layout of the Lights block
+  struct LightsBlock {
+    glm::vec4 ambient;
+    GLint lightCount;
+    GLint padding[3];
+    glm::vec4 colors[MAX_LIGHTS];
+    glm::vec4 positions[MAX_LIGHTS];
+  };
+
+  struct UniformBlocks {
+    GLuint perEyeBuffer{ 0 };
+    GLuint lightsBuffer{ 0 };
+    // Projection then view, the std140 layout of the PerEye block
+    glm::mat4 perEye[2];
+    LightsBlock lights;
+    bool perEyeValid{ false };
+    bool lightsValid{ false };
+  };
+
+  static UniformBlocks & getUniformBlocks() {
+    static UniformBlocks blocks;
     static bool registeredShutdown = false;
     if (!registeredShutdown) {
       Platform::addShutdownHook([&]{
-        programs.clear();
+        if (blocks.perEyeBuffer) {
+          glDeleteBuffers(1, &blocks.perEyeBuffer);
+        }
+        if (blocks.lightsBuffer) {
+          glDeleteBuffers(1, &blocks.lightsBuffer);
+        }
+        blocks = UniformBlocks();
       });
       registeredShutdown = true;
     }
+    return blocks;
+  }
 
-    std::string key = Resources::getResourcePath(vs) + ":" +
-      Resources::getResourcePath(fs);
-    if (!programs.count(key)) {
-      ProgramPtr result;
-      compileProgram(result,
-        Platform::getResourceString(vs),
-        Platform::getResourceString(fs));
-      // FIXME
-      // Caching shaders is problematic, since it requires you to set ALL 
-      // uniforms any time you use the shader, because you don't know if you're 
-      // sharing the shader instance with something else in the program which 
-      // is using the same shader for a different purpose, and with different 
-      // uniforms.
-      // Need to decide if it's better policy to cache shaders and expect full uniform 
-      // initialization every time we use them or to prevent shader caching.  
-      // For now it's disabled.  
-      // programs[key] = result;
-      return result;
-    }
-    return programs[key];
+  static void uploadBlock(GLuint & buffer, GLuint binding, const void * data, size_t size) {
+    if (!buffer) {
+      glGenBuffers(1, &buffer);
+      glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+      glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    } else {
+      glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+      glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+  }
+
+  void updatePerEyeBlock(const glm::mat4 & projection, const glm::mat4 & view) {
+    UniformBlocks & blocks = getUniformBlocks();
+    if (blocks.perEyeValid && blocks.perEye[0] == projection && blocks.perEye[1] == view) {
+      return;
+    }
+    blocks.perEye[0] = projection;
+    blocks.perEye[1] = view;
+    blocks.perEyeValid = true;
+    uploadBlock(blocks.perEyeBuffer, PER_EYE_BINDING, blocks.perEye, sizeof(blocks.perEye));
+  }
+
+  void updatePerEyeBlock(const glm::mat4 & projection) {
+    updatePerEyeBlock(projection, getUniformBlocks().perEye[1]);
+  }
+
+  void updateLightsBlock(const Lights & lights) {
+    LightsBlock block;
+    memset(&block, 0, sizeof(block));
+    size_t count = std::min(lights.lightPositions.size(), (size_t)MAX_LIGHTS);
+    block.ambient = lights.ambient;
+    block.lightCount = (GLint)count;
+    std::copy(lights.lightColors.begin(), lights.lightColors.begin() + count, block.colors);
+    std::copy(lights.lightPositions.begin(), lights.lightPositions.begin() + count, block.positions);
+
+    UniformBlocks & blocks = getUniformBlocks();
+    if (blocks.lightsValid && 0 == memcmp(&blocks.lights, &block, sizeof(block))) {
+      return;
+    }
+    blocks.lights = block;
+    blocks.lightsValid = true;
+    uploadBlock(blocks.lightsBuffer, LIGHTS_BINDING, &blocks.lights, sizeof(blocks.lights));
+  }
+
+  void setProjection(const oglplus::Program & program, const glm::mat4 & projection) {
+    const ProgramUniforms & uniforms = getUniforms(program);
+    if (uniforms.projection >= 0) {
+      glUniformMatrix4fv(uniforms.projection, 1, GL_FALSE, glm::value_ptr(projection));
+    } else if (uniforms.perEyeBlock) {
+      updatePerEyeBlock(projection);
+    }
+  }
+
+  // Splits a shader after its #version and #extension lines, failing if
+  // it predates uniform blocks and instancing (GLSL 1.40)
+  static bool splitShaderHeader(const std::string & source, std::string & header, std::string & body) {
+    static const std::regex VERSION("#version\\s+(\\d+)[^\\n]*\\n(\\s*#extension[^\\n]*\\n)*");
+    std::smatch match;
+    if (!std::regex_search(source, match, VERSION) || atoi(match[1].str().c_str()) < 140) {
+      return false;
+    }
+    header = match.prefix().str() + match[0].str();
+    body = match.suffix().str();
+    return true;
+  }
+
+  // Moves the Projection uniform, and the light uniforms if the shader
+  // declares all of them, into the shared blocks
+  static std::string useUniformBlocks(const std::string & source) {
+    static const std::regex PROJECTION("uniform\\s+mat4\\s+Projection\\s*;");
+    static const std::regex LIGHT_UNIFORMS[] = {
+      std::regex("uniform\\s+vec4\\s+Ambient\\s*;"),
+      std::regex("uniform\\s+int\\s+LightCount\\s*;"),
+      std::regex("uniform\\s+vec4\\s+LightColor\\s*\\[\\s*\\w+\\s*\\]\\s*;"),
+      std::regex("uniform\\s+vec4\\s+LightPosition\\s*\\[\\s*\\w+\\s*\\]\\s*;"),
+    };
+
+    std::string header, body;
+    if (!splitShaderHeader(source, header, body)) {
+      return source;
+    }
+
+    std::string blocks;
+    if (std::regex_search(body, PROJECTION)) {
+      body = std::regex_replace(body, PROJECTION, std::string());
+      blocks +=
+        "layout(std140) uniform PerEye {\n"
+        "  mat4 Projection;\n"
+        "  mat4 View;\n"
+        "};\n";
+    }
+
+    bool hasLights = true;
+    for (const std::regex & pattern : LIGHT_UNIFORMS) {
+      hasLights = hasLights && std::regex_search(body, pattern);
+    }
+    if (hasLights) {
+      for (const std::regex & pattern : LIGHT_UNIFORMS) {
+        body = std::regex_replace(body, pattern, std::string());
+      }
+      blocks += Platform::format(
+        "layout(std140) uniform Lights {\n"
+        "  vec4 Ambient;\n"
+        "  int LightCount;\n"
+        "  vec4 LightColor[%d];\n"
+        "  vec4 LightPosition[%d];\n"
+        "};\n", MAX_LIGHTS, MAX_LIGHTS);
+    }
+
+    if (blocks.empty()) {
+      return source;
+    }
+    return header + blocks + body;
+  }
+
+  // Every call returns a distinct program object, so call sites never
+  // share uniform state.  What is shared is the linked binary, which lets
+  // us skip GLSL compilation on every call after the first, and on every
+  // run after the first once the binary has been persisted to disk.
+  static ProgramPtr loadProgramSource(const std::string & vsSource, const std::string & fsSource, bool reportErrors = true) {
+    static ProgramBinaryMap binaries;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
+      Platform::addShutdownHook([&]{
+        const ProgramCacheStats & stats = getProgramCacheStats();
+        SAY("Program cache: %d compiled, %d memory hits, %d disk hits, %ld ms total",
+          (int)stats.compiles, (int)stats.memoryHits, (int)stats.diskHits, stats.totalMillis);
+        binaries.clear();
+      });
+      registeredShutdown = true;
+    }
+
+    ProgramCacheStats & stats = getProgramCacheStats();
+    long start = Platform::elapsedMillis();
+
+    ProgramPtr result;
+    if (supportsProgramBinaries()) {
+      uint64_t key = programKey(vsSource, fsSource);
+      ProgramBinaryMap::iterator itr = binaries.find(key);
+      if (itr != binaries.end()) {
+        result = loadProgramBinary(itr->second);
+        if (result) {
+          ++stats.memoryHits;
+        }
+      } else {
+        ProgramBinary binary;
+        if (readProgramBinary(key, binary)) {
+          result = loadProgramBinary(binary);
+          if (result) {
+            ++stats.diskHits;
+            binaries[key] = binary;
+          }
+        }
+      }
+
+      if (!result) {
+        compileProgram(result, vsSource, fsSource, true, reportErrors);
+        ++stats.compiles;
+        ProgramBinary binary;
+        if (result && getProgramBinary(result, binary)) {
+          binaries[key] = binary;
+          writeProgramBinary(key, binary);
+        }
+      }
+    } else {
+      compileProgram(result, vsSource, fsSource, false, reportErrors);
+      ++stats.compiles;
+    }
+    stats.totalMillis += Platform::elapsedMillis() - start;
+    return result;
+  }
+
+  // Prefers the shared uniform blocks, but a shader the conversion
+  // doesn't suit still works with its own uniforms
+  static ProgramPtr loadProgramWithBlocks(const std::string & vsSource, const std::string & fsSource,
+      const std::string & description) {
+    std::string vsBlocks = useUniformBlocks(vsSource);
+    std::string fsBlocks = useUniformBlocks(fsSource);
+    ProgramPtr result;
+    if (vsBlocks != vsSource || fsBlocks != fsSource) {
+      result = loadProgramSource(vsBlocks, fsBlocks, false);
+      if (!result) {
+        SAY_ERR("%s doesn't build with the shared uniform blocks, using its own uniforms",
+          description.c_str());
+      }
+    }
+    if (!result) {
+      result = loadProgramSource(vsSource, fsSource);
+    }
+    return result;
+  }
+
+  ProgramPtr loadProgram(Resource vs, Resource fs) {
+    ProgramSources sources(vs, fs);
+    ProgramPtr result = loadProgramWithBlocks(
+      Platform::getResourceString(vs),
+      Platform::getResourceString(fs),
+      describeProgram(sources));
+    if (result) {
+      ProgramInfo & info = getProgramInfoMap()[oglplus::GetName(*result)];
+      info.hasSources = true;
+      info.sources = sources;
+    }
+    return result;
   }
 
   ProgramPtr loadProgram(const std::string & vsFile, const std::string & fsFile) {
@@ -86,6 +529,28 @@ namespace oria {
     return result;
   }
 
+  typedef HandleTable<ProgramPtr, ProgramHandle> ProgramTable;
+
+  static ProgramTable & getProgramTable() {
+    static ProgramTable table;
+    static bool registeredShutdown = false;
+    if (!registeredShutdown) {
+      Platform::addShutdownHook([&]{
+        table.clear();
+      });
+      registeredShutdown = true;
+    }
+    return table;
+  }
+
+  ProgramHandle createProgram(Resource vs, Resource fs) {
+    return getProgramTable().add(loadProgram(vs, fs));
+  }
+
+  ProgramPtr & getProgram(ProgramHandle handle) {
+    return getProgramTable().get(handle);
+  }
+
   UniformMap getActiveUniforms(ProgramPtr & program) {
     UniformMap activeUniforms;
     size_t uniformCount = program->ActiveUniforms().Size();
@@ -96,4 +561,76 @@ namespace oria {
     return activeUniforms;
   }
 
+  static const char * STEREO_PREAMBLE =
+    "layout(std140) uniform StereoMatrices {\n"
+    "  mat4 StereoView[2];\n"
+    "  mat4 StereoProjection[2];\n"
+    "};\n"
+    "uniform mat4 Model;\n"
+    "#define ModelView (StereoView[gl_InstanceID] * Model)\n"
+    "#define Projection (StereoProjection[gl_InstanceID])\n"
+    "#define main stereoEyeMain\n";
+
+  // Squeeze each eye into its half of the target and clip at the seam
+  static const char * STEREO_MAIN =
+    "\n#undef main\n"
+    "void main() {\n"
+    "  stereoEyeMain();\n"
+    "  float eyeSign = (gl_InstanceID == 0) ? -1.0 : 1.0;\n"
+    "  gl_Position.x = 0.5 * gl_Position.x + 0.5 * eyeSign * gl_Position.w;\n"
+    "  gl_ClipDistance[0] = eyeSign * gl_Position.x;\n"
+    "}\n";
+
+  // Rewrites a vertex shader using ModelView and Projection uniforms to
+  // take them from the stereo uniform block instead.  Returns an empty
+  // string if the shader predates uniform blocks and instancing.
+  static std::string makeStereoVertexShader(const std::string & source) {
+    static const std::regex MATRICES("uniform\\s+mat4\\s+(ModelView|Projection)\\s*;");
+    std::string header, body;
+    if (!splitShaderHeader(source, header, body)) {
+      return std::string();
+    }
+    body = std::regex_replace(body, MATRICES, std::string());
+    return header + STEREO_PREAMBLE + body + STEREO_MAIN;
+  }
+
+  oglplus::Program * getStereoProgram(oglplus::Program & program) {
+    ProgramInfoMap & infos = getProgramInfoMap();
+    ProgramInfoMap::iterator itr = infos.find(oglplus::GetName(program));
+    if (itr == infos.end() || !itr->second.hasSources) {
+      return nullptr;
+    }
+    // References into the map survive the entries loading adds
+    ProgramInfo & info = itr->second;
+    if (info.stereoBuilt) {
+      return info.stereo.get();
+    }
+    info.stereoBuilt = true;
+
+    // Instances of the same program share one variant, for as long as any
+    // of them is alive
+    typedef std::map<ProgramSources, std::weak_ptr<oglplus::Program>> StereoProgramMap;
+    static StereoProgramMap stereoPrograms;
+    info.stereo = stereoPrograms[info.sources].lock();
+    if (info.stereo) {
+      return info.stereo.get();
+    }
+
+    std::string description = describeProgram(info.sources);
+    std::string vsSource = makeStereoVertexShader(Platform::getResourceString(info.sources.first));
+    if (vsSource.empty()) {
+      SAY_ERR("No stereo variant of %s, the vertex shader predates GLSL 1.40", description.c_str());
+      return nullptr;
+    }
+    ProgramPtr result = loadProgramWithBlocks(vsSource,
+      Platform::getResourceString(info.sources.second), description + " (stereo)");
+    if (!result) {
+      SAY_ERR("Unable to build a stereo variant of %s", description.c_str());
+      return nullptr;
+    }
+    stereoPrograms[info.sources] = result;
+    info.stereo = result;
+    return result.get();
+  }
+
 }
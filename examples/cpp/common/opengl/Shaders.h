@@ -26,7 +26,75 @@ typedef std::shared_ptr<oglplus::Program> ProgramPtr;
 typedef std::map<std::string, GLuint> UniformMap;
 
 namespace oria {
+  // Counters for how loadProgram satisfied its requests, useful for
+  // comparing cold (empty disk cache) and warm startup
+  struct ProgramCacheStats {
+    size_t compiles{ 0 };
+    size_t memoryHits{ 0 };
+    size_t diskHits{ 0 };
+    long totalMillis{ 0 };
+  };
+
+  // Locations of the uniforms set by the common rendering code, looked up
+  // once when the program is loaded.  -1 where the program doesn't use
+  // one, including those it reads from a uniform block instead.
+  struct ProgramUniforms {
+    GLint modelView{ -1 };
+    GLint projection{ -1 };
+    GLint model{ -1 };
+    GLint color{ -1 };
+    GLint uvMultiplier{ -1 };
+    GLint forceAlpha{ -1 };
+    GLint ambient{ -1 };
+    GLint lightCount{ -1 };
+    GLint lightColors{ -1 };
+    GLint lightPositions{ -1 };
+    bool perEyeBlock{ false };
+    bool lightsBlock{ false };
+  };
+
+  ProgramCacheStats & getProgramCacheStats();
   ProgramPtr loadProgram(Resource vs, Resource fs);
   ProgramPtr loadProgram(const std::string & vsFile, const std::string & fsFile);
   UniformMap getActiveUniforms(ProgramPtr & program);
+
+  // Each call creates a distinct program instance, like loadProgram, so
+  // callers setting their own uniforms don't interfere with each other
+  ProgramHandle createProgram(Resource vs, Resource fs);
+  ProgramPtr & getProgram(ProgramHandle handle);
+
+  // An empty program object, for programs linked outside loadProgram.
+  // The uniform locations cached for it are dropped along with it.
+  ProgramPtr newProgram();
+  // Only for programs from newProgram() or loadProgram().  Debug builds
+  // assert on any other program, which release builds look up every call.
+  const ProgramUniforms & getUniforms(const oglplus::Program & program);
+
+  // The uniform buffer binding point holding the per-eye matrices used by
+  // stereo program variants, as mat4 StereoView[2], StereoProjection[2]
+  static const GLuint STEREO_MATRICES_BINDING = 0;
+
+  // Programs loaded from resources read Projection, and the lights, from
+  // std140 blocks shared by every program rather than from uniforms of
+  // their own, so they're only uploaded when they change, typically once
+  // per eye.  Shaders that can't be converted keep their plain uniforms.
+  static const GLuint PER_EYE_BINDING = 1;
+  static const GLuint LIGHTS_BINDING = 2;
+  static const int MAX_LIGHTS = 8;
+
+  // Sets the projection for the current program, through the shared block
+  // or the program's own uniform as appropriate
+  void setProjection(const oglplus::Program & program, const glm::mat4 & projection);
+  // Upload the shared blocks, if they differ from what they already hold.
+  // The first form keeps the view from the last update.
+  void updatePerEyeBlock(const glm::mat4 & projection);
+  void updatePerEyeBlock(const glm::mat4 & projection, const glm::mat4 & view);
+  void updateLightsBlock(const Lights & lights);
+
+  // Returns a variant of a program created by loadProgram(Resource,
+  // Resource) which draws both eyes at once: instance 0 is the left eye
+  // and instance 1 the right, each clipped to its half of a side by side
+  // target.  The variant takes a Model uniform in place of ModelView and
+  // Projection.  Returns null if the vertex shader can't be converted.
+  oglplus::Program * getStereoProgram(oglplus::Program & program);
 }
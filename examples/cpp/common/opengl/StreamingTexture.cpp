@@ -0,0 +1,163 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+
+static size_t bytesPerPixel(GLenum format) {
+  switch (format) {
+  case GL_BGR:
+  case GL_RGB:
+    return 3;
+  case GL_BGRA:
+  case GL_RGBA:
+    return 4;
+  }
+  FAIL("Unsupported streaming texture format %d", format);
+  return 0;
+}
+
+StreamingTexture::~StreamingTexture() {
+  shutdown();
+}
+
+void StreamingTexture::init(const uvec2 & size, GLenum format) {
+  using namespace oglplus;
+  shutdown();
+
+  this->size = size;
+  this->format = format;
+  frameBytes = size.x * size.y * bytesPerPixel(format);
+
+  // Immutable storage, so uploads never reallocate the texture
+  texture = TexturePtr(new Texture());
+  Context::Bound(TextureTarget::_2D, *texture)
+    .MagFilter(TextureMagFilter::Linear)
+    .MinFilter(TextureMinFilter::Linear)
+    .WrapS(TextureWrap::ClampToEdge)
+    .WrapT(TextureWrap::ClampToEdge);
+  if (GLEW_ARB_texture_storage) {
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, size.x, size.y);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0,
+      format, GL_UNSIGNED_BYTE, nullptr);
+  }
+  DefaultTexture().Bind(TextureTarget::_2D);
+
+  size_t ringBytes = frameBytes * RING_SIZE;
+  glGenBuffers(1, &pixelBuffer);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+  if (GLEW_ARB_buffer_storage) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ringBytes, nullptr, flags);
+    mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringBytes, flags);
+  } else {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, ringBytes, nullptr, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void StreamingTexture::shutdown() {
+  for (int i = 0; i < RING_SIZE; ++i) {
+    if (slots[i].fence) {
+      glDeleteSync(slots[i].fence);
+      slots[i].fence = nullptr;
+    }
+  }
+  if (pixelBuffer) {
+    if (mapped) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      mapped = nullptr;
+    }
+    glDeleteBuffers(1, &pixelBuffer);
+    pixelBuffer = 0;
+  }
+  texture.reset();
+}
+
+// Returns true if the slot is free, recording the upload latency if it
+// has just completed
+bool StreamingTexture::collect(Slot & slot) {
+  if (!slot.fence) {
+    return true;
+  }
+  GLenum result = glClientWaitSync(slot.fence, 0, 0);
+  if (GL_ALREADY_SIGNALED != result && GL_CONDITION_SATISFIED != result) {
+    return false;
+  }
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  // Only as precise as how often we poll, which is once per upload
+  float latency = std::chrono::duration<float, std::milli>(
+    Clock::now() - slot.submitted).count();
+  ++completed;
+  stats.lastLatencyMs = latency;
+  stats.averageLatencyMs += (latency - stats.averageLatencyMs) / completed;
+  stats.maxLatencyMs = std::max(stats.maxLatencyMs, latency);
+  return true;
+}
+
+bool StreamingTexture::upload(const void * data, size_t bytes) {
+  // Never read past the end of a frame that isn't the size we expect
+  if (bytes != frameBytes) {
+    ++stats.rejected;
+    return false;
+  }
+
+  for (int i = 0; i < RING_SIZE; ++i) {
+    collect(slots[i]);
+  }
+
+  Slot & slot = slots[nextSlot];
+  if (slot.fence) {
+    ++stats.skipped;
+    return false;
+  }
+
+  size_t offset = frameBytes * nextSlot;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+  if (mapped) {
+    memcpy(mapped + offset, data, frameBytes);
+  } else {
+    // The fence guarantees the GPU is done with this range
+    void * dest = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, frameBytes,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (nullptr == dest) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return false;
+    }
+    memcpy(dest, data, frameBytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, oglplus::GetName(*texture));
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y,
+    format, GL_UNSIGNED_BYTE, (const GLvoid*)offset);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.submitted = Clock::now();
+  nextSlot = (nextSlot + 1) % RING_SIZE;
+  ++stats.uploads;
+  return true;
+}
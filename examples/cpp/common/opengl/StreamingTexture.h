@@ -0,0 +1,100 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * A texture for continuously changing images such as video frames.  The
+ * texture storage is allocated once at a fixed size, and each frame is
+ * copied into one slot of a ring of pixel unpack buffers and transferred
+ * to the texture from there, so the render thread never waits on the
+ * GPU.  When every slot is still in flight the frame is skipped rather
+ * than stalling.
+ *
+ * Where ARB_buffer_storage is available the ring is mapped persistently,
+ * otherwise each slot is mapped unsynchronized as it's written.
+ */
+class StreamingTexture {
+public:
+  static const int RING_SIZE = 3;
+
+  struct Stats {
+    size_t uploads{ 0 };
+    // Frames dropped because all the ring slots were still in use
+    size_t skipped{ 0 };
+    // Frames dropped because they didn't match the texture's size
+    size_t rejected{ 0 };
+    // Time from upload() to the GPU signalling the transfer complete
+    float lastLatencyMs{ 0 };
+    float averageLatencyMs{ 0 };
+    float maxLatencyMs{ 0 };
+  };
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Slot {
+    GLsync fence{ nullptr };
+    Clock::time_point submitted;
+  };
+
+  TexturePtr texture;
+  uvec2 size;
+  GLenum format{ GL_BGR };
+  size_t frameBytes{ 0 };
+  GLuint pixelBuffer{ 0 };
+  uint8_t * mapped{ nullptr };
+  Slot slots[RING_SIZE];
+  int nextSlot{ 0 };
+  size_t completed{ 0 };
+  Stats stats;
+
+  bool collect(Slot & slot);
+
+public:
+  StreamingTexture() {}
+  virtual ~StreamingTexture();
+
+  // Must be called with the GL context current.  Accepts GL_BGR, GL_RGB,
+  // GL_BGRA or GL_RGBA unsigned byte data, with tightly packed rows.
+  void init(const uvec2 & size, GLenum format = GL_BGR);
+  void shutdown();
+
+  bool isInitialized() const {
+    return (bool)texture;
+  }
+
+  const uvec2 & getSize() const {
+    return size;
+  }
+
+  // Queue a new image for the texture.  'bytes' is the size of the image
+  // data, which must match the size and format the texture was created
+  // with.  Returns false if the frame was rejected for the wrong size, or
+  // skipped because the GPU hasn't caught up with the earlier ones.
+  bool upload(const void * data, size_t bytes);
+
+  const TexturePtr & getTexture() const {
+    return texture;
+  }
+
+  const Stats & getStats() const {
+    return stats;
+  }
+};
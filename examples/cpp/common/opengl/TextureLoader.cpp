@@ -0,0 +1,205 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+TextureLoader::~TextureLoader() {
+  // Requests which haven't started decoding are dropped
+  shuttingDown = true;
+  // Failed jobs have already been logged, and can't throw from here
+  try {
+    JobSystem::get().wait(decodeJobs);
+  } catch (...) {
+  }
+}
+
+void TextureLoader::decode(const RequestPtr & request) {
+  if (shuttingDown) {
+    return;
+  }
+  // The faces of a cubemap are decoded in parallel
+  int faceCount = request->cubemap ? 6 : 1;
+  JobSystem::get().parallelFor(faceCount, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      try {
+        request->images[i] = request->decoder((int)i);
+      } catch (std::exception & error) {
+        SAY_ERR("Texture decode failed: %s", error.what());
+      }
+    }
+  });
+  // The decoder may hold on to compressed source data, so free it now
+  request->decoder = std::function<ImagePtr(int)>();
+
+  Locker lock(mutex);
+  uploadQueue.push_back(request);
+}
+
+TexturePtr TextureLoader::enqueue(const RequestPtr & request) {
+  using namespace oglplus;
+  static const uint8_t PLACEHOLDER[4] = { 128, 128, 128, 255 };
+
+  // Give the texture valid contents right away, so that it can be bound
+  // safely before the real image arrives
+  request->texture = TexturePtr(new Texture());
+  if (request->cubemap) {
+    Context::Bound(TextureTarget::CubeMap, *request->texture)
+      .MagFilter(TextureMagFilter::Linear)
+      .MinFilter(TextureMinFilter::Linear)
+      .WrapS(TextureWrap::ClampToEdge)
+      .WrapT(TextureWrap::ClampToEdge)
+      .WrapR(TextureWrap::ClampToEdge);
+    for (int i = 0; i < 6; ++i) {
+      glTexImage2D((GLenum)Texture::CubeMapFace(i), 0, GL_RGBA8, 1, 1, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    }
+    DefaultTexture().Bind(TextureTarget::CubeMap);
+  } else {
+    Context::Bound(TextureTarget::_2D, *request->texture)
+      .MagFilter(TextureMagFilter::Linear)
+      .MinFilter(TextureMinFilter::Linear);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    DefaultTexture().Bind(TextureTarget::_2D);
+  }
+
+  ++outstanding;
+  decodeJobs.erase(std::remove_if(decodeJobs.begin(), decodeJobs.end(), JobSystem::isFinished), decodeJobs.end());
+  decodeJobs.push_back(JobSystem::get().submit([=] {
+    decode(request);
+  }));
+  return request->texture;
+}
+
+TexturePtr TextureLoader::load2dTexture(DataLoader dataLoader, Callback callback, bool flip) {
+  RequestPtr request(new Request());
+  request->callback = callback;
+  request->decoder = [=](int) {
+    return oria::loadImage(dataLoader(), flip);
+  };
+  return enqueue(request);
+}
+
+TexturePtr TextureLoader::load2dTexture(Resource resource, Callback callback) {
+  return load2dTexture([=] {
+    return Platform::getResourceByteVector(resource);
+  }, callback);
+}
+
+TexturePtr TextureLoader::loadCubemapTexture(FaceDataLoader dataLoader, Callback callback, bool flip) {
+  RequestPtr request(new Request());
+  request->cubemap = true;
+  request->callback = callback;
+  request->decoder = [=](int face) {
+    std::vector<uint8_t> data = dataLoader(face);
+    if (data.empty()) {
+      return ImagePtr();
+    }
+    return oria::loadImage(data, flip);
+  };
+  return enqueue(request);
+}
+
+size_t TextureLoader::uploadFace(Request & request, int face) {
+  using namespace oglplus;
+  ImagePtr image = request.images[face];
+  if (!image) {
+    return 0;
+  }
+
+  GLenum target = request.cubemap ?
+    (GLenum)Texture::CubeMapFace(face) : GL_TEXTURE_2D;
+  size_t size = image->DataSize();
+
+  // Orphan the previous contents of the unpack buffer so that we never
+  // wait on an upload the GPU hasn't consumed yet
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GetName(*pixelBuffer));
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  void * dest = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (nullptr != dest) {
+    memcpy(dest, image->RawData(), size);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    // FIXME detect alignment properly, test on both OpenCV and LibPNG
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(target, 0, (GLenum)image->InternalFormat(),
+      image->Width(), image->Height(), 0,
+      (GLenum)image->Format(), (GLenum)image->Type(), nullptr);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return size;
+}
+
+void TextureLoader::update(size_t byteBudget) {
+  using namespace oglplus;
+  if (!pixelBuffer) {
+    pixelBuffer.reset(new Buffer());
+  }
+
+  size_t uploaded = 0;
+  bool first = true;
+  while (first || uploaded < byteBudget) {
+    first = false;
+    RequestPtr request;
+    {
+      Locker lock(mutex);
+      if (uploadQueue.empty()) {
+        break;
+      }
+      request = uploadQueue.front();
+    }
+
+    TextureTarget target = request->cubemap ? TextureTarget::CubeMap : TextureTarget::_2D;
+    request->texture->Bind(target);
+    // Cubemaps are uploaded a face at a time, possibly across several frames
+    uploaded += uploadFace(*request, request->nextFace++);
+    DefaultTexture().Bind(target);
+
+    int faceCount = request->cubemap ? 6 : 1;
+    if (request->nextFace < faceCount) {
+      continue;
+    }
+
+    {
+      Locker lock(mutex);
+      uploadQueue.pop_front();
+    }
+    --outstanding;
+
+    uvec2 size;
+    for (int i = 0; i < faceCount; ++i) {
+      if (request->images[i]) {
+        size = uvec2(request->images[i]->Width(), request->images[i]->Height());
+        break;
+      }
+    }
+    if (request->callback) {
+      request->callback(size);
+    }
+  }
+}
+
+void TextureLoader::shutdownGl() {
+  {
+    Locker lock(mutex);
+    uploadQueue.clear();
+  }
+  outstanding = 0;
+  pixelBuffer.reset();
+}
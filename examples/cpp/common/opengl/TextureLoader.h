@@ -0,0 +1,87 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Loads textures without blocking the render thread.  Image decoding
+ * happens on the shared JobSystem.  The render thread calls update()
+ * once per frame, which copies at most a fixed number of bytes of decoded
+ * pixels into a pixel unpack buffer and from there into the textures.
+ *
+ * Each load call returns a texture immediately.  It holds a 1x1
+ * placeholder until its upload completes, at which point the optional
+ * callback is run on the render thread with the final image size.
+ */
+class TextureLoader {
+public:
+  typedef std::function<std::vector<uint8_t>()> DataLoader;
+  typedef std::function<std::vector<uint8_t>(int)> FaceDataLoader;
+  typedef std::function<void(const uvec2 & size)> Callback;
+
+  static const size_t DEFAULT_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+private:
+  struct Request {
+    TexturePtr texture;
+    bool cubemap{ false };
+    std::function<ImagePtr(int)> decoder;
+    Callback callback;
+    ImagePtr images[6];
+    int nextFace{ 0 };
+  };
+  typedef std::shared_ptr<Request> RequestPtr;
+  typedef std::deque<RequestPtr> RequestQueue;
+  typedef std::mutex Mutex;
+  typedef std::unique_lock<Mutex> Locker;
+
+  RequestQueue uploadQueue;
+  Mutex mutex;
+  // The decode jobs which may still be running
+  JobSystem::JobList decodeJobs;
+  std::atomic<size_t> outstanding{ 0 };
+  std::atomic<bool> shuttingDown{ false };
+  std::unique_ptr<oglplus::Buffer> pixelBuffer;
+
+  void decode(const RequestPtr & request);
+  TexturePtr enqueue(const RequestPtr & request);
+  size_t uploadFace(Request & request, int face);
+
+public:
+  TextureLoader() {}
+  virtual ~TextureLoader();
+
+  TexturePtr load2dTexture(DataLoader dataLoader, Callback callback = Callback(), bool flip = true);
+  TexturePtr load2dTexture(Resource resource, Callback callback = Callback());
+  TexturePtr loadCubemapTexture(FaceDataLoader dataLoader, Callback callback = Callback(), bool flip = true);
+
+  // Must be called on the thread owning the GL context, typically once
+  // per frame.  Uploads at least one face, and then keeps going while
+  // under the byte budget.
+  void update(size_t byteBudget = DEFAULT_UPLOAD_BUDGET);
+
+  // The number of requested textures which haven't finished uploading
+  size_t pending() const {
+    return outstanding;
+  }
+
+  // Discard the GL objects owned by the loader.  Must be called with the
+  // owning context current.
+  void shutdownGl();
+};
@@ -29,15 +29,25 @@ struct TextureInfo {
   uvec2 size;
   TexturePtr tex;
 };
-typedef std::map<Resource, TextureInfo> TextureMap;
-typedef TextureMap::iterator TextureMapItr;
+typedef oria::HandleTable<TextureInfo, oria::TextureHandle> TextureTable;
+typedef std::map<Resource, oria::TextureHandle> TextureIndex;
+
+// Resources are only looked up in the indices when they're resolved,
+// everything after that goes through the table
+struct TextureCache {
+  TextureTable table;
+  TextureIndex textures2d;
+  TextureIndex cubemaps;
+};
 
 namespace oria {
 
-  ImagePtr loadImage(const std::vector<uint8_t> & data, bool flip) {
+  ImagePtr loadImage(const uint8_t * data, size_t size, bool flip) {
     using namespace oglplus;
 #ifdef HAVE_OPENCV
-    cv::Mat image = cv::imdecode(data, cv::IMREAD_COLOR);
+    // Wraps the encoded data without copying it
+    cv::Mat encoded(1, (int)size, CV_8UC1, (void*)data);
+    cv::Mat image = cv::imdecode(encoded, cv::IMREAD_COLOR);
     if (flip) {
       cv::flip(image, image, 0);
     }
@@ -45,34 +55,44 @@ namespace oria {
       PixelDataFormat::BGR, PixelDataInternalFormat::RGBA8));
     return result;
 #else
-    std::stringstream stream(std::string((const char*)&data[0], data.size()));
+    MemoryStream stream(data, size);
     return ImagePtr(new images::PNGImage(stream));
 #endif
   }
 
+  ImagePtr loadImage(const std::vector<uint8_t> & data, bool flip) {
+    return loadImage(data.empty() ? nullptr : &data[0], data.size(), flip);
+  }
+
   ImagePtr loadImage(Resource res, bool flip) {
-    return loadImage(Platform::getResourceByteVector(res), flip);
+    ResourceView view = Platform::getResourceView(res);
+    return loadImage(view.data(), view.size(), flip);
   }
 
-  TextureMap & getTextureMap() {
-    static TextureMap map;
+  TextureCache & getTextureCache() {
+    static TextureCache cache;
     static bool registeredShutdown = false;
     if (!registeredShutdown) {
       Platform::addShutdownHook([&]{
-        map.clear();
+        cache.table.clear();
+        cache.textures2d.clear();
+        cache.cubemaps.clear();
       });
       registeredShutdown = true;
     }
 
-    return map;
+    return cache;
   }
 
-  template <typename T, typename F>
-  T loadOrPopulate(std::map<Resource, T> & map, Resource resource, F loader) {
-    if (!map.count(resource)) {
-      map[resource] = loader();
+  template <typename F>
+  TextureHandle resolveOrPopulate(TextureIndex & index, Resource resource, F loader) {
+    TextureIndex::iterator itr = index.find(resource);
+    if (itr != index.end()) {
+      return itr->second;
     }
-    return map[resource];
+    TextureHandle result = getTextureCache().table.add(loader());
+    index[resource] = result;
+    return result;
   }
 
   TexturePtr load2dTextureFromPngData(std::vector<uint8_t> & data) {
@@ -88,14 +108,13 @@ namespace oria {
     return texture;
   }
 
-  TextureInfo load2dTextureInternal(const std::vector<uint8_t> & data) {
+  static TextureInfo upload2dTexture(const ImagePtr & image) {
     using namespace oglplus;
     TextureInfo result;
     result.tex = TexturePtr(new Texture());
     Context::Bound(TextureTarget::_2D, *result.tex)
       .MagFilter(TextureMagFilter::Linear)
       .MinFilter(TextureMinFilter::Linear);
-    ImagePtr image = loadImage(data);
     result.size.x = image->Width();
     result.size.y = image->Height();
     // FIXME detect alignment properly, test on both OpenCV and LibPNG
@@ -104,8 +123,12 @@ namespace oria {
     return result;
   }
 
+  TextureInfo load2dTextureInternal(const uint8_t * data, size_t size) {
+    return upload2dTexture(loadImage(data, size));
+  }
+
   TexturePtr load2dTexture(const std::vector<uint8_t> & data, uvec2 & outSize) {
-    TextureInfo texInfo = load2dTextureInternal(data);
+    TextureInfo texInfo = load2dTextureInternal(data.empty() ? nullptr : &data[0], data.size());
     outSize = texInfo.size;
     return texInfo.tex;
   }
@@ -115,13 +138,31 @@ namespace oria {
     return load2dTexture(data, size);
   }
 
-  TexturePtr load2dTexture(Resource resource, uvec2 & outSize) {
-    const TextureInfo & texInfo = loadOrPopulate(getTextureMap(), resource, [&] {
-      return load2dTextureInternal(Platform::getResourceByteVector(resource));
+  TextureHandle resolve2dTexture(Resource resource) {
+    return resolveOrPopulate(getTextureCache().textures2d, resource, [&] {
+      ResourceView view = Platform::getResourceView(resource);
+      return load2dTextureInternal(view.data(), view.size());
     });
-    outSize = texInfo.size;
-    return texInfo.tex;
+  }
+
+  TextureHandle resolve2dTexture(Resource resource, const ImagePtr & image) {
+    return resolveOrPopulate(getTextureCache().textures2d, resource, [&] {
+      return upload2dTexture(image);
+    });
+  }
+
+  const TexturePtr & getTexture(TextureHandle handle) {
+    return getTextureCache().table.get(handle).tex;
+  }
 
+  const uvec2 & getTextureSize(TextureHandle handle) {
+    return getTextureCache().table.get(handle).size;
+  }
+
+  TexturePtr load2dTexture(Resource resource, uvec2 & outSize) {
+    TextureHandle handle = resolve2dTexture(resource);
+    outSize = getTextureSize(handle);
+    return getTexture(handle);
   }
 
   TexturePtr load2dTexture(Resource resource) {
@@ -139,22 +180,26 @@ namespace oria {
       .WrapT(TextureWrap::ClampToEdge)
       .WrapR(TextureWrap::ClampToEdge);
 
-    glm::uvec2 size;
+    // Decode the faces in parallel, then upload them here, where the
+    // context is current
+    ImagePtr images[6];
+    JobSystem::get().parallelFor(6, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        images[i] = dataLoader((int)i);
+      }
+    });
     for (int i = 0; i < 6; ++i) {
-      ImagePtr image = dataLoader(i);
-      if (!image) {
-        continue;
+      if (images[i]) {
+        Texture::Image2D(Texture::CubeMapFace(i), *images[i]);
       }
-      Texture::Image2D(Texture::CubeMapFace(i), *image);
     }
     return result;
   }
 
-  TexturePtr loadCubemapTexture(Resource firstResource, int resourceOrder[6], bool flip) {
-    const TextureInfo & texInfo = loadOrPopulate(getTextureMap(), firstResource, [&] {
+  TextureHandle resolveCubemapTexture(Resource firstResource, int resourceOrder[6], bool flip) {
+    return resolveOrPopulate(getTextureCache().cubemaps, firstResource, [&] {
       TextureInfo result;
       result.tex = loadCubemapTexture([&](int i) {
-        Resource imageRes = NO_RESOURCE;
         for (int j = 0; j < 6; ++j) {
           if (resourceOrder[j] == i) {
             return loadImage(static_cast<Resource>(firstResource + resourceOrder[j]), flip);
@@ -164,14 +209,31 @@ namespace oria {
       });
       return result;
     });
-    return texInfo.tex;
   }
 
-  TexturePtr loadCubemapTexture(Resource firstResource, bool flip) {
+  TextureHandle resolveCubemapTexture(Resource firstResource, bool flip) {
     static int RESOURCE_ORDER[] = {
       1, 0, 3, 2, 5, 4
     };
-    return loadCubemapTexture(firstResource, RESOURCE_ORDER, flip);
+    return resolveCubemapTexture(firstResource, RESOURCE_ORDER, flip);
+  }
+
+  TextureHandle resolveCubemapTexture(Resource firstResource, const ImagePtr faces[6]) {
+    return resolveOrPopulate(getTextureCache().cubemaps, firstResource, [&] {
+      TextureInfo result;
+      result.tex = loadCubemapTexture([&](int i) {
+        return faces[i];
+      });
+      return result;
+    });
+  }
+
+  TexturePtr loadCubemapTexture(Resource firstResource, int resourceOrder[6], bool flip) {
+    return getTexture(resolveCubemapTexture(firstResource, resourceOrder, flip));
+  }
+
+  TexturePtr loadCubemapTexture(Resource firstResource, bool flip) {
+    return getTexture(resolveCubemapTexture(firstResource, flip));
   }
 
 }
@@ -23,6 +23,7 @@ typedef std::shared_ptr<oglplus::Texture> TexturePtr;
 typedef std::shared_ptr<oglplus::images::Image> ImagePtr;
 
 namespace oria {
+  ImagePtr loadImage(const uint8_t * data, size_t size, bool flip = true);
   ImagePtr loadImage(const std::vector<uint8_t> & data, bool flip = true);
   TexturePtr load2dTextureFromPngData(std::vector<uint8_t> & data);
   TexturePtr load2dTexture(const std::vector<uint8_t> & data);
@@ -34,4 +35,17 @@ namespace oria {
   TexturePtr load2dTexture(Resource resource, uvec2 & outSize);
   TexturePtr loadCubemapTexture(Resource firstResource, int resourceOrder[6], bool flip = true);
   TexturePtr loadCubemapTexture(Resource firstResource, bool flip = true);
+
+  // Resolve a resource to a handle once, then fetch the texture through
+  // the handle on the render path
+  TextureHandle resolve2dTexture(Resource resource);
+  TextureHandle resolveCubemapTexture(Resource firstResource, int resourceOrder[6], bool flip = true);
+  TextureHandle resolveCubemapTexture(Resource firstResource, bool flip = true);
+  // The same for images already decoded, such as on another thread.  The
+  // cubemap faces are in GL face order.  A texture already cached for the
+  // resource is returned as it is.
+  TextureHandle resolve2dTexture(Resource resource, const ImagePtr & image);
+  TextureHandle resolveCubemapTexture(Resource firstResource, const ImagePtr faces[6]);
+  const TexturePtr & getTexture(TextureHandle handle);
+  const uvec2 & getTextureSize(TextureHandle handle);
 }
@@ -0,0 +1,193 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+
+#include "Common.h"
+
+static glm::quat eulerToQuat(float yaw, float pitch, float roll) {
+  return glm::angleAxis(yaw * DEGREES_TO_RADIANS, glm::vec3(0, 1, 0)) *
+    glm::angleAxis(pitch * DEGREES_TO_RADIANS, glm::vec3(1, 0, 0)) *
+    glm::angleAxis(roll * DEGREES_TO_RADIANS, glm::vec3(0, 0, 1));
+}
+
+bool PoseScript::parse(const std::string & text) {
+  keys.clear();
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t start = line.find_first_not_of(" \t\r");
+    if (std::string::npos == start || '#' == line[start]) {
+      continue;
+    }
+    std::istringstream fields(line);
+    float time, yaw, pitch, roll;
+    glm::vec3 position;
+    if (!(fields >> time >> yaw >> pitch >> roll >> position.x >> position.y >> position.z)) {
+      SAY_ERR("Skipping malformed pose script line: %s", line.c_str());
+      continue;
+    }
+    if (!keys.empty() && time <= keys.back().time) {
+      SAY_ERR("Skipping out of order pose script line: %s", line.c_str());
+      continue;
+    }
+    Key key;
+    key.time = time;
+    key.orientation = eulerToQuat(yaw, pitch, roll);
+    key.position = position;
+    keys.push_back(key);
+  }
+  return !keys.empty();
+}
+
+void PoseScript::loadDefault() {
+  parse(
+    "0   0   0  0  0     0 0\n"
+    "2  45   0  0  0.05  0 0\n"
+    "4 -45   0  0 -0.05  0 0\n"
+    "6   0  20  0  0     0.05 0\n"
+    "8   0 -20  0  0    -0.05 0\n"
+    "10  0   0  0  0     0 0\n");
+}
+
+float PoseScript::getDuration() const {
+  return keys.empty() ? 0.0f : keys.back().time;
+}
+
+void PoseScript::getPose(float seconds, glm::quat & outOrientation, glm::vec3 & outPosition) const {
+  if (keys.empty()) {
+    outOrientation = glm::quat();
+    outPosition = glm::vec3();
+    return;
+  }
+  float duration = getDuration();
+  if (duration > 0) {
+    seconds = fmod(seconds, duration);
+  }
+  size_t next = 0;
+  while (next < keys.size() && keys[next].time <= seconds) {
+    ++next;
+  }
+  if (0 == next || keys.size() == next) {
+    const Key & key = keys[0 == next ? 0 : keys.size() - 1];
+    outOrientation = key.orientation;
+    outPosition = key.position;
+    return;
+  }
+  const Key & a = keys[next - 1];
+  const Key & b = keys[next];
+  float t = (seconds - a.time) / (b.time - a.time);
+  outOrientation = glm::slerp(a.orientation, b.orientation, t);
+  outPosition = glm::mix(a.position, b.position, t);
+}
+
+HeadlessBenchmark::HeadlessBenchmark() {
+  frameCount = atoi(getenv("ORIA_HEADLESS_FRAMES"));
+  cpuMillis = TimingHistogram(frameCount);
+
+  const char * output = getenv("ORIA_HEADLESS_OUTPUT");
+  outputPath = output ? output : "headless_timing.json";
+  const char * context = getenv("ORIA_HEADLESS_CONTEXT");
+  contextApi = context ? context : "";
+
+  const char * posePath = getenv("ORIA_HEADLESS_POSES");
+  if (!posePath) {
+    poses.loadDefault();
+  } else if (!poses.parse(oria::readFile(posePath))) {
+    FAIL("No poses found in %s", posePath);
+  }
+  SAY("Headless run of %d frames, timings will be written to %s", frameCount, outputPath.c_str());
+}
+
+HeadlessBenchmark * HeadlessBenchmark::get() {
+  static bool checked = false;
+  static std::unique_ptr<HeadlessBenchmark> instance;
+  if (!checked) {
+    checked = true;
+    const char * frames = getenv("ORIA_HEADLESS_FRAMES");
+    if (frames && atoi(frames) > 0) {
+      instance.reset(new HeadlessBenchmark());
+    }
+  }
+  return instance.get();
+}
+
+void HeadlessBenchmark::getEyePoses(const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]) const {
+  glm::quat orientation;
+  glm::vec3 position;
+  poses.getPose((float)frame / (float)FRAME_RATE, orientation, position);
+  for_each_eye([&](ovrEyeType eye) {
+    outPoses[eye].Orientation = ovr::fromGlm(orientation);
+    outPoses[eye].Position = ovr::fromGlm(position + orientation * ovr::toGlm(eyeOffsets[eye]));
+  });
+}
+
+void HeadlessBenchmark::beginFrame() {
+  assert(!isFinished());
+  if (queries.empty()) {
+    queries.resize(frameCount);
+    glGenQueries(frameCount, &queries[0]);
+  }
+  frameStart = Clock::now();
+  glBeginQuery(GL_TIME_ELAPSED, queries[frame]);
+}
+
+void HeadlessBenchmark::endFrame() {
+  glEndQuery(GL_TIME_ELAPSED);
+  // Without a swap nothing else makes sure the commands get submitted
+  glFlush();
+  cpuMillis.add(std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count());
+  ++frame;
+}
+
+static std::string toJson(const char * name, const TimingHistogram & h) {
+  std::string result = Platform::format(
+    "  \"%s\": { \"average\": %f, \"p50\": %f, \"p95\": %f, \"p99\": %f, \"max\": %f, \"samples\": [",
+    name, h.average(), h.percentile(0.50f), h.percentile(0.95f), h.percentile(0.99f), h.maximum());
+  std::vector<float> samples = h.getSamples();
+  for (size_t i = 0; i < samples.size(); ++i) {
+    result += Platform::format(i ? ", %f" : "%f", samples[i]);
+  }
+  return result + "] }";
+}
+
+void HeadlessBenchmark::finish() {
+  TimingHistogram gpuMillis(frameCount);
+  for (int i = 0; i < frame; ++i) {
+    GLuint64 nanos = 0;
+    glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanos);
+    gpuMillis.add((float)nanos / 1e6f);
+  }
+  if (!queries.empty()) {
+    glDeleteQueries(frameCount, &queries[0]);
+    queries.clear();
+  }
+
+  std::string result = "{\n";
+  result += Platform::format("  \"frames\": %d,\n", frame);
+  result += Platform::format("  \"renderer\": \"%s\",\n", (const char *)glGetString(GL_RENDERER));
+  result += toJson("cpuFrame", cpuMillis) + ",\n";
+  result += toJson("gpuFrame", gpuMillis) + "\n";
+  result += "}\n";
+  if (!oria::writeFile(outputPath, result)) {
+    SAY_ERR("Could not write the headless timings to %s", outputPath.c_str());
+    return;
+  }
+  SAY("Headless timings written to %s: CPU %0.2f ms, GPU %0.2f ms per frame on average",
+    outputPath.c_str(), cpuMillis.average(), gpuMillis.average());
+}
@@ -0,0 +1,113 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+
+#pragma once
+
+/**
+ * Head poses keyed by time, read from text with one key per line:
+ *
+ *   seconds yaw pitch roll x y z
+ *
+ * with the angles in degrees and the position in meters.  Blank lines and
+ * lines starting with # are skipped.  Poses between keys are
+ * interpolated, and the script loops after the last key.
+ */
+class PoseScript {
+  struct Key {
+    float time;
+    glm::quat orientation;
+    glm::vec3 position;
+  };
+
+  std::vector<Key> keys;
+
+public:
+  // Returns false, leaving the script empty, if no keys could be read
+  bool parse(const std::string & text);
+  // A slow look around, left, right, up and down
+  void loadDefault();
+
+  float getDuration() const;
+  void getPose(float seconds, glm::quat & outOrientation, glm::vec3 & outPosition) const;
+};
+
+/**
+ * Runs a Rift app without a headset, a visible window or vsync, for scene
+ * regressions on machines with nothing more than a software rasterizer.
+ * It's controlled from the environment, so any RiftApp or
+ * RiftRenderingApp can run this way unchanged:
+ *
+ *   ORIA_HEADLESS_FRAMES   the number of frames to render, which turns
+ *                          headless mode on
+ *   ORIA_HEADLESS_POSES    a PoseScript file, by default a slow look around
+ *   ORIA_HEADLESS_OUTPUT   where to write the per frame timings as JSON,
+ *                          headless_timing.json by default
+ *   ORIA_HEADLESS_CONTEXT  "egl" or "osmesa" to create the context through
+ *                          those rather than the window system, where GLFW
+ *                          and GLEW were built with support for them
+ *
+ * The apps use a debug HMD, render the eye textures as usual and then
+ * skip the SDK distortion and present.  The frames are timed at a fixed
+ * simulated rate, so the same frame always gets the same pose.
+ */
+class HeadlessBenchmark {
+  typedef std::chrono::steady_clock Clock;
+
+  int frameCount{ 0 };
+  std::string outputPath;
+  std::string contextApi;
+  PoseScript poses;
+
+  int frame{ 0 };
+  Clock::time_point frameStart;
+  TimingHistogram cpuMillis;
+  // One GL_TIME_ELAPSED query per frame, read back once the run is over
+  // so they never stall it.  These replace the FrameTiming GPU timer for
+  // the run, since the queries can't nest.
+  std::vector<GLuint> queries;
+
+  HeadlessBenchmark();
+
+public:
+  // The simulated display rate, matching the DK2
+  static const int FRAME_RATE = 75;
+
+  // Null unless headless mode was requested
+  static HeadlessBenchmark * get();
+
+  const std::string & getContextApi() const {
+    return contextApi;
+  }
+
+  bool isFinished() const {
+    return frame >= frameCount;
+  }
+
+  // The scripted eye poses for the current frame, in the form
+  // ovrHmd_GetEyePoses returns them
+  void getEyePoses(const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]) const;
+
+  void beginFrame();
+  void endFrame();
+
+  // Waits for the outstanding GPU timings and writes the results.  Call
+  // from the thread owning the GL context once isFinished() is true.
+  void finish();
+};
@@ -0,0 +1,250 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+
+#include "Common.h"
+
+// Marks the cells of the grid which the triangles of the distortion mesh
+// may sample from.  The bounds of each triangle are used rather than the
+// triangle itself, which costs little given how small they are.
+static void markSampledCells(const ovrDistortionMesh & mesh,
+    const ovrVector2f scaleAndOffset[2], const glm::uvec2 & size,
+    const glm::uvec2 & cells, std::vector<uint8_t> & visible) {
+  const ovrVector2f & scale = scaleAndOffset[0];
+  const ovrVector2f & offset = scaleAndOffset[1];
+  const float cellSize = (float)HiddenAreaMask::CELL_SIZE;
+  for (unsigned int i = 0; i + 2 < mesh.IndexCount; i += 3) {
+    const ovrDistortionVertex * v[3] = {
+      &mesh.pVertexData[mesh.pIndexData[i]],
+      &mesh.pVertexData[mesh.pIndexData[i + 1]],
+      &mesh.pVertexData[mesh.pIndexData[i + 2]],
+    };
+    // Fully vignetted triangles come out black whatever they sample
+    if (v[0]->VignetteFactor <= 0 && v[1]->VignetteFactor <= 0 && v[2]->VignetteFactor <= 0) {
+      continue;
+    }
+
+    glm::vec2 minPixel(std::numeric_limits<float>::max());
+    glm::vec2 maxPixel(-std::numeric_limits<float>::max());
+    for (int j = 0; j < 3; ++j) {
+      const ovrVector2f * angles[3] = {
+        &v[j]->TanEyeAnglesR, &v[j]->TanEyeAnglesG, &v[j]->TanEyeAnglesB
+      };
+      for (int c = 0; c < 3; ++c) {
+        glm::vec2 uv(angles[c]->x * scale.x + offset.x, angles[c]->y * scale.y + offset.y);
+        glm::vec2 pixel = uv * glm::vec2(size);
+        minPixel = glm::min(minPixel, pixel);
+        maxPixel = glm::max(maxPixel, pixel);
+      }
+    }
+
+    // Whether V points up or down in the texture depends on how the SDK
+    // was told to flip its input, so mark the mirror image as well.  The
+    // lens is close to symmetric vertically, so this keeps little that
+    // could have been masked.
+    for (int mirror = 0; mirror < 2; ++mirror) {
+      float minY = mirror ? size.y - maxPixel.y : minPixel.y;
+      float maxY = mirror ? size.y - minPixel.y : maxPixel.y;
+      int x0 = glm::clamp((int)floor(minPixel.x / cellSize), 0, (int)cells.x - 1);
+      int x1 = glm::clamp((int)floor(maxPixel.x / cellSize), 0, (int)cells.x - 1);
+      int y0 = glm::clamp((int)floor(minY / cellSize), 0, (int)cells.y - 1);
+      int y1 = glm::clamp((int)floor(maxY / cellSize), 0, (int)cells.y - 1);
+      for (int y = y0; y <= y1; ++y) {
+        memset(&visible[y * cells.x + x0], 1, x1 - x0 + 1);
+      }
+    }
+  }
+}
+
+// Builds the quads covering the cells that can't be seen, in normalized
+// device coordinates, merging the runs of hidden cells along each row.
+// Returns the share of the texture they cover.
+static float buildHiddenQuads(const std::vector<uint8_t> & visible,
+    const glm::uvec2 & size, const glm::uvec2 & cells,
+    std::vector<glm::vec2> & vertices) {
+  const int cellSize = HiddenAreaMask::CELL_SIZE;
+  size_t hiddenPixels = 0;
+  for (unsigned int y = 0; y < cells.y; ++y) {
+    unsigned int x = 0;
+    while (x < cells.x) {
+      if (visible[y * cells.x + x]) {
+        ++x;
+        continue;
+      }
+      unsigned int start = x;
+      while (x < cells.x && !visible[y * cells.x + x]) {
+        ++x;
+      }
+      // The last row and column of cells may hang over the edge
+      glm::uvec2 minPixel(start * cellSize, y * cellSize);
+      glm::uvec2 maxPixel = glm::min(glm::uvec2(x * cellSize, (y + 1) * cellSize), size);
+      hiddenPixels += (maxPixel.x - minPixel.x) * (maxPixel.y - minPixel.y);
+
+      glm::vec2 a = glm::vec2(minPixel) / glm::vec2(size) * 2.0f - 1.0f;
+      glm::vec2 b = glm::vec2(maxPixel) / glm::vec2(size) * 2.0f - 1.0f;
+      vertices.push_back(vec2(a.x, a.y));
+      vertices.push_back(vec2(b.x, a.y));
+      vertices.push_back(vec2(b.x, b.y));
+      vertices.push_back(vec2(a.x, a.y));
+      vertices.push_back(vec2(b.x, b.y));
+      vertices.push_back(vec2(a.x, b.y));
+    }
+  }
+  return (float)hiddenPixels / (float)(size.x * size.y);
+}
+
+HiddenAreaMask::~HiddenAreaMask() {
+  shutdownGl();
+}
+
+void HiddenAreaMask::init(ovrHmd hmd, const ovrFovPort fovs[2], const ovrTexture eyeTextures[2], unsigned int distortionCaps) {
+  shutdownGl();
+  program = oria::loadProgram(Resource::SHADERS_SIMPLE_VS, Resource::SHADERS_COLORED_FS);
+
+  for_each_eye([&](ovrEyeType eye) {
+    const ovrTextureHeader & header = eyeTextures[eye].Header;
+    glm::uvec2 size = ovr::toGlm(header.TextureSize);
+    glm::uvec2 cells = (size + glm::uvec2(CELL_SIZE - 1)) / glm::uvec2(CELL_SIZE);
+
+    ovrDistortionMesh mesh;
+    if (!ovrHmd_CreateDistortionMesh(hmd, eye, fovs[eye], distortionCaps, &mesh)) {
+      SAY_ERR("Could not create the distortion mesh, the hidden area won't be masked");
+      return;
+    }
+    // Where the distortion samples scales with the render viewport, so
+    // the mask is worked out for a viewport filling the texture, and
+    // fitted to the actual viewport when it's drawn
+    ovrRecti fullViewport;
+    fullViewport.Pos.x = fullViewport.Pos.y = 0;
+    fullViewport.Size = header.TextureSize;
+    ovrVector2f scaleAndOffset[2];
+    ovrHmd_GetRenderScaleAndOffset(fovs[eye], header.TextureSize,
+      fullViewport, scaleAndOffset);
+
+    std::vector<uint8_t> sampled(cells.x * cells.y, 0);
+    markSampledCells(mesh, scaleAndOffset, size, cells, sampled);
+    ovrHmd_DestroyDistortionMesh(&mesh);
+
+    // Grow the visible area by a cell in every direction
+    std::vector<uint8_t> visible(sampled);
+    for (int y = 0; y < (int)cells.y; ++y) {
+      for (int x = 0; x < (int)cells.x; ++x) {
+        if (!sampled[y * cells.x + x]) {
+          continue;
+        }
+        for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, (int)cells.y - 1); ++ny) {
+          for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, (int)cells.x - 1); ++nx) {
+            visible[ny * cells.x + nx] = 1;
+          }
+        }
+      }
+    }
+
+    std::vector<glm::vec2> vertices;
+    EyeMask & mask = eyes[eye];
+    mask.hiddenFraction = buildHiddenQuads(visible, size, cells, vertices);
+    mask.vertexCount = (GLsizei)vertices.size();
+    if (vertices.empty()) {
+      return;
+    }
+
+    glGenVertexArrays(1, &mask.vertexArray);
+    glBindVertexArray(mask.vertexArray);
+    glGenBuffers(1, &mask.vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mask.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
+    glEnableVertexAttribArray(oria::Layout::Attribute::Position);
+    glVertexAttribPointer(oria::Layout::Attribute::Position, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  });
+  SAY("%s", getSummary().c_str());
+}
+
+void HiddenAreaMask::shutdownGl() {
+  for_each_eye([&](ovrEyeType eye) {
+    EyeMask & mask = eyes[eye];
+    if (mask.vertexArray) {
+      glDeleteVertexArrays(1, &mask.vertexArray);
+    }
+    if (mask.vertexBuffer) {
+      glDeleteBuffers(1, &mask.vertexBuffer);
+    }
+    mask = EyeMask();
+  });
+  program.reset();
+}
+
+void HiddenAreaMask::begin(ovrEyeType eye, const ovrRecti & viewport) {
+  const EyeMask & mask = eyes[eye];
+  glStencilMask(0xFF);
+  glClearStencil(0);
+  glClear(GL_STENCIL_BUFFER_BIT);
+  if (!mask.vertexCount) {
+    return;
+  }
+
+  GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+  GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_FALSE);
+  glEnable(GL_STENCIL_TEST);
+  glStencilFunc(GL_ALWAYS, 1, 0xFF);
+  glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
+
+  // The quads are already in clip space, relative to the eye's viewport
+  GLint oldViewport[4];
+  glGetIntegerv(GL_VIEWPORT, oldViewport);
+  glViewport(viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h);
+  program->Use();
+  const oria::ProgramUniforms & uniforms = oria::getUniforms(*program);
+  glUniformMatrix4fv(uniforms.modelView, 1, GL_FALSE, glm::value_ptr(glm::mat4()));
+  oria::setProjection(*program, glm::mat4());
+  glBindVertexArray(mask.vertexArray);
+  glDrawArrays(GL_TRIANGLES, 0, mask.vertexCount);
+  glBindVertexArray(0);
+  oglplus::NoProgram().Bind();
+  glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glDepthMask(GL_TRUE);
+  if (depthTest) {
+    glEnable(GL_DEPTH_TEST);
+  }
+  if (cullFace) {
+    glEnable(GL_CULL_FACE);
+  }
+  // Leave the stencil read only for the scene, so the hardware can reject
+  // the masked fragments early
+  glStencilFunc(GL_EQUAL, 0, 0xFF);
+  glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+  glStencilMask(0);
+}
+
+void HiddenAreaMask::end() {
+  glDisable(GL_STENCIL_TEST);
+  glStencilMask(0xFF);
+}
+
+std::string HiddenAreaMask::getSummary() const {
+  return Platform::format("Hidden area mask saves %0.1f%% of the left eye's pixels, %0.1f%% of the right eye's",
+    eyes[ovrEye_Left].hiddenFraction * 100.0f, eyes[ovrEye_Right].hiddenFraction * 100.0f);
+}
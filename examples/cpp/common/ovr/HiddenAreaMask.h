@@ -0,0 +1,82 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+
+#pragma once
+
+/**
+ * Masks out the parts of the eye buffers the distortion never samples.
+ *
+ * The hidden area is found once, from the SDK distortion mesh for each
+ * eye: the cells of a coarse grid over the eye texture which none of the
+ * mesh triangles can read from, for any of the three color channels, are
+ * collected into a set of quads.  At the start of each eye pass those
+ * quads are drawn into the stencil buffer, and the stencil test then
+ * rejects the scene's fragments there before they're shaded.
+ *
+ * The quads are relative to the eye's render viewport, so they're drawn
+ * into whatever viewport the eye is currently rendered to, and follow it
+ * when an app scales the viewport down.
+ *
+ * Stencil rather than depth, because the scenes clear the depth buffer
+ * themselves.  The eye framebuffers need a stencil attachment.
+ */
+class HiddenAreaMask {
+  struct EyeMask {
+    GLuint vertexArray{ 0 };
+    GLuint vertexBuffer{ 0 };
+    GLsizei vertexCount{ 0 };
+    float hiddenFraction{ 0 };
+  };
+
+  EyeMask eyes[2];
+  ProgramPtr program;
+  bool active{ false };
+
+public:
+  // The grid resolution, in pixels.  Every cell next to a visible one is
+  // kept as well, which covers filtering and the small shifts timewarp
+  // makes to where the distortion samples.
+  static const int CELL_SIZE = 16;
+
+  ~HiddenAreaMask();
+
+  // Builds the masks for textures rendered with the given field of view
+  // and distortion caps.
+  void init(ovrHmd hmd, const ovrFovPort fovs[2], const ovrTexture eyeTextures[2], unsigned int distortionCaps);
+  void shutdownGl();
+
+  bool isInitialized() const {
+    return (bool)program;
+  }
+
+  // Writes the mask into the stencil buffer of the bound framebuffer,
+  // over the viewport the eye is rendered to, and enables the stencil
+  // test.  The scene's color and depth clears leave the stencil alone.
+  void begin(ovrEyeType eye, const ovrRecti & viewport);
+  // Disables the stencil test again
+  void end();
+
+  // The share of the eye's viewport which is masked out, from 0 to 1
+  float getHiddenFraction(ovrEyeType eye) const {
+    return eyes[eye].hiddenFraction;
+  }
+
+  std::string getSummary() const;
+};
@@ -98,6 +98,28 @@ namespace ovr {
       : createDirectHmdModeWindow(hmd, outSize);
   }
 
+  Frustum getStereoFrustum(const ovrFovPort fovs[2], const glm::mat4 views[2], float nearPlane, float farPlane) {
+    ovrFovPort fov;
+    fov.UpTan = std::max(fovs[0].UpTan, fovs[1].UpTan);
+    fov.DownTan = std::max(fovs[0].DownTan, fovs[1].DownTan);
+    fov.LeftTan = std::max(fovs[0].LeftTan, fovs[1].LeftTan);
+    fov.RightTan = std::max(fovs[0].RightTan, fovs[1].RightTan);
+
+    glm::mat4 leftEye = glm::inverse(views[0]);
+    glm::mat4 rightEye = glm::inverse(views[1]);
+    float halfIpd = glm::distance(glm::vec3(leftEye[3]), glm::vec3(rightEye[3])) / 2.0f;
+
+    // In the head's frame the eyes are at x = -halfIpd and x = halfIpd,
+    // looking down -z
+    float tanSum = fov.LeftTan + fov.RightTan;
+    glm::vec3 apex(halfIpd * (fov.LeftTan - fov.RightTan) / tanSum, 0, 2.0f * halfIpd / tanSum);
+
+    glm::mat4 head = leftEye;
+    head[3] = (leftEye[3] + rightEye[3]) / 2.0f;
+    glm::mat4 view = glm::inverse(head * glm::translate(glm::mat4(), apex));
+    glm::mat4 projection = toGlm(fov, nearPlane + apex.z, farPlane + apex.z);
+    return Frustum(projection * view);
+  }
 }
 
 namespace oria {
@@ -94,6 +94,13 @@ namespace ovr {
   }
 
   GLFWwindow * createRiftRenderingWindow(ovrHmd hmd, glm::uvec2 & outSize, glm::ivec2 & outPosition);
+
+  // A single frustum enclosing the frusta of both eyes, for culling the
+  // scene once per frame.  views are the per-eye view matrices.  The
+  // apex sits behind the eyes, where the outer planes of the two eye
+  // frusta meet.
+  Frustum getStereoFrustum(const ovrFovPort fovs[2], const glm::mat4 views[2],
+    float nearPlane = 0.01f, float farPlane = 10000.0f);
 }
 
 namespace oria {
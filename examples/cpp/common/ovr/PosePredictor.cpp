@@ -0,0 +1,161 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+namespace oria {
+
+  void extrapolate(const MotionState & state, float dt, glm::quat & outOrientation, glm::vec3 & outPosition) {
+    // The rotation over the interval as a rotation vector, in the head's
+    // frame, so it applies on the right
+    glm::vec3 rotation = state.angularVelocity * dt + state.angularAcceleration * (0.5f * dt * dt);
+    float angle = glm::length(rotation);
+    glm::quat delta;
+    if (angle > 1e-9f) {
+      float halfAngle = angle * 0.5f;
+      glm::vec3 axis = rotation * (sinf(halfAngle) / angle);
+      delta = glm::quat(cosf(halfAngle), axis.x, axis.y, axis.z);
+    }
+    outOrientation = glm::normalize(state.orientation * delta);
+    outPosition = state.position + state.linearVelocity * dt + state.linearAcceleration * (0.5f * dt * dt);
+  }
+
+}
+
+ovrPosef PosePredictor::predict(double time) const {
+  glm::quat orientation;
+  glm::vec3 position;
+  oria::extrapolate(state, (float)(time - state.time), orientation, position);
+  ovrPosef result;
+  result.Orientation = ovr::fromGlm(orientation);
+  result.Position = ovr::fromGlm(position);
+  return result;
+}
+
+static void setPose(oria::MotionState & state, const ovrPoseStatef & sample) {
+  state.time = sample.TimeInSeconds;
+  state.orientation = ovr::toGlm(sample.ThePose.Orientation);
+  state.position = ovr::toGlm(sample.ThePose.Position);
+}
+
+void NoPredictor::addSample(const ovrPoseStatef & sample) {
+  setPose(state, sample);
+}
+
+void ConstantVelocityPredictor::addSample(const ovrPoseStatef & sample) {
+  setPose(state, sample);
+  state.angularVelocity = ovr::toGlm(sample.AngularVelocity);
+  state.linearVelocity = ovr::toGlm(sample.LinearVelocity);
+}
+
+void ConstantAccelerationPredictor::addSample(const ovrPoseStatef & sample) {
+  setPose(state, sample);
+  state.angularVelocity = ovr::toGlm(sample.AngularVelocity);
+  state.linearVelocity = ovr::toGlm(sample.LinearVelocity);
+  state.angularAcceleration = ovr::toGlm(sample.AngularAcceleration);
+  state.linearAcceleration = ovr::toGlm(sample.LinearAcceleration);
+}
+
+// One step of a constant rate of change model: predict both terms dt
+// ahead, then correct them with the measured value.  The process noise
+// enters as white noise on the rate of change.
+void KalmanPredictor::Filter::update(float measured, float dt, float processNoise, float measurementNoise) {
+  if (!initialized) {
+    value = measured;
+    rate = 0;
+    p00 = measurementNoise;
+    p01 = 0;
+    p11 = processNoise;
+    initialized = true;
+    return;
+  }
+
+  value += rate * dt;
+  float dt2 = dt * dt;
+  p00 += dt * (2.0f * p01 + dt * p11) + processNoise * dt2 * dt / 3.0f;
+  p01 += dt * p11 + processNoise * dt2 / 2.0f;
+  p11 += processNoise * dt;
+
+  float residual = measured - value;
+  float s = p00 + measurementNoise;
+  float k0 = p00 / s;
+  float k1 = p01 / s;
+  value += k0 * residual;
+  rate += k1 * residual;
+  p11 -= k1 * p01;
+  p01 -= k1 * p00;
+  p00 -= k0 * p00;
+}
+
+KalmanPredictor::KalmanPredictor(float angularProcessNoise, float angularMeasurementNoise,
+  float linearProcessNoise, float linearMeasurementNoise)
+  : angularProcessNoise(angularProcessNoise), angularMeasurementNoise(angularMeasurementNoise),
+  linearProcessNoise(linearProcessNoise), linearMeasurementNoise(linearMeasurementNoise) {
+}
+
+void KalmanPredictor::reset() {
+  PosePredictor::reset();
+  for (int i = 0; i < 3; ++i) {
+    angular[i] = Filter();
+    linear[i] = Filter();
+  }
+  lastTime = -1;
+}
+
+void KalmanPredictor::addSample(const ovrPoseStatef & sample) {
+  // Out of order or repeated samples would make the filter diverge
+  float dt = lastTime < 0 ? 0 : (float)(sample.TimeInSeconds - lastTime);
+  if (lastTime >= 0 && dt <= 0) {
+    return;
+  }
+  lastTime = sample.TimeInSeconds;
+  setPose(state, sample);
+
+  glm::vec3 angularVelocity = ovr::toGlm(sample.AngularVelocity);
+  glm::vec3 linearVelocity = ovr::toGlm(sample.LinearVelocity);
+  for (int i = 0; i < 3; ++i) {
+    Filter & a = angular[i];
+    a.update(angularVelocity[i], dt, angularProcessNoise, angularMeasurementNoise);
+    state.angularVelocity[i] = a.value;
+    state.angularAcceleration[i] = a.rate;
+
+    Filter & l = linear[i];
+    l.update(linearVelocity[i], dt, linearProcessNoise, linearMeasurementNoise);
+    state.linearVelocity[i] = l.value;
+    state.linearAcceleration[i] = l.rate;
+  }
+}
+
+std::unique_ptr<PosePredictor> PosePredictor::create(const std::string & name) {
+  std::unique_ptr<PosePredictor> result;
+  if (name == "none") {
+    result.reset(new NoPredictor());
+  } else if (name == "velocity") {
+    result.reset(new ConstantVelocityPredictor());
+  } else if (name == "acceleration") {
+    result.reset(new ConstantAccelerationPredictor());
+  } else if (name == "kalman") {
+    result.reset(new KalmanPredictor());
+  }
+  return result;
+}
+
+std::vector<std::string> PosePredictor::getNames() {
+  return { "none", "velocity", "acceleration", "kalman" };
+}
@@ -0,0 +1,139 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+namespace oria {
+
+  // What a predictor knows of the head's motion at one moment: the pose
+  // and its first two derivatives.  The angular ones are in radians, in
+  // the head's frame, as the SDK reports them.
+  struct MotionState {
+    double time{ 0 };
+    glm::quat orientation;
+    glm::vec3 angularVelocity;
+    glm::vec3 angularAcceleration;
+    glm::vec3 position;
+    glm::vec3 linearVelocity;
+    glm::vec3 linearAcceleration;
+  };
+
+  // Extrapolates a motion state dt seconds ahead, assuming constant
+  // acceleration.  Zero accelerations give constant velocity.
+  void extrapolate(const MotionState & state, float dt, glm::quat & outOrientation, glm::vec3 & outPosition);
+
+}
+
+/**
+ * Predicts where the head will be when a frame is shown, from the
+ * tracking samples seen so far.  The predictors differ only in how they
+ * estimate the motion state they extrapolate from, so the extrapolation
+ * can be shared, and done in bulk by the PredictionEvaluator.
+ */
+class PosePredictor {
+protected:
+  oria::MotionState state;
+
+public:
+  virtual ~PosePredictor() {}
+
+  virtual const char * getName() const = 0;
+  virtual void reset() {
+    state = oria::MotionState();
+  }
+  // Feeds in the newest tracking sample
+  virtual void addSample(const ovrPoseStatef & sample) = 0;
+
+  const oria::MotionState & getState() const {
+    return state;
+  }
+
+  // The head pose at an absolute time, on the clock of the samples
+  ovrPosef predict(double time) const;
+
+  // Creates one of the predictors below by name: none, velocity,
+  // acceleration or kalman.  Returns null for an unknown name.
+  static std::unique_ptr<PosePredictor> create(const std::string & name);
+  static std::vector<std::string> getNames();
+};
+
+// Holds the last sample, as a baseline for the others
+class NoPredictor : public PosePredictor {
+public:
+  virtual const char * getName() const {
+    return "none";
+  }
+  virtual void addSample(const ovrPoseStatef & sample);
+};
+
+// Extrapolates with the velocities the SDK reports
+class ConstantVelocityPredictor : public PosePredictor {
+public:
+  virtual const char * getName() const {
+    return "velocity";
+  }
+  virtual void addSample(const ovrPoseStatef & sample);
+};
+
+// Extrapolates with the velocities and accelerations the SDK reports
+class ConstantAccelerationPredictor : public PosePredictor {
+public:
+  virtual const char * getName() const {
+    return "acceleration";
+  }
+  virtual void addSample(const ovrPoseStatef & sample);
+};
+
+/**
+ * Smooths the reported angular and linear velocities with a Kalman
+ * filter per axis, tracking each velocity and its rate of change, and
+ * extrapolates with the filtered values.  The accelerations the SDK
+ * reports are too noisy to use directly.
+ *
+ * The process noise is the variance of the change in acceleration per
+ * second, the measurement noise that of the reported velocities.
+ */
+class KalmanPredictor : public PosePredictor {
+  struct Filter {
+    float value{ 0 };
+    float rate{ 0 };
+    float p00{ 0 }, p01{ 0 }, p11{ 0 };
+    bool initialized{ false };
+
+    void update(float measured, float dt, float processNoise, float measurementNoise);
+  };
+
+  Filter angular[3];
+  Filter linear[3];
+  float angularProcessNoise;
+  float angularMeasurementNoise;
+  float linearProcessNoise;
+  float linearMeasurementNoise;
+  double lastTime{ -1 };
+
+public:
+  KalmanPredictor(float angularProcessNoise = 2000.0f, float angularMeasurementNoise = 0.01f,
+    float linearProcessNoise = 100.0f, float linearMeasurementNoise = 0.001f);
+
+  virtual const char * getName() const {
+    return "kalman";
+  }
+  virtual void reset();
+  virtual void addSample(const ovrPoseStatef & sample);
+};
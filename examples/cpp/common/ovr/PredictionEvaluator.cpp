@@ -0,0 +1,339 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+void PredictionEvaluator::States::resize(size_t size) {
+  for (int c = 0; c < 4; ++c) {
+    q[c].resize(size);
+  }
+  for (int c = 0; c < 3; ++c) {
+    angularVelocity[c].resize(size);
+    angularAcceleration[c].resize(size);
+    position[c].resize(size);
+    linearVelocity[c].resize(size);
+    linearAcceleration[c].resize(size);
+  }
+}
+
+void PredictionEvaluator::States::set(size_t index, const oria::MotionState & state) {
+  q[0][index] = state.orientation.x;
+  q[1][index] = state.orientation.y;
+  q[2][index] = state.orientation.z;
+  q[3][index] = state.orientation.w;
+  for (int c = 0; c < 3; ++c) {
+    angularVelocity[c][index] = state.angularVelocity[c];
+    angularAcceleration[c][index] = state.angularAcceleration[c];
+    position[c][index] = state.position[c];
+    linearVelocity[c][index] = state.linearVelocity[c];
+    linearAcceleration[c][index] = state.linearAcceleration[c];
+  }
+}
+
+std::vector<float> PredictionEvaluator::getDefaultHorizons() {
+  return { 0, 10, 20, 30, 40, 50, 60, 80, 100 };
+}
+
+bool PredictionEvaluator::load(const std::string & path) {
+  recorded.clear();
+  times.clear();
+  TrackingReader reader;
+  if (!reader.open(path)) {
+    return false;
+  }
+  ovrTrackingState state;
+  while (reader.nextSample(state)) {
+    // The sampler can see the same SDK sample twice
+    const ovrPoseStatef & head = state.HeadPose;
+    if (!times.empty() && head.TimeInSeconds <= times.back()) {
+      continue;
+    }
+    recorded.push_back(head);
+    times.push_back(head.TimeInSeconds);
+  }
+  return recorded.size() > 1;
+}
+
+// Interpolates the recorded poses, walking the samples and their
+// targets forward together
+void PredictionEvaluator::computeTruth(float horizon, Truth & truth) const {
+  size_t count = recorded.size();
+  for (int c = 0; c < 4; ++c) {
+    truth.q[c].resize(count);
+  }
+  for (int c = 0; c < 3; ++c) {
+    truth.position[c].resize(count);
+  }
+
+  size_t j = 0;
+  size_t i = 0;
+  for (; i < count; ++i) {
+    double target = times[i] + horizon;
+    while (j + 1 < count && times[j + 1] <= target) {
+      ++j;
+    }
+    if (j + 1 >= count && target > times[j]) {
+      break;
+    }
+    const ovrPosef & a = recorded[j].ThePose;
+    if (j + 1 >= count) {
+      truth.q[0][i] = a.Orientation.x;
+      truth.q[1][i] = a.Orientation.y;
+      truth.q[2][i] = a.Orientation.z;
+      truth.q[3][i] = a.Orientation.w;
+      truth.position[0][i] = a.Position.x;
+      truth.position[1][i] = a.Position.y;
+      truth.position[2][i] = a.Position.z;
+      continue;
+    }
+
+    // The samples are a millisecond or so apart, close enough that a
+    // normalized lerp is as good as a slerp
+    const ovrPosef & b = recorded[j + 1].ThePose;
+    float f = (float)((target - times[j]) / (times[j + 1] - times[j]));
+    glm::quat qa = ovr::toGlm(a.Orientation);
+    glm::quat qb = ovr::toGlm(b.Orientation);
+    if (glm::dot(qa, qb) < 0) {
+      qb = -qb;
+    }
+    glm::quat q = glm::normalize(qa * (1.0f - f) + qb * f);
+    truth.q[0][i] = q.x;
+    truth.q[1][i] = q.y;
+    truth.q[2][i] = q.z;
+    truth.q[3][i] = q.w;
+    glm::vec3 p = glm::mix(ovr::toGlm(a.Position), ovr::toGlm(b.Position), f);
+    for (int c = 0; c < 3; ++c) {
+      truth.position[c][i] = p[c];
+    }
+  }
+  truth.count = i;
+}
+
+// The angle of the rotation from one orientation to the other, in
+// degrees.  Taken from the vector part of the difference rather than the
+// dot product, which can't resolve small angles in single precision.
+static float angleBetween(const glm::quat & from, const glm::quat & to) {
+  glm::quat difference = glm::conjugate(from) * to;
+  float vector = sqrtf(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+  float sinHalf = std::min(1.0f, vector / glm::length(difference));
+  return 2.0f * asinf(sinHalf) * RADIANS_TO_DEGREES;
+}
+
+#ifdef HAVE_SSE
+static inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+  return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+static inline __m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+  return madd(ax, bx, madd(ay, by, _mm_mul_ps(az, bz)));
+}
+#endif
+
+PredictionEvaluator::Result PredictionEvaluator::evaluate(const std::string & name, const States & states,
+  float horizonMs, const Truth & truth) const {
+  size_t count = truth.count;
+  float dt = horizonMs / 1000.0f;
+  float halfDt2 = 0.5f * dt * dt;
+  std::vector<float> degrees(count);
+  std::vector<float> millimeters(count);
+
+  size_t i = 0;
+#ifdef HAVE_SSE
+  // The same extrapolation as oria::extrapolate, with the sine and cosine
+  // of the half angle as Taylor series.  They're good to single precision
+  // for the half turn or so a head can make within a horizon.
+  const __m128 vdt = _mm_set1_ps(dt);
+  const __m128 vhalfDt2 = _mm_set1_ps(halfDt2);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 quarter = _mm_set1_ps(0.25f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 asinLimit = _mm_set1_ps(0.5f);
+  const __m128 toDegrees = _mm_set1_ps(2.0f * RADIANS_TO_DEGREES);
+  const __m128 toMillimeters = _mm_set1_ps(1000.0f);
+  for (; i + 4 <= count; i += 4) {
+    __m128 rx = madd(_mm_loadu_ps(&states.angularVelocity[0][i]), vdt, _mm_mul_ps(_mm_loadu_ps(&states.angularAcceleration[0][i]), vhalfDt2));
+    __m128 ry = madd(_mm_loadu_ps(&states.angularVelocity[1][i]), vdt, _mm_mul_ps(_mm_loadu_ps(&states.angularAcceleration[1][i]), vhalfDt2));
+    __m128 rz = madd(_mm_loadu_ps(&states.angularVelocity[2][i]), vdt, _mm_mul_ps(_mm_loadu_ps(&states.angularAcceleration[2][i]), vhalfDt2));
+
+    // x is the square of the half angle
+    __m128 x = _mm_mul_ps(dot3(rx, ry, rz, rx, ry, rz), quarter);
+    __m128 cosHalf = madd(x, _mm_set1_ps(1.0f / 40320.0f), _mm_set1_ps(-1.0f / 720.0f));
+    cosHalf = madd(cosHalf, x, _mm_set1_ps(1.0f / 24.0f));
+    cosHalf = madd(cosHalf, x, _mm_set1_ps(-0.5f));
+    cosHalf = madd(cosHalf, x, one);
+    __m128 sinc = madd(x, _mm_set1_ps(1.0f / 362880.0f), _mm_set1_ps(-1.0f / 5040.0f));
+    sinc = madd(sinc, x, _mm_set1_ps(1.0f / 120.0f));
+    sinc = madd(sinc, x, _mm_set1_ps(-1.0f / 6.0f));
+    sinc = madd(sinc, x, one);
+    // sin(angle / 2) / angle
+    __m128 scale = _mm_mul_ps(sinc, half);
+    __m128 dw = cosHalf;
+    __m128 dx = _mm_mul_ps(rx, scale);
+    __m128 dy = _mm_mul_ps(ry, scale);
+    __m128 dz = _mm_mul_ps(rz, scale);
+
+    // orientation * delta
+    __m128 qx = _mm_loadu_ps(&states.q[0][i]);
+    __m128 qy = _mm_loadu_ps(&states.q[1][i]);
+    __m128 qz = _mm_loadu_ps(&states.q[2][i]);
+    __m128 qw = _mm_loadu_ps(&states.q[3][i]);
+    __m128 pw = _mm_sub_ps(_mm_mul_ps(qw, dw), dot3(qx, qy, qz, dx, dy, dz));
+    __m128 px = _mm_sub_ps(madd(qw, dx, madd(qx, dw, _mm_mul_ps(qy, dz))), _mm_mul_ps(qz, dy));
+    __m128 py = _mm_sub_ps(madd(qw, dy, madd(qy, dw, _mm_mul_ps(qz, dx))), _mm_mul_ps(qx, dz));
+    __m128 pz = _mm_sub_ps(madd(qw, dz, madd(qz, dw, _mm_mul_ps(qx, dy))), _mm_mul_ps(qy, dx));
+
+    // conjugate(truth) * predicted
+    __m128 tx = _mm_loadu_ps(&truth.q[0][i]);
+    __m128 ty = _mm_loadu_ps(&truth.q[1][i]);
+    __m128 tz = _mm_loadu_ps(&truth.q[2][i]);
+    __m128 tw = _mm_loadu_ps(&truth.q[3][i]);
+    __m128 ew = madd(tw, pw, dot3(tx, ty, tz, px, py, pz));
+    __m128 ex = _mm_sub_ps(madd(tw, px, _mm_mul_ps(tz, py)), madd(tx, pw, _mm_mul_ps(ty, pz)));
+    __m128 ey = _mm_sub_ps(madd(tw, py, _mm_mul_ps(tx, pz)), madd(ty, pw, _mm_mul_ps(tz, px)));
+    __m128 ez = _mm_sub_ps(madd(tw, pz, _mm_mul_ps(ty, px)), madd(tz, pw, _mm_mul_ps(tx, py)));
+    __m128 vector2 = dot3(ex, ey, ez, ex, ey, ez);
+    __m128 s = _mm_sqrt_ps(_mm_div_ps(vector2, madd(ew, ew, vector2)));
+    s = _mm_min_ps(s, one);
+    __m128 s2 = _mm_mul_ps(s, s);
+    __m128 asin = madd(s2, _mm_set1_ps(35.0f / 1152.0f), _mm_set1_ps(5.0f / 112.0f));
+    asin = madd(asin, s2, _mm_set1_ps(3.0f / 40.0f));
+    asin = madd(asin, s2, _mm_set1_ps(1.0f / 6.0f));
+    asin = madd(asin, s2, one);
+    asin = _mm_mul_ps(asin, s);
+    _mm_storeu_ps(&degrees[i], _mm_mul_ps(asin, toDegrees));
+    // Errors over sixty degrees are rare enough to redo exactly
+    int large = _mm_movemask_ps(_mm_cmpgt_ps(s, asinLimit));
+    if (large) {
+      float sines[4];
+      _mm_storeu_ps(sines, s);
+      for (int j = 0; j < 4; ++j) {
+        if (large & (1 << j)) {
+          degrees[i + j] = 2.0f * asinf(sines[j]) * RADIANS_TO_DEGREES;
+        }
+      }
+    }
+
+    __m128 ox = _mm_sub_ps(madd(_mm_loadu_ps(&states.linearVelocity[0][i]), vdt,
+      madd(_mm_loadu_ps(&states.linearAcceleration[0][i]), vhalfDt2, _mm_loadu_ps(&states.position[0][i]))),
+      _mm_loadu_ps(&truth.position[0][i]));
+    __m128 oy = _mm_sub_ps(madd(_mm_loadu_ps(&states.linearVelocity[1][i]), vdt,
+      madd(_mm_loadu_ps(&states.linearAcceleration[1][i]), vhalfDt2, _mm_loadu_ps(&states.position[1][i]))),
+      _mm_loadu_ps(&truth.position[1][i]));
+    __m128 oz = _mm_sub_ps(madd(_mm_loadu_ps(&states.linearVelocity[2][i]), vdt,
+      madd(_mm_loadu_ps(&states.linearAcceleration[2][i]), vhalfDt2, _mm_loadu_ps(&states.position[2][i]))),
+      _mm_loadu_ps(&truth.position[2][i]));
+    _mm_storeu_ps(&millimeters[i], _mm_mul_ps(_mm_sqrt_ps(dot3(ox, oy, oz, ox, oy, oz)), toMillimeters));
+  }
+#endif
+  for (; i < count; ++i) {
+    oria::MotionState state;
+    state.orientation = glm::quat(states.q[3][i], states.q[0][i], states.q[1][i], states.q[2][i]);
+    for (int c = 0; c < 3; ++c) {
+      state.angularVelocity[c] = states.angularVelocity[c][i];
+      state.angularAcceleration[c] = states.angularAcceleration[c][i];
+      state.position[c] = states.position[c][i];
+      state.linearVelocity[c] = states.linearVelocity[c][i];
+      state.linearAcceleration[c] = states.linearAcceleration[c][i];
+    }
+    glm::quat orientation;
+    glm::vec3 position;
+    oria::extrapolate(state, dt, orientation, position);
+    glm::quat actual(truth.q[3][i], truth.q[0][i], truth.q[1][i], truth.q[2][i]);
+    degrees[i] = angleBetween(actual, orientation);
+    glm::vec3 actualPosition(truth.position[0][i], truth.position[1][i], truth.position[2][i]);
+    millimeters[i] = glm::length(position - actualPosition) * 1000.0f;
+  }
+
+  Result result;
+  result.predictor = name;
+  result.horizonMs = horizonMs;
+  result.samples = count;
+  if (!count) {
+    return result;
+  }
+  double totalDegrees = 0, totalMillimeters = 0;
+  for (size_t j = 0; j < count; ++j) {
+    totalDegrees += degrees[j];
+    totalMillimeters += millimeters[j];
+  }
+  result.meanDegrees = (float)(totalDegrees / count);
+  result.meanMillimeters = (float)(totalMillimeters / count);
+  // Each partition leaves everything above the rank above it, so the
+  // higher percentiles only need to search what's left
+  size_t start = 0;
+  float * percentiles[3] = { &result.p50Degrees, &result.p95Degrees, &result.p99Degrees };
+  const float ranks[3] = { 0.50f, 0.95f, 0.99f };
+  for (int p = 0; p < 3; ++p) {
+    size_t rank = std::min(count - 1, (size_t)(ranks[p] * count));
+    std::nth_element(degrees.begin() + start, degrees.begin() + rank, degrees.end());
+    *percentiles[p] = degrees[rank];
+    start = rank;
+  }
+  result.maxDegrees = *std::max_element(degrees.begin() + start, degrees.end());
+  return result;
+}
+
+std::vector<PredictionEvaluator::Result> PredictionEvaluator::evaluate(const std::vector<std::string> & predictors,
+  const std::vector<float> & horizonsMs) const {
+  std::vector<Truth> truths(horizonsMs.size());
+  for (size_t h = 0; h < horizonsMs.size(); ++h) {
+    computeTruth(horizonsMs[h] / 1000.0f, truths[h]);
+  }
+
+  std::vector<Result> results;
+  States states;
+  states.resize(recorded.size());
+  for (const std::string & name : predictors) {
+    std::unique_ptr<PosePredictor> predictor = PosePredictor::create(name);
+    if (!predictor) {
+      SAY_ERR("Unknown pose predictor %s", name.c_str());
+      continue;
+    }
+    // The predictors are stateful, so this part has to run in order
+    for (size_t i = 0; i < recorded.size(); ++i) {
+      predictor->addSample(recorded[i]);
+      states.set(i, predictor->getState());
+    }
+    for (size_t h = 0; h < horizonsMs.size(); ++h) {
+      results.push_back(evaluate(name, states, horizonsMs[h], truths[h]));
+    }
+  }
+  return results;
+}
+
+std::string PredictionEvaluator::toTable(const std::vector<Result> & results) {
+  std::string result = Platform::format("%-13s %8s %9s %7s %7s %7s %7s %7s %8s\n",
+    "predictor", "horizon", "samples", "mean", "p50", "p95", "p99", "max", "pos mm");
+  for (const Result & r : results) {
+    result += Platform::format("%-13s %6.0fms %9d %7.3f %7.3f %7.3f %7.3f %7.3f %8.3f\n",
+      r.predictor.c_str(), r.horizonMs, (int)r.samples, r.meanDegrees,
+      r.p50Degrees, r.p95Degrees, r.p99Degrees, r.maxDegrees, r.meanMillimeters);
+  }
+  return result;
+}
+
+std::string PredictionEvaluator::toCsv(const std::vector<Result> & results) {
+  std::string result = "predictor,horizonMs,samples,meanDegrees,p50Degrees,p95Degrees,p99Degrees,maxDegrees,meanMillimeters\n";
+  for (const Result & r : results) {
+    result += Platform::format("%s,%f,%d,%f,%f,%f,%f,%f,%f\n",
+      r.predictor.c_str(), r.horizonMs, (int)r.samples, r.meanDegrees,
+      r.p50Degrees, r.p95Degrees, r.p99Degrees, r.maxDegrees, r.meanMillimeters);
+  }
+  return result;
+}
@@ -0,0 +1,91 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Runs pose predictors over a tracking recording and measures how far
+ * their predictions land from where the head actually was, for a range
+ * of prediction horizons.  The ground truth at each horizon is
+ * interpolated from the recorded poses themselves.
+ *
+ * Every sample is held in memory, one array per component, so the
+ * extrapolation and error measurement can run four samples at a time.
+ */
+class PredictionEvaluator {
+public:
+  struct Result {
+    std::string predictor;
+    float horizonMs{ 0 };
+    size_t samples{ 0 };
+    // Angular error, in degrees
+    float meanDegrees{ 0 };
+    float p50Degrees{ 0 };
+    float p95Degrees{ 0 };
+    float p99Degrees{ 0 };
+    float maxDegrees{ 0 };
+    // Positional error, in millimeters
+    float meanMillimeters{ 0 };
+  };
+
+private:
+  std::vector<ovrPoseStatef> recorded;
+  std::vector<double> times;
+
+  // Motion states in structure of arrays form
+  struct States {
+    std::vector<float> q[4];
+    std::vector<float> angularVelocity[3];
+    std::vector<float> angularAcceleration[3];
+    std::vector<float> position[3];
+    std::vector<float> linearVelocity[3];
+    std::vector<float> linearAcceleration[3];
+
+    void resize(size_t size);
+    void set(size_t index, const oria::MotionState & state);
+  };
+
+  // The recorded pose horizon seconds after each sample, for the first
+  // count samples
+  struct Truth {
+    size_t count{ 0 };
+    std::vector<float> q[4];
+    std::vector<float> position[3];
+  };
+
+  void computeTruth(float horizon, Truth & truth) const;
+  Result evaluate(const std::string & name, const States & states, float horizonMs, const Truth & truth) const;
+
+public:
+  static std::vector<float> getDefaultHorizons();
+
+  // Loads all the head samples from a recording.  Returns false if it
+  // can't be read or holds fewer than two samples
+  bool load(const std::string & path);
+  size_t getSampleCount() const {
+    return recorded.size();
+  }
+
+  // One result per predictor and horizon, grouped by predictor
+  std::vector<Result> evaluate(const std::vector<std::string> & predictors,
+    const std::vector<float> & horizonsMs = getDefaultHorizons()) const;
+
+  static std::string toTable(const std::vector<Result> & results);
+  static std::string toCsv(const std::vector<Result> & results);
+};
@@ -72,9 +72,16 @@ void RiftApp::initGl() {
     distortionCaps |= ovrDistortionCap_LinuxDevFullscreen;
   });
   
-  int configResult = ovrHmd_ConfigureRendering(hmd, &cfg.Config,
-    distortionCaps, hmd->MaxEyeFov, eyeRenderDescs);
-  assert(configResult);
+  if (HeadlessBenchmark::get()) {
+    // Nothing is presented, so the SDK only has to describe the eyes
+    for_each_eye([&](ovrEyeType eye) {
+      eyeRenderDescs[eye] = ovrHmd_GetRenderDesc(hmd, eye, hmd->MaxEyeFov[eye]);
+    });
+  } else {
+    int configResult = ovrHmd_ConfigureRendering(hmd, &cfg.Config,
+      distortionCaps, hmd->MaxEyeFov, eyeRenderDescs);
+    assert(configResult);
+  }
 
   for_each_eye([&](ovrEyeType eye){
     const ovrEyeRenderDesc & erd = eyeRenderDescs[eye];
@@ -88,10 +95,62 @@ void RiftApp::initGl() {
   glm::uvec2 frameBufferSize = ovr::toGlm(eyeTextures[0].Header.TextureSize);
   for_each_eye([&](ovrEyeType eye) {
     eyeFramebuffers[eye] = FramebufferWrapperPtr(new FramebufferWrapper());
-    eyeFramebuffers[eye]->init(frameBufferSize);
+    eyeFramebuffers[eye]->init(frameBufferSize, true);
     ((ovrGLTexture&)(eyeTextures[eye])).OGL.TexId = 
         oglplus::GetName(eyeFramebuffers[eye]->color);
   });
+  singlePass.init(eyeTextures);
+  ovrFovPort fovs[2] = { eyeRenderDescs[0].Fov, eyeRenderDescs[1].Fov };
+  hiddenAreaMask.init(hmd, fovs, eyeTextures, distortionCaps);
+}
+
+void RiftApp::shutdownGl() {
+  hiddenAreaMask.shutdownGl();
+  singlePass.shutdownGl();
+  RiftGlfwApp::shutdownGl();
+}
+
+void RiftApp::onKey(int key, int scancode, int action, int mods) {
+  if (GLFW_PRESS == action && GLFW_KEY_F6 == key) {
+    singlePassStereo = !singlePassStereo;
+    SAY("Stereo rendering: %s", singlePassStereo ? "single pass" : "two pass");
+    return;
+  }
+  if (GLFW_PRESS == action && GLFW_KEY_F7 == key) {
+    maskHiddenArea = !maskHiddenArea;
+    if (maskHiddenArea) {
+      SAY("%s", hiddenAreaMask.getSummary().c_str());
+    } else {
+      SAY("Hidden area mask off");
+    }
+    return;
+  }
+  RiftGlfwApp::onKey(key, scancode, action, mods);
+}
+
+bool RiftApp::drawSinglePass() {
+  TRACE_SCOPE("singlePassStereo");
+  MatrixStack & mv = Stacks::modelview();
+  RenderQueue & queue = singlePass.getQueue();
+  queue.clear();
+  bool queued = false;
+  mv.withIdentity([&]{
+    queued = queueScene(queue);
+  });
+  if (!queued) {
+    return false;
+  }
+
+  glm::mat4 views[2];
+  for_each_eye([&](ovrEyeType eye) {
+    mv.withPush([&]{
+      applyEyePoseAndOffset(ovr::toGlm(eyePoses[eye]), glm::vec3(0));
+      views[eye] = mv.top();
+    });
+  });
+  ovrFovPort fovs[2] = { eyeRenderDescs[0].Fov, eyeRenderDescs[1].Fov };
+  queue.cull(ovr::getStereoFrustum(fovs, views, 0.01f, 100000.0f));
+  return singlePass.render(eyeTextures, projections, views);
 }
 
 void RiftApp::update() {
@@ -107,12 +166,42 @@ void RiftApp::applyEyePoseAndOffset(const glm::mat4 & eyePose, const glm::vec3 &
   mv.preMultiply(glm::translate(glm::mat4(), eyeOffset));
 }
 
+void RiftApp::submitFrame(const ovrTexture textures[2]) {
+  // Puts this frame's drawn and culled item counts in the trace
+  RenderQueue::endFrame();
+  HeadlessBenchmark * headless = HeadlessBenchmark::get();
+  if (!headless) {
+    ovrHmd_EndFrame(hmd, eyePoses, textures);
+    return;
+  }
+  headless->endFrame();
+  if (headless->isFinished()) {
+    headless->finish();
+    glfwSetWindowShouldClose(window, 1);
+  }
+}
+
 void RiftApp::draw() {
-  ovrHmd_BeginFrame(hmd, getFrame());
+  HeadlessBenchmark * headless = HeadlessBenchmark::get();
   MatrixStack & mv = Stacks::modelview();
   MatrixStack & pr = Stacks::projection();
-  
-  ovrHmd_GetEyePoses(hmd, getFrame(), eyeOffsets, eyePoses, nullptr);
+
+  if (headless) {
+    headless->beginFrame();
+  } else {
+    ovrHmd_BeginFrame(hmd, getFrame());
+  }
+  fetchEyePoses(getFrame(), eyeOffsets, eyePoses);
+  if (singlePassStereo) {
+    if (drawSinglePass()) {
+      submitFrame(singlePass.getEyeTextures());
+      return;
+    }
+    SAY_ERR("The scene can't be drawn in a single pass, using two passes");
+    singlePassStereo = false;
+  }
+
+  TRACE_SCOPE("twoPassStereo");
   for (int i = 0; i < 2; ++i) {
     ovrEyeType eye = currentEye = hmd->EyeRenderOrder[i];
     Stacks::withPush(pr, mv, [&]{
@@ -133,14 +222,20 @@ void RiftApp::draw() {
 
       // Render the scene to an offscreen buffer
       eyeFramebuffers[eye]->Bind();
+      if (maskHiddenArea) {
+        hiddenAreaMask.begin(eye, eyeTextures[eye].Header.RenderViewport);
+      }
       renderScene();
+      if (maskHiddenArea) {
+        hiddenAreaMask.end();
+      }
     });
   }
   // Restore the default framebuffer
   oglplus::DefaultFramebuffer().Bind(oglplus::Framebuffer::Target::Draw);
 
 #if 1
-  ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
+  submitFrame(eyeTextures);
 #else
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   static gl::GeometryPtr geometry = GlUtils::getQuadGeometry(1.0, 1.5f);
@@ -26,20 +26,40 @@ class RiftApp : public RiftGlfwApp {
 
   glm::mat4 projections[2];
   FramebufferWrapperPtr eyeFramebuffers[2];
+  SinglePassStereo singlePass;
+  HiddenAreaMask hiddenAreaMask;
+
+  bool drawSinglePass();
+  // Hands the frame to the SDK, or in a headless run records its timing
+  void submitFrame(const ovrTexture textures[2]);
 
 protected:
   glm::mat4 player;
   ovrTexture eyeTextures[2];
   ovrVector3f eyeOffsets[2];
+  // Toggled with F6.  Only takes effect if queueScene() records the scene.
+  bool singlePassStereo{ false };
+  // Toggled with F7.  Keeps the scene from being drawn to the parts of
+  // the eye buffers the distortion never shows.  Only for scenes which
+  // render the whole eye into the eye texture's RenderViewport.
+  bool maskHiddenArea{ false };
 
 protected:
   using RiftGlfwApp::renderStringAt;
   void renderStringAt(const std::string & str, float x, float y, float size = 18.0f);
   virtual void initGl();
+  virtual void shutdownGl();
   virtual void finishFrame();
   virtual void draw() final;
   virtual void update();
+  virtual void onKey(int key, int scancode, int action, int mods);
   virtual void renderScene() = 0;
+  // Override to record the scene (against an identity modelview) so it
+  // can be drawn for both eyes in a single pass.  Returns false if the
+  // scene can only be rendered per eye with renderScene().
+  virtual bool queueScene(RenderQueue & queue) {
+    return false;
+  }
 
   virtual void applyEyePoseAndOffset(const glm::mat4 & eyePose, const glm::vec3 & eyeOffset);
 
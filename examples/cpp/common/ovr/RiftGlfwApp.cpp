@@ -27,7 +27,46 @@ RiftGlfwApp::RiftGlfwApp() {
 RiftGlfwApp::~RiftGlfwApp() {
 }
 
+void RiftGlfwApp::preCreate() {
+  GlfwApp::preCreate();
+  HeadlessBenchmark * headless = HeadlessBenchmark::get();
+  if (!headless) {
+    return;
+  }
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  const std::string & contextApi = headless->getContextApi();
+  if (contextApi.empty()) {
+    return;
+  }
+#if defined(GLFW_CONTEXT_CREATION_API) && defined(GLFW_EGL_CONTEXT_API)
+  if ("egl" == contextApi) {
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    return;
+  }
+#endif
+#if defined(GLFW_CONTEXT_CREATION_API) && defined(GLFW_OSMESA_CONTEXT_API)
+  if ("osmesa" == contextApi) {
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    return;
+  }
+#endif
+  SAY_ERR("This build of GLFW can't create %s contexts, using the window system", contextApi.c_str());
+}
+
+void RiftGlfwApp::postCreate() {
+  GlfwApp::postCreate();
+  if (HeadlessBenchmark::get()) {
+    // Nothing is presented, so don't let the swap interval throttle us
+    glfwSwapInterval(0);
+  }
+}
+
 GLFWwindow * RiftGlfwApp::createRenderingTarget(glm::uvec2 & outSize, glm::ivec2 & outPosition) {
+  if (HeadlessBenchmark::get()) {
+    outSize = hmdNativeResolution;
+    outPosition = glm::ivec2(0);
+    return glfw::createWindow(outSize);
+  }
   return ovr::createRiftRenderingWindow(hmd, outSize, outPosition);
 }
 
@@ -33,6 +33,8 @@ public:
   RiftGlfwApp();
   virtual ~RiftGlfwApp();
 
+  virtual void preCreate();
+  virtual void postCreate();
   virtual GLFWwindow * createRenderingTarget(glm::uvec2 & outSize, glm::ivec2 & outPosition);
   virtual void viewport(ovrEyeType eye);
   virtual void onKey(int key, int scancode, int action, int mods);
@@ -20,7 +20,8 @@
 #include "Common.h"
 
 RiftManagerApp::RiftManagerApp(ovrHmdType defaultHmdType) {
-  hmd = ovrHmd_Create(0);
+  // Headless runs always use a simulated HMD, so they're repeatable
+  hmd = HeadlessBenchmark::get() ? nullptr : ovrHmd_Create(0);
   if (nullptr == hmd) {
     hmd = ovrHmd_CreateDebug(defaultHmdType);
     hmdDesktopPosition = glm::ivec2(100, 100);
@@ -28,9 +29,36 @@ RiftManagerApp::RiftManagerApp(ovrHmdType defaultHmdType) {
     hmdDesktopPosition = glm::ivec2(hmd->WindowsPos.x, hmd->WindowsPos.y);
   }
   hmdNativeResolution = glm::ivec2(hmd->Resolution.w, hmd->Resolution.h);
+
+  const char * replayPath = getenv("ORIA_TRACKING_REPLAY");
+  if (replayPath) {
+    trackingReplay.reset(new TrackingReplay());
+    if (!trackingReplay->open(replayPath)) {
+      FAIL("Unable to read the tracking recording %s", replayPath);
+    }
+    const char * scale = getenv("ORIA_TRACKING_REPLAY_SCALE");
+    if (scale) {
+      trackingReplay->setTimeScale((float)atof(scale));
+    }
+    SAY("Replaying tracking from %s", replayPath);
+  }
+  const char * recordPath = getenv("ORIA_TRACKING_RECORD");
+  if (recordPath) {
+    trackingRecordPath = recordPath;
+  }
+  const char * predictor = getenv("ORIA_POSE_PREDICTOR");
+  if (predictor) {
+    posePredictor = PosePredictor::create(predictor);
+    if (!posePredictor) {
+      FAIL("Unknown pose predictor %s", predictor);
+    }
+    SAY("Predicting head poses with the %s predictor", predictor);
+  }
 }
 
 RiftManagerApp::~RiftManagerApp() {
+  // The recorder polls the HMD until it's destroyed
+  trackingRecorder.reset();
   if (hmd) {
     ovrHmd_Destroy(hmd);
     hmd = nullptr;
@@ -53,6 +81,43 @@ void RiftManagerApp::toggleCaps(ovrHmdCaps cap) {
   }
 }
 
+void RiftManagerApp::fetchEyePoses(unsigned int frameIndex, const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]) {
+  HeadlessBenchmark * headless = HeadlessBenchmark::get();
+  if (trackingReplay) {
+    trackingReplay->nextFrame();
+  }
+  if (posePredictor && (trackingReplay || !headless)) {
+    ovrFrameTiming timing;
+    if (trackingReplay) {
+      posePredictor->addSample(trackingReplay->getTrackingState().HeadPose);
+      timing = trackingReplay->getFrameTiming();
+    } else {
+      posePredictor->addSample(ovrHmd_GetTrackingState(hmd, 0.0).HeadPose);
+      timing = ovrHmd_GetFrameTiming(hmd, frameIndex);
+    }
+    for_each_eye([&](ovrEyeType eye) {
+      ovrPosef head = posePredictor->predict(timing.EyeScanoutSeconds[eye]);
+      outPoses[eye].Orientation = head.Orientation;
+      outPoses[eye].Position = ovr::fromGlm(ovr::toGlm(head.Position) +
+        ovr::toGlm(head.Orientation) * ovr::toGlm(eyeOffsets[eye]));
+    });
+  } else if (trackingReplay) {
+    trackingReplay->getEyePoses(eyeOffsets, outPoses);
+  } else if (headless) {
+    headless->getEyePoses(eyeOffsets, outPoses);
+  } else {
+    ovrHmd_GetEyePoses(hmd, frameIndex, eyeOffsets, outPoses, nullptr);
+  }
+
+  // Started with the first frame, once the app has configured tracking
+  if (!trackingRecordPath.empty() && !trackingRecorder) {
+    trackingRecorder.reset(new TrackingRecorder(hmd, trackingRecordPath));
+  }
+  if (trackingRecorder) {
+    trackingRecorder->recordFrame(frameIndex, ovrHmd_GetFrameTiming(hmd, frameIndex));
+  }
+}
+
 void RiftManagerApp::disableCaps(int caps) {
   ovrHmd_SetEnabledCaps(hmd, getEnabledCaps() & ~caps);
 }
@@ -27,6 +27,21 @@ protected:
   glm::uvec2 hmdNativeResolution;
   glm::ivec2 hmdDesktopPosition;
 
+  // Set up from the environment: ORIA_TRACKING_REPLAY names a recording
+  // to take the poses from, ORIA_TRACKING_REPLAY_SCALE its time scale,
+  // and ORIA_TRACKING_RECORD a file to record the tracking to
+  std::unique_ptr<TrackingReplay> trackingReplay;
+  std::unique_ptr<TrackingRecorder> trackingRecorder;
+  std::string trackingRecordPath;
+  // ORIA_POSE_PREDICTOR picks a predictor to use in place of the SDK's
+  std::unique_ptr<PosePredictor> posePredictor;
+
+  // The eye poses for a frame, from the tracking replay, the headless
+  // run's script or the SDK, in that order.  With a pose predictor, the
+  // replayed or tracked head pose is predicted to each eye's scanout
+  // instead.  Records the frame if the tracking is being recorded.
+  void fetchEyePoses(unsigned int frameIndex, const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]);
+
 public:
   RiftManagerApp(ovrHmdType defaultHmdType = ovrHmd_DK2);
   virtual ~RiftManagerApp();
@@ -21,9 +21,18 @@ void RiftRenderingApp::initializeRiftRendering() {
     });
 
     ovrEyeRenderDesc eyeRenderDescs[2];
-    int configResult = ovrHmd_ConfigureRendering(hmd, &cfg.Config,
-      distortionCaps, hmd->MaxEyeFov, eyeRenderDescs);
-    assert(configResult);
+    if (HeadlessBenchmark::get()) {
+      // The headless run times every frame on the GPU itself
+      frameTiming.setGpuTiming(false);
+      // Nothing is presented, so the SDK only has to describe the eyes
+      for_each_eye([&](ovrEyeType eye) {
+        eyeRenderDescs[eye] = ovrHmd_GetRenderDesc(hmd, eye, hmd->MaxEyeFov[eye]);
+      });
+    } else {
+      int configResult = ovrHmd_ConfigureRendering(hmd, &cfg.Config,
+        distortionCaps, hmd->MaxEyeFov, eyeRenderDescs);
+      assert(configResult);
+    }
 
     for_each_eye([&](ovrEyeType eye){
       const ovrEyeRenderDesc & erd = eyeRenderDescs[eye];
@@ -37,10 +46,18 @@ void RiftRenderingApp::initializeRiftRendering() {
     glm::uvec2 frameBufferSize = ovr::toGlm(eyeTextures[0].Header.TextureSize);
     for_each_eye([&](ovrEyeType eye) {
       eyeFramebuffers[eye] = FramebufferWrapperPtr(new FramebufferWrapper());
-      eyeFramebuffers[eye]->init(frameBufferSize);
+      eyeFramebuffers[eye]->init(frameBufferSize, true);
       ((ovrGLTexture&)(eyeTextures[eye])).OGL.TexId =
         oglplus::GetName(eyeFramebuffers[eye]->color);
     });
+    singlePass.init(eyeTextures);
+    hiddenAreaMask.init(hmd, hmd->MaxEyeFov, eyeTextures, distortionCaps);
+
+    Platform::addShutdownHook([&] {
+      frameTiming.shutdownGl();
+      singlePass.shutdownGl();
+      hiddenAreaMask.shutdownGl();
+    });
   }
 
 RiftRenderingApp::RiftRenderingApp() {
@@ -64,60 +81,183 @@ RiftRenderingApp::RiftRenderingApp() {
 RiftRenderingApp::~RiftRenderingApp() {
 }
 
-static RateCounter rateCounter;
+void RiftRenderingApp::renderTimingOverlay() {
+  MatrixStack & mv = Stacks::modelview();
+  MatrixStack & pr = Stacks::projection();
+  Stacks::withPush(pr, mv, [&] {
+    mv.identity();
+    pr.top() = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -100.0f, 100.0f);
+    // Keep the text near the center, where it's visible through the lenses
+    glm::vec2 cursor(-0.4f, 0.4f);
+    std::string summary = frameTiming.getSummary();
+    if (maskHiddenArea) {
+      summary += Platform::format("hiddenArea      %4.1f%% %4.1f%%\n",
+        hiddenAreaMask.getHiddenFraction(ovrEye_Left) * 100.0f,
+        hiddenAreaMask.getHiddenFraction(ovrEye_Right) * 100.0f);
+    }
+    oria::renderString(summary, cursor, 8.0f);
+  });
+}
+
+void RiftRenderingApp::exportTiming(const std::string & basePath) {
+  oria::writeFile(basePath + ".csv", frameTiming.toCsv());
+  oria::writeFile(basePath + ".json", frameTiming.toJson());
+}
+
+void RiftRenderingApp::toggleHiddenAreaMask() {
+  maskHiddenArea = !maskHiddenArea;
+  if (maskHiddenArea) {
+    SAY("%s", hiddenAreaMask.getSummary().c_str());
+  } else {
+    SAY("Hidden area mask off");
+  }
+}
+
+void RiftRenderingApp::beginHiddenAreaMask(const ovrRecti & viewport) {
+  if (maskHiddenArea) {
+    hiddenAreaMask.begin(currentEye, viewport);
+  }
+}
+
+void RiftRenderingApp::endHiddenAreaMask() {
+  if (maskHiddenArea) {
+    hiddenAreaMask.end();
+  }
+}
+
+bool RiftRenderingApp::drawSinglePass(const ovrPosef fetchPoses[2]) {
+  TRACE_SCOPE("singlePassStereo");
+  MatrixStack & mv = Stacks::modelview();
+  RenderQueue & queue = singlePass.getQueue();
+  queue.clear();
+  bool queued = false;
+  mv.withIdentity([&] {
+    queued = queueScene(queue);
+  });
+  if (!queued) {
+    singlePassStereo = false;
+    return false;
+  }
+
+  glm::mat4 views[2];
+  for_each_eye([&](ovrEyeType eye) {
+    views[eye] = glm::inverse(ovr::toGlm(fetchPoses[eye])) * mv.top();
+  });
+  queue.cull(ovr::getStereoFrustum(hmd->MaxEyeFov, views, 0.01f, 100000.0f));
+  if (!singlePass.render(eyeTextures, projections, views)) {
+    SAY_ERR("The scene can't be drawn in a single pass, using two passes");
+    singlePassStereo = false;
+    return false;
+  }
+  for_each_eye([&](ovrEyeType eye) {
+    eyePoses[eye] = fetchPoses[eye];
+  });
+  return true;
+}
 
 void RiftRenderingApp::drawRiftFrame() {
+  HeadlessBenchmark * headless = HeadlessBenchmark::get();
+  if (headless && headless->isFinished()) {
+    return;
+  }
   ++frameCount;
-  ovrHmd_BeginFrame(hmd, frameCount);
+  frameTiming.beginFrame();
+  if (headless) {
+    headless->beginFrame();
+  } else {
+    ovrHmd_BeginFrame(hmd, frameCount);
+  }
   MatrixStack & mv = Stacks::modelview();
   MatrixStack & pr = Stacks::projection();
 
   perFrameRender();
   
   ovrPosef fetchPoses[2];
-  ovrHmd_GetEyePoses(hmd, frameCount, eyeOffsets, fetchPoses, nullptr);
-  for (int i = 0; i < 2; ++i) {
-    ovrEyeType eye = currentEye = hmd->EyeRenderOrder[i];
-    // Force us to alternate eyes if we aren't keeping up with the required framerate
-    if (eye == lastEyeRendered) {
-      continue;
-    }
-    // We want to ensure that we only update the pose we 
-    // send to the SDK if we actually render this eye.
-    eyePoses[eye] = fetchPoses[eye];
+  fetchEyePoses(frameCount, eyeOffsets, fetchPoses);
+  frameTiming.markPoses();
+  const ovrTexture * submitTextures = eyeTextures;
+  bool renderedEyes[2] = { false, false };
+  if (singlePassStereo && drawSinglePass(fetchPoses)) {
+    submitTextures = singlePass.getEyeTextures();
+  } else {
+    for (int i = 0; i < 2; ++i) {
+      ovrEyeType eye = currentEye = hmd->EyeRenderOrder[i];
+      // Force us to alternate eyes if we aren't keeping up with the required framerate
+      if (eye == lastEyeRendered) {
+        continue;
+      }
+      // We want to ensure that we only update the pose we 
+      // send to the SDK if we actually render this eye.
+      eyePoses[eye] = fetchPoses[eye];
 
-    lastEyeRendered = eye;
-    Stacks::withPush(pr, mv, [&] {
-      // Set up the per-eye projection matrix
-      pr.top() = projections[eye];
+      lastEyeRendered = eye;
+      Stacks::withPush(pr, mv, [&] {
+        // Set up the per-eye projection matrix
+        pr.top() = projections[eye];
 
-      // Set up the per-eye modelview matrix
-      // Apply the head pose
-      glm::mat4 eyePose = ovr::toGlm(eyePoses[eye]);
-      mv.preMultiply(glm::inverse(eyePose));
+        // Set up the per-eye modelview matrix
+        // Apply the head pose
+        glm::mat4 eyePose = ovr::toGlm(eyePoses[eye]);
+        mv.preMultiply(glm::inverse(eyePose));
 
-      // Render the scene to an offscreen buffer
-      eyeFramebuffers[eye]->Bind();
-      perEyeRender();
-    });
+        // Render the scene to an offscreen buffer
+        TRACE_SCOPE(0 == eye ? "leftEye" : "rightEye");
+        frameTiming.beginEye(eye);
+        eyeFramebuffers[eye]->Bind();
+        beginHiddenAreaMask(eyeTextures[eye].Header.RenderViewport);
+        perEyeRender();
+        endHiddenAreaMask();
+        frameTiming.endEye(eye);
+        renderedEyes[eye] = true;
+      });
     
-    if (eyePerFrameMode) {
-      break;
+      if (eyePerFrameMode) {
+        break;
+      }
     }
   }
 
-  if (endFrameLock) {
-    endFrameLock->lock();
+  frameTiming.endRendering();
+  RenderQueue::Stats queued = RenderQueue::endFrame();
+  // Scenes drawn without a render queue have nothing to report
+  if (queued.draws || queued.culled) {
+    frameTiming.recordCulling(queued.draws, queued.culled);
   }
-  ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
-  if (endFrameLock) {
-    endFrameLock->unlock();
+  // Drawn after the timers stop, so the overlay's own text doesn't show
+  // up in the times it reports
+  if (showTimingOverlay) {
+    for_each_eye([&](ovrEyeType eye) {
+      if (renderedEyes[eye]) {
+        eyeFramebuffers[eye]->Bind();
+        renderTimingOverlay();
+      }
+    });
+  }
+  if (headless) {
+    headless->endFrame();
+    frameTiming.endFrame();
+    if (headless->isFinished()) {
+      headless->finish();
+      headlessFinished();
+    }
+    return;
   }
-  rateCounter.increment();
-  if (rateCounter.elapsed() > 2.0f) {
-    float fps = rateCounter.getRate();
-    updateFps(fps);
-    rateCounter.reset();
+  {
+    TRACE_SCOPE("endFrame");
+    if (endFrameLock) {
+      endFrameLock->lock();
+    }
+    ovrHmd_EndFrame(hmd, eyePoses, submitTextures);
+    if (endFrameLock) {
+      endFrameLock->unlock();
+    }
+  }
+  frameTiming.endFrame();
+
+  double now = Platform::elapsedSeconds();
+  if (now - lastFpsUpdate > 2.0f) {
+    updateFps(frameTiming.getFps());
+    lastFpsUpdate = now;
   }
 }
 
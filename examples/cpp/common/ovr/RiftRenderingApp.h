@@ -22,7 +22,10 @@
 class RiftRenderingApp : public RiftManagerApp {
   ovrEyeType currentEye{ovrEye_Count};
   FramebufferWrapperPtr eyeFramebuffers[2];
+  SinglePassStereo singlePass;
+  HiddenAreaMask hiddenAreaMask;
   unsigned int frameCount{ 0 };
+  double lastFpsUpdate{ 0 };
 
 protected:
   ovrPosef eyePoses[2];
@@ -31,10 +34,20 @@ protected:
   glm::mat4 projections[2];
 
   bool eyePerFrameMode{ false };
+  // Only takes effect if queueScene() records the scene
+  bool singlePassStereo{ false };
+  // Keeps the per-eye passes from drawing to the parts of the eye buffers
+  // the distortion never shows.  Only for scenes which render the whole
+  // eye into the eye texture's RenderViewport.
+  bool maskHiddenArea{ false };
   ovrEyeType lastEyeRendered{ ovrEye_Count };
 
   std::mutex * endFrameLock{ nullptr };
 
+  // Only touch these from the rendering thread
+  FrameTiming frameTiming;
+  bool showTimingOverlay{ false };
+
 private:
   virtual void * getNativeWindow() = 0;
 
@@ -49,10 +62,35 @@ protected:
   }
 
   virtual void updateFps(float fps) { }
+  // Called on the rendering thread once a headless run has rendered all
+  // its frames and written the results
+  virtual void headlessFinished() { }
+  virtual void renderTimingOverlay();
+  // Writes the current timing statistics as <basePath>.csv and <basePath>.json
+  void exportTiming(const std::string & basePath);
+  // Flips maskHiddenArea and reports how much of each eye it saves
+  void toggleHiddenAreaMask();
+  // Masks the current eye in the bound framebuffer, for a pass that
+  // renders the whole eye into the given viewport, such as an offscreen
+  // pass which is then stretched over the eye texture.  These do nothing
+  // while maskHiddenArea is off.
+  void beginHiddenAreaMask(const ovrRecti & viewport);
+  void endHiddenAreaMask();
   virtual void initializeRiftRendering();
   virtual void drawRiftFrame() final;
   virtual void perFrameRender() {};
   virtual void perEyeRender() {};
+  // Override to record the scene (against an identity modelview) so it
+  // can be drawn for both eyes in a single pass.  Returns false if the
+  // scene can only be rendered per eye with perEyeRender().
+  virtual bool queueScene(RenderQueue & queue) {
+    return false;
+  }
+
+private:
+  bool drawSinglePass(const ovrPosef fetchPoses[2]);
+
+protected:
 
 public:
   RiftRenderingApp();
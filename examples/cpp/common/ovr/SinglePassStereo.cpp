@@ -0,0 +1,68 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#include "Common.h"
+#include <OVR_CAPI_GL.h>
+
+SinglePassStereo::SinglePassStereo() {
+  memset(eyeTextures, 0, 2 * sizeof(ovrGLTexture));
+}
+
+void SinglePassStereo::init(const ovrTexture sourceTextures[2]) {
+  glm::uvec2 size(0);
+  for_each_eye([&](ovrEyeType eye) {
+    const ovrSizei & eyeSize = sourceTextures[eye].Header.TextureSize;
+    size.x += eyeSize.w;
+    size.y = std::max(size.y, (unsigned int)eyeSize.h);
+  });
+
+  framebuffer = FramebufferWrapperPtr(new FramebufferWrapper());
+  framebuffer->init(size);
+  for_each_eye([&](ovrEyeType eye) {
+    ovrTextureHeader & header = eyeTextures[eye].Header;
+    header.API = ovrRenderAPI_OpenGL;
+    header.TextureSize = ovr::fromGlm(size);
+    ((ovrGLTexture&)(eyeTextures[eye])).OGL.TexId =
+      oglplus::GetName(framebuffer->color);
+  });
+}
+
+void SinglePassStereo::shutdownGl() {
+  queue.shutdownGl();
+  framebuffer.reset();
+}
+
+bool SinglePassStereo::render(const ovrTexture sourceTextures[2], const glm::mat4 projections[2], const glm::mat4 views[2]) {
+  // Both halves must be the same size, since the stereo shaders split
+  // the viewport down the middle
+  ovrSizei eyeSize = sourceTextures[0].Header.RenderViewport.Size;
+  for_each_eye([&](ovrEyeType eye) {
+    ovrRecti & viewport = eyeTextures[eye].Header.RenderViewport;
+    viewport.Pos.x = eye * eyeSize.w;
+    viewport.Pos.y = 0;
+    viewport.Size = eyeSize;
+  });
+
+  framebuffer->Bind();
+  oglplus::Context::Viewport(0, 0, eyeSize.w * 2, eyeSize.h);
+  oglplus::Context::Clear().ColorBuffer().DepthBuffer();
+  bool result = queue.executeStereo(projections, views);
+  oglplus::DefaultFramebuffer().Bind(oglplus::Framebuffer::Target::Draw);
+  return result;
+}
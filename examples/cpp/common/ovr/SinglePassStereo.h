@@ -0,0 +1,59 @@
+/************************************************************************************
+
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Renders a recorded scene for both eyes in one pass, into a single side
+ * by side target shared by the two eye textures handed to the SDK.
+ *
+ * The apps keep their usual per-eye path and only use this when the scene
+ * can be recorded into a RenderQueue, so the two can be compared at
+ * runtime.
+ */
+class SinglePassStereo {
+  FramebufferWrapperPtr framebuffer;
+  ovrTexture eyeTextures[2];
+  RenderQueue queue;
+
+public:
+  SinglePassStereo();
+
+  // Allocates a target wide enough to hold both of the eye textures
+  void init(const ovrTexture sourceTextures[2]);
+  void shutdownGl();
+
+  bool isInitialized() const {
+    return (bool)framebuffer;
+  }
+
+  RenderQueue & getQueue() {
+    return queue;
+  }
+
+  // Draws the queue for both eyes, with each eye's viewport the same size
+  // as the render viewport of the matching source texture.  Returns false
+  // if the queue can't be drawn in a single pass.
+  bool render(const ovrTexture sourceTextures[2], const glm::mat4 projections[2], const glm::mat4 views[2]);
+
+  // The textures to pass to ovrHmd_EndFrame after render()
+  const ovrTexture * getEyeTextures() const {
+    return eyeTextures;
+  }
+};
@@ -0,0 +1,518 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+static const char RECORDING_MAGIC[4] = { 'O', 'R', 'T', 'R' };
+static const uint8_t RECORDING_VERSION = 1;
+static const char SAMPLE_RECORD = 'S';
+static const char FRAME_RECORD = 'F';
+
+// The tracking values are split into groups which tend to change
+// together, each quantized to its own resolution.  Every sample carries a
+// byte with a bit per group that changed.
+static const int GROUP_COUNT = 8;
+static const int GROUP_START[GROUP_COUNT + 1] = { 0, 7, 13, 19, 26, 33, 42, 43, 44 };
+static const float GROUP_SCALE[GROUP_COUNT] = {
+  1e6f, // head pose
+  1e5f, // head velocities
+  1e4f, // head accelerations
+  1e6f, // camera pose
+  1e6f, // leveled camera pose
+  1e4f, // raw accelerometer, gyro and magnetometer
+  1e2f, // raw temperature
+  1e6f, // raw sample time, relative to the head pose
+};
+
+static void putPose(float * & f, const ovrPosef & pose) {
+  *f++ = pose.Orientation.x;
+  *f++ = pose.Orientation.y;
+  *f++ = pose.Orientation.z;
+  *f++ = pose.Orientation.w;
+  *f++ = pose.Position.x;
+  *f++ = pose.Position.y;
+  *f++ = pose.Position.z;
+}
+
+static void putVector(float * & f, const ovrVector3f & v) {
+  *f++ = v.x;
+  *f++ = v.y;
+  *f++ = v.z;
+}
+
+static void getPose(const float * & f, ovrPosef & pose) {
+  pose.Orientation.x = *f++;
+  pose.Orientation.y = *f++;
+  pose.Orientation.z = *f++;
+  pose.Orientation.w = *f++;
+  pose.Position.x = *f++;
+  pose.Position.y = *f++;
+  pose.Position.z = *f++;
+}
+
+static void getVector(const float * & f, ovrVector3f & v) {
+  v.x = *f++;
+  v.y = *f++;
+  v.z = *f++;
+}
+
+static void toFields(const ovrTrackingState & state, float * fields) {
+  float * f = fields;
+  putPose(f, state.HeadPose.ThePose);
+  putVector(f, state.HeadPose.AngularVelocity);
+  putVector(f, state.HeadPose.LinearVelocity);
+  putVector(f, state.HeadPose.AngularAcceleration);
+  putVector(f, state.HeadPose.LinearAcceleration);
+  putPose(f, state.CameraPose);
+  putPose(f, state.LeveledCameraPose);
+  putVector(f, state.RawSensorData.Accelerometer);
+  putVector(f, state.RawSensorData.Gyro);
+  putVector(f, state.RawSensorData.Magnetometer);
+  *f++ = state.RawSensorData.Temperature;
+  *f++ = (float)(state.RawSensorData.TimeInSeconds - state.HeadPose.TimeInSeconds);
+  assert(f - fields == oria::TrackingCodec::FIELD_COUNT);
+}
+
+static void fromFields(const float * fields, ovrTrackingState & state) {
+  const float * f = fields;
+  getPose(f, state.HeadPose.ThePose);
+  getVector(f, state.HeadPose.AngularVelocity);
+  getVector(f, state.HeadPose.LinearVelocity);
+  getVector(f, state.HeadPose.AngularAcceleration);
+  getVector(f, state.HeadPose.LinearAcceleration);
+  getPose(f, state.CameraPose);
+  getPose(f, state.LeveledCameraPose);
+  getVector(f, state.RawSensorData.Accelerometer);
+  getVector(f, state.RawSensorData.Gyro);
+  getVector(f, state.RawSensorData.Magnetometer);
+  state.RawSensorData.Temperature = *f++;
+  state.RawSensorData.TimeInSeconds = (float)(state.HeadPose.TimeInSeconds + *f++);
+}
+
+static int64_t toMicros(double seconds) {
+  return (int64_t)floor(seconds * 1e6 + 0.5);
+}
+
+static double fromMicros(int64_t micros) {
+  return (double)micros / 1e6;
+}
+
+static int32_t quantize(float value, float scale) {
+  double scaled = floor((double)value * scale + 0.5);
+  scaled = std::max(scaled, (double)std::numeric_limits<int32_t>::min());
+  scaled = std::min(scaled, (double)std::numeric_limits<int32_t>::max());
+  return (int32_t)scaled;
+}
+
+static void writeVarint(std::string & out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back((char)((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back((char)value);
+}
+
+static void writeSigned(std::string & out, int64_t value) {
+  writeVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static bool readVarint(std::istream & in, uint64_t & value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = in.get();
+    if (c == EOF) {
+      return false;
+    }
+    value |= (uint64_t)(c & 0x7F) << shift;
+    if (!(c & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool readSigned(std::istream & in, int64_t & value) {
+  uint64_t encoded;
+  if (!readVarint(in, encoded)) {
+    return false;
+  }
+  value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+  return true;
+}
+
+namespace oria {
+
+  TrackingCodec::TrackingCodec() {
+    reset();
+  }
+
+  void TrackingCodec::reset() {
+    lastMicros = 0;
+    lastFrame = 0;
+    memset(lastFields, 0, sizeof(lastFields));
+  }
+
+}
+
+static void encodeSample(oria::TrackingCodec & codec, const ovrTrackingState & state, std::string & out) {
+  float fields[oria::TrackingCodec::FIELD_COUNT];
+  int32_t quantized[oria::TrackingCodec::FIELD_COUNT];
+  toFields(state, fields);
+  uint8_t changed = 0;
+  for (int g = 0; g < GROUP_COUNT; ++g) {
+    for (int i = GROUP_START[g]; i < GROUP_START[g + 1]; ++i) {
+      quantized[i] = quantize(fields[i], GROUP_SCALE[g]);
+      if (quantized[i] != codec.lastFields[i]) {
+        changed |= 1 << g;
+      }
+    }
+  }
+
+  int64_t micros = toMicros(state.HeadPose.TimeInSeconds);
+  out.push_back(SAMPLE_RECORD);
+  writeSigned(out, micros - codec.lastMicros);
+  writeVarint(out, state.StatusFlags);
+  out.push_back((char)changed);
+  for (int g = 0; g < GROUP_COUNT; ++g) {
+    if (!(changed & (1 << g))) {
+      continue;
+    }
+    for (int i = GROUP_START[g]; i < GROUP_START[g + 1]; ++i) {
+      writeSigned(out, (int64_t)quantized[i] - codec.lastFields[i]);
+      codec.lastFields[i] = quantized[i];
+    }
+  }
+  codec.lastMicros = micros;
+}
+
+static void encodeFrame(oria::TrackingCodec & codec, unsigned int frameIndex, const ovrFrameTiming & timing, std::string & out) {
+  int64_t micros = toMicros(timing.ThisFrameSeconds);
+  out.push_back(FRAME_RECORD);
+  writeSigned(out, (int64_t)frameIndex - codec.lastFrame);
+  writeSigned(out, micros - codec.lastMicros);
+  writeSigned(out, toMicros(timing.TimewarpPointSeconds) - micros);
+  writeSigned(out, toMicros(timing.NextFrameSeconds) - micros);
+  writeSigned(out, toMicros(timing.ScanoutMidpointSeconds) - micros);
+  writeSigned(out, toMicros(timing.EyeScanoutSeconds[0]) - micros);
+  writeSigned(out, toMicros(timing.EyeScanoutSeconds[1]) - micros);
+  writeSigned(out, toMicros(timing.DeltaSeconds));
+  codec.lastFrame = frameIndex;
+  codec.lastMicros = micros;
+}
+
+TrackingRecorder::TrackingRecorder(ovrHmd hmd, const std::string & path) : hmd(hmd) {
+  out.open(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) {
+    FAIL("Unable to create the tracking recording %s", path.c_str());
+  }
+  out.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+  out.put((char)RECORDING_VERSION);
+  running = true;
+  sampler = std::thread([&] {
+    sampleLoop();
+  });
+  SAY("Recording tracking to %s", path.c_str());
+}
+
+TrackingRecorder::~TrackingRecorder() {
+  running = false;
+  if (sampler.joinable()) {
+    sampler.join();
+  }
+  std::streamoff bytes = out.tellp();
+  out.close();
+  SAY("Recorded %lu tracking samples and %lu frames in %ld bytes",
+    (unsigned long)samples, (unsigned long)frames, (long)bytes);
+}
+
+void TrackingRecorder::sampleLoop() {
+  Platform::setThreadPriority(Platform::HIGH);
+  double lastSampleTime = -1;
+  std::string record;
+  while (running) {
+    ovrTrackingState state = ovrHmd_GetTrackingState(hmd, 0.0);
+    // Polling faster than the sensor updates, so skip the repeats
+    if (state.HeadPose.TimeInSeconds != lastSampleTime) {
+      lastSampleTime = state.HeadPose.TimeInSeconds;
+      record.clear();
+      std::unique_lock<std::mutex> lock(mutex);
+      encodeSample(codec, state, record);
+      out.write(record.data(), record.size());
+      ++samples;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(250));
+  }
+}
+
+void TrackingRecorder::recordFrame(unsigned int frameIndex, const ovrFrameTiming & timing) {
+  std::string record;
+  std::unique_lock<std::mutex> lock(mutex);
+  encodeFrame(codec, frameIndex, timing, record);
+  out.write(record.data(), record.size());
+  ++frames;
+}
+
+bool TrackingReader::readSample(ovrTrackingState & state) {
+  int64_t micros;
+  uint64_t flags;
+  if (!readSigned(in, micros) || !readVarint(in, flags)) {
+    return false;
+  }
+  int changed = in.get();
+  if (changed == EOF) {
+    return false;
+  }
+  float fields[oria::TrackingCodec::FIELD_COUNT];
+  for (int g = 0; g < GROUP_COUNT; ++g) {
+    for (int i = GROUP_START[g]; i < GROUP_START[g + 1]; ++i) {
+      if (changed & (1 << g)) {
+        int64_t delta;
+        if (!readSigned(in, delta)) {
+          return false;
+        }
+        codec.lastFields[i] = (int32_t)(codec.lastFields[i] + delta);
+      }
+      fields[i] = (float)codec.lastFields[i] / GROUP_SCALE[g];
+    }
+  }
+  codec.lastMicros += micros;
+
+  memset(&state, 0, sizeof(state));
+  state.HeadPose.TimeInSeconds = fromMicros(codec.lastMicros);
+  state.StatusFlags = (unsigned int)flags;
+  fromFields(fields, state);
+  return true;
+}
+
+bool TrackingReader::readFrame(unsigned int & frameIndex, ovrFrameTiming & timing) {
+  int64_t values[8];
+  for (int i = 0; i < 8; ++i) {
+    if (!readSigned(in, values[i])) {
+      return false;
+    }
+  }
+  codec.lastFrame += values[0];
+  codec.lastMicros += values[1];
+  int64_t micros = codec.lastMicros;
+
+  memset(&timing, 0, sizeof(timing));
+  frameIndex = (unsigned int)codec.lastFrame;
+  timing.ThisFrameSeconds = fromMicros(micros);
+  timing.TimewarpPointSeconds = fromMicros(micros + values[2]);
+  timing.NextFrameSeconds = fromMicros(micros + values[3]);
+  timing.ScanoutMidpointSeconds = fromMicros(micros + values[4]);
+  timing.EyeScanoutSeconds[0] = fromMicros(micros + values[5]);
+  timing.EyeScanoutSeconds[1] = fromMicros(micros + values[6]);
+  timing.DeltaSeconds = (float)fromMicros(values[7]);
+  return true;
+}
+
+char TrackingReader::next(ovrTrackingState & state, unsigned int & frameIndex, ovrFrameTiming & timing) {
+  int type = in.get();
+  if (SAMPLE_RECORD == type && readSample(state)) {
+    return SAMPLE_RECORD;
+  }
+  if (FRAME_RECORD == type && readFrame(frameIndex, timing)) {
+    return FRAME_RECORD;
+  }
+  return 0;
+}
+
+bool TrackingReader::open(const std::string & path) {
+  in.open(path.c_str(), std::ios::binary);
+  char magic[sizeof(RECORDING_MAGIC)];
+  if (!in.read(magic, sizeof(magic)) || memcmp(magic, RECORDING_MAGIC, sizeof(magic))) {
+    return false;
+  }
+  return RECORDING_VERSION == in.get();
+}
+
+bool TrackingReader::nextSample(ovrTrackingState & state) {
+  unsigned int frameIndex;
+  ovrFrameTiming timing;
+  for (;;) {
+    char type = next(state, frameIndex, timing);
+    if (SAMPLE_RECORD == type) {
+      return true;
+    }
+    if (!type) {
+      return false;
+    }
+  }
+}
+
+bool TrackingReader::nextFrame(unsigned int & frameIndex, ovrFrameTiming & timing) {
+  ovrTrackingState state;
+  for (;;) {
+    char type = next(state, frameIndex, timing);
+    if (FRAME_RECORD == type) {
+      return true;
+    }
+    if (!type) {
+      return false;
+    }
+  }
+}
+
+TrackingReplay::TrackingReplay() {
+  memset(&recordedFrame, 0, sizeof(recordedFrame));
+  memset(&followingFrame, 0, sizeof(followingFrame));
+  memset(&frameTiming, 0, sizeof(frameTiming));
+  memset(&trackingState, 0, sizeof(trackingState));
+}
+
+TrackingReplay::~TrackingReplay() {
+}
+
+bool TrackingReplay::open(const std::string & path) {
+  this->path = path;
+  // Playback loops on the sample timeline, so find where it ends
+  TrackingReader reader;
+  ovrTrackingState state;
+  bool hasSamples = false;
+  if (!reader.open(path)) {
+    return false;
+  }
+  while (reader.nextSample(state)) {
+    lastSampleSeconds = state.HeadPose.TimeInSeconds;
+    hasSamples = true;
+  }
+  if (!hasSamples || !rewind()) {
+    return false;
+  }
+  // The first call to nextFrame() starts the clock
+  playbackSeconds = -1;
+  return true;
+}
+
+bool TrackingReplay::rewind() {
+  frameReader.reset(new TrackingReader());
+  sampleReader.reset(new TrackingReader());
+  samples.clear();
+  samplesExhausted = false;
+  unsigned int frameIndex;
+  if (!frameReader->open(path) || !sampleReader->open(path) ||
+      !frameReader->nextFrame(frameIndex, recordedFrame)) {
+    return false;
+  }
+  hasFollowingFrame = frameReader->nextFrame(frameIndex, followingFrame);
+  playbackSeconds = recordedFrame.ThisFrameSeconds;
+  return true;
+}
+
+void TrackingReplay::updateFrameTiming() {
+  const ovrFrameTiming & recorded = recordedFrame;
+  double start = recorded.ThisFrameSeconds;
+  auto place = [&](double seconds) {
+    return playbackSeconds + (seconds - start) * timeScale;
+  };
+  frameTiming = recorded;
+  frameTiming.ThisFrameSeconds = playbackSeconds;
+  frameTiming.TimewarpPointSeconds = place(recorded.TimewarpPointSeconds);
+  frameTiming.NextFrameSeconds = place(recorded.NextFrameSeconds);
+  frameTiming.ScanoutMidpointSeconds = place(recorded.ScanoutMidpointSeconds);
+  frameTiming.EyeScanoutSeconds[0] = place(recorded.EyeScanoutSeconds[0]);
+  frameTiming.EyeScanoutSeconds[1] = place(recorded.EyeScanoutSeconds[1]);
+  frameTiming.DeltaSeconds = (float)(recorded.DeltaSeconds * timeScale);
+}
+
+void TrackingReplay::readSamplesUntil(double seconds) {
+  while (!samplesExhausted && (samples.empty() || samples.back().HeadPose.TimeInSeconds <= seconds)) {
+    ovrTrackingState state;
+    if (sampleReader->nextSample(state)) {
+      samples.push_back(state);
+    } else {
+      samplesExhausted = true;
+    }
+  }
+}
+
+void TrackingReplay::nextFrame() {
+  // The recorded times are whole microseconds
+  static const double HALF_MICROSECOND = 0.5e-6;
+  if (playbackSeconds < 0) {
+    playbackSeconds = recordedFrame.ThisFrameSeconds;
+  } else {
+    double interval = hasFollowingFrame
+      ? followingFrame.ThisFrameSeconds - recordedFrame.ThisFrameSeconds
+      : recordedFrame.NextFrameSeconds - recordedFrame.ThisFrameSeconds;
+    playbackSeconds += std::max(interval, 0.0) * timeScale;
+    while (hasFollowingFrame && followingFrame.ThisFrameSeconds <= playbackSeconds + HALF_MICROSECOND) {
+      unsigned int frameIndex;
+      recordedFrame = followingFrame;
+      hasFollowingFrame = frameReader->nextFrame(frameIndex, followingFrame);
+    }
+  }
+  updateFrameTiming();
+
+  double latest = std::max(frameTiming.EyeScanoutSeconds[0], frameTiming.EyeScanoutSeconds[1]);
+  if (latest > lastSampleSeconds) {
+    SAY("Tracking replay reached the end of %s, starting over", path.c_str());
+    if (!rewind()) {
+      FAIL("Unable to restart the tracking replay %s", path.c_str());
+    }
+    updateFrameTiming();
+  }
+
+  // Later frames never need anything before the last sample at the
+  // start of this one
+  double now = frameTiming.ThisFrameSeconds;
+  readSamplesUntil(now);
+  while (samples.size() > 1 && samples[1].HeadPose.TimeInSeconds <= now) {
+    samples.pop_front();
+  }
+  if (!samples.empty()) {
+    trackingState = samples.front();
+  }
+}
+
+void TrackingReplay::getHeadPose(double seconds, ovrPosef & outPose) {
+  readSamplesUntil(seconds);
+  if (samples.empty()) {
+    memset(&outPose, 0, sizeof(outPose));
+    outPose.Orientation.w = 1;
+    return;
+  }
+  size_t next = 0;
+  while (next < samples.size() && samples[next].HeadPose.TimeInSeconds <= seconds) {
+    ++next;
+  }
+  if (0 == next || samples.size() == next) {
+    outPose = samples[0 == next ? 0 : next - 1].HeadPose.ThePose;
+    return;
+  }
+  const ovrPoseStatef & a = samples[next - 1].HeadPose;
+  const ovrPoseStatef & b = samples[next].HeadPose;
+  float t = (float)((seconds - a.TimeInSeconds) / (b.TimeInSeconds - a.TimeInSeconds));
+  outPose.Orientation = ovr::fromGlm(glm::slerp(
+    ovr::toGlm(a.ThePose.Orientation), ovr::toGlm(b.ThePose.Orientation), t));
+  outPose.Position = ovr::fromGlm(glm::mix(
+    ovr::toGlm(a.ThePose.Position), ovr::toGlm(b.ThePose.Position), t));
+}
+
+void TrackingReplay::getEyePoses(const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]) {
+  for_each_eye([&](ovrEyeType eye) {
+    ovrPosef head;
+    getHeadPose(frameTiming.EyeScanoutSeconds[eye], head);
+    glm::quat orientation = ovr::toGlm(head.Orientation);
+    outPoses[eye].Orientation = head.Orientation;
+    outPoses[eye].Position = ovr::fromGlm(ovr::toGlm(head.Position) +
+      orientation * ovr::toGlm(eyeOffsets[eye]));
+  });
+}
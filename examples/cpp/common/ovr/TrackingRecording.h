@@ -0,0 +1,159 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Recordings of the tracking state and frame timing, so the same head
+ * motion can be fed to the render loop on every run.
+ *
+ * A recording is a header followed by a stream of records, written in
+ * time order, so it can be read while it's written and a recording cut
+ * short is still readable up to its last complete record.  Each record
+ * holds the difference from the one before it: times in microseconds,
+ * the tracking values quantized to a fixed resolution per kind of value,
+ * all as zig-zag varints.  Groups of values which haven't changed, like
+ * the camera pose, cost a bit each.
+ */
+namespace oria {
+  // The decoded state of a recording, shared by the writer and readers
+  struct TrackingCodec {
+    static const int FIELD_COUNT = 44;
+
+    int64_t lastMicros{ 0 };
+    int64_t lastFrame{ 0 };
+    int32_t lastFields[FIELD_COUNT];
+
+    TrackingCodec();
+    void reset();
+  };
+}
+
+/**
+ * Records the tracking state at the rate the sensor updates it, from a
+ * thread of its own polling ovrHmd_GetTrackingState, along with the
+ * timing of each rendered frame.
+ */
+class TrackingRecorder {
+  ovrHmd hmd;
+  std::ofstream out;
+  std::mutex mutex;
+  std::thread sampler;
+  std::atomic<bool> running{ false };
+  oria::TrackingCodec codec;
+  size_t samples{ 0 };
+  size_t frames{ 0 };
+
+  void sampleLoop();
+
+public:
+  TrackingRecorder(ovrHmd hmd, const std::string & path);
+  ~TrackingRecorder();
+
+  // Call once per frame, from the rendering thread
+  void recordFrame(unsigned int frameIndex, const ovrFrameTiming & timing);
+};
+
+/**
+ * Reads a recording from the start, one record at a time
+ */
+class TrackingReader {
+  std::ifstream in;
+  oria::TrackingCodec codec;
+
+  bool readSample(ovrTrackingState & state);
+  bool readFrame(unsigned int & frameIndex, ovrFrameTiming & timing);
+  // Reads the next record, returning its type, or 0 at the end of the
+  // recording or a truncated record
+  char next(ovrTrackingState & state, unsigned int & frameIndex, ovrFrameTiming & timing);
+
+public:
+  // Returns false if the file isn't a recording
+  bool open(const std::string & path);
+  // Skip to the next record of the given kind, returning false at the end
+  bool nextSample(ovrTrackingState & state);
+  bool nextFrame(unsigned int & frameIndex, ovrFrameTiming & timing);
+};
+
+/**
+ * Plays a recording back at a fixed rate, so each frame gets the same
+ * poses on every run however long it takes to render.  The eye poses are
+ * interpolated from the recorded head poses at each eye's scanout time.
+ *
+ * Playback follows a clock on the recording's timeline, which moves on by
+ * the spacing of the recorded frames, times the time scale, with every
+ * rendered frame: 1 gives each rendered frame the next recorded frame, 0.5
+ * plays the motion at half speed, 2 at twice the speed.  Every time the
+ * replay reports is on that clock, with the recorded gaps between a frame
+ * starting and its scanout stretched by the same scale.  The recording
+ * loops once a frame would need head poses past its last sample.
+ */
+class TrackingReplay {
+  std::string path;
+  std::unique_ptr<TrackingReader> frameReader;
+  std::unique_ptr<TrackingReader> sampleReader;
+  float timeScale{ 1.0f };
+  double lastSampleSeconds{ 0 };
+  // The playback clock, and the recorded frames either side of it
+  double playbackSeconds{ -1 };
+  ovrFrameTiming recordedFrame;
+  ovrFrameTiming followingFrame;
+  bool hasFollowingFrame{ false };
+  ovrFrameTiming frameTiming;
+  ovrTrackingState trackingState;
+  // The samples around the times the current frame needs
+  std::deque<ovrTrackingState> samples;
+  bool samplesExhausted{ false };
+
+  bool rewind();
+  // Places the recorded frame's timing at the playback clock
+  void updateFrameTiming();
+  void readSamplesUntil(double seconds);
+  // The recorded head pose at a time on the recording's clock
+  void getHeadPose(double seconds, ovrPosef & outPose);
+
+public:
+  TrackingReplay();
+  ~TrackingReplay();
+
+  // Returns false if the file isn't a recording or holds no frames or
+  // samples
+  bool open(const std::string & path);
+
+  void setTimeScale(float scale) {
+    timeScale = scale;
+  }
+
+  // Moves the playback clock on by one frame
+  void nextFrame();
+
+  // The eye poses for the current frame, in the form ovrHmd_GetEyePoses
+  // returns them
+  void getEyePoses(const ovrVector3f eyeOffsets[2], ovrPosef outPoses[2]);
+
+  // The timing of the current frame, on the recording's clock
+  const ovrFrameTiming & getFrameTiming() const {
+    return frameTiming;
+  }
+
+  // The last recorded tracking state before the current frame began
+  const ovrTrackingState & getTrackingState() const {
+    return trackingState;
+  }
+};
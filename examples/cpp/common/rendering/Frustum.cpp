@@ -0,0 +1,100 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+Frustum::Frustum() {
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    planes[i] = glm::vec4(0, 0, 0, 1);
+  }
+}
+
+// Gribb & Hartmann: each plane is the last row of the matrix plus or minus
+// one of the others
+Frustum::Frustum(const glm::mat4 & clipFromWorld) {
+  glm::mat4 rows = glm::transpose(clipFromWorld);
+  planes[0] = rows[3] + rows[0];
+  planes[1] = rows[3] - rows[0];
+  planes[2] = rows[3] + rows[1];
+  planes[3] = rows[3] - rows[1];
+  planes[4] = rows[3] + rows[2];
+  planes[5] = rows[3] - rows[2];
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    planes[i] /= glm::length(glm::vec3(planes[i]));
+  }
+}
+
+bool Frustum::intersects(const glm::vec4 & sphere) const {
+  glm::vec4 center(glm::vec3(sphere), 1);
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    if (glm::dot(planes[i], center) < -sphere.w) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t Frustum::cull(const glm::vec4 * spheres, size_t count, uint8_t * visible) const {
+  size_t result = 0;
+  size_t i = 0;
+#ifdef HAVE_SSE
+  __m128 px[PLANE_COUNT], py[PLANE_COUNT], pz[PLANE_COUNT], pw[PLANE_COUNT];
+  for (int p = 0; p < PLANE_COUNT; ++p) {
+    px[p] = _mm_set1_ps(planes[p].x);
+    py[p] = _mm_set1_ps(planes[p].y);
+    pz[p] = _mm_set1_ps(planes[p].z);
+    pw[p] = _mm_set1_ps(planes[p].w);
+  }
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    // Four spheres in, one coordinate per register out
+    __m128 x = _mm_loadu_ps(&spheres[i].x);
+    __m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+    __m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+    __m128 r = _mm_loadu_ps(&spheres[i + 3].x);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+    __m128 inside = _mm_cmpeq_ps(zero, zero);
+    for (int p = 0; p < PLANE_COUNT; ++p) {
+      __m128 d = _mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y));
+      d = _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+    }
+    int mask = _mm_movemask_ps(inside);
+    for (int j = 0; j < 4; ++j) {
+      visible[i + j] = (mask >> j) & 1;
+      result += visible[i + j];
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    visible[i] = intersects(spheres[i]) ? 1 : 0;
+    result += visible[i];
+  }
+  return result;
+}
+
+glm::vec4 Frustum::transform(const glm::mat4 & model, const glm::vec4 & sphere) {
+  glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(sphere), 1));
+  if (sphere.w < 0) {
+    return glm::vec4(center, std::numeric_limits<float>::infinity());
+  }
+  float scale = std::max(glm::length2(glm::vec3(model[0])),
+    std::max(glm::length2(glm::vec3(model[1])), glm::length2(glm::vec3(model[2]))));
+  return glm::vec4(center, sphere.w * sqrt(scale));
+}
@@ -0,0 +1,57 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * The six planes of a view frustum, in whatever space the matrix it's built
+ * from takes its input in (typically world space, from projection * view).
+ * Bounding spheres are packed as a vec4, with the radius in w.
+ */
+class Frustum {
+public:
+  static const int PLANE_COUNT = 6;
+
+private:
+  // Normalized, with the normals pointing inwards
+  glm::vec4 planes[PLANE_COUNT];
+
+public:
+  // A frustum containing everything
+  Frustum();
+  explicit Frustum(const glm::mat4 & clipFromWorld);
+
+  const glm::vec4 & getPlane(int plane) const {
+    return planes[plane];
+  }
+
+  // True if the sphere is at least partly inside
+  bool intersects(const glm::vec4 & sphere) const;
+
+  // Tests count spheres, four at a time, setting visible[i] to 1 where the
+  // sphere is at least partly inside and 0 otherwise.  Returns the number
+  // of visible spheres.
+  size_t cull(const glm::vec4 * spheres, size_t count, uint8_t * visible) const;
+
+  // Transforms a bounding sphere by a model matrix.  The radius grows by
+  // the largest scale factor, so the result is conservative under
+  // non-uniform scaling.  A negative radius marks a shape that should
+  // never be culled, and becomes infinite.
+  static glm::vec4 transform(const glm::mat4 & model, const glm::vec4 & sphere);
+};
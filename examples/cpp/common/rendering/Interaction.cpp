@@ -75,10 +75,10 @@ bool CameraControl::onKey(int key, int scancode, int action, int mods) {
 }
 
 void CameraControl::applyInteraction(glm::mat4 & camera) {
-  static uint32_t lastKeyboardUpdateTick = 0;
-  uint32_t now = Platform::elapsedMillis();
-  if (0 != lastKeyboardUpdateTick) {
-    float dt = (now - lastKeyboardUpdateTick) / 1000.0f;
+  static double lastKeyboardUpdate = -1;
+  double now = Platform::elapsedSeconds();
+  if (lastKeyboardUpdate >= 0) {
+    float dt = (float)(now - lastKeyboardUpdate);
     if (keyboardRotate.x || keyboardRotate.y || keyboardRotate.z) {
       const glm::quat delta = glm::quat(glm::vec3(keyboardRotate) * dt);
       rotateCamera(camera, delta);
@@ -88,5 +88,5 @@ void CameraControl::applyInteraction(glm::mat4 & camera) {
       translateCamera(camera, delta);
     }
   }
-  lastKeyboardUpdateTick = now;
+  lastKeyboardUpdate = now;
 }
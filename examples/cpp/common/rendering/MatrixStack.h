@@ -19,31 +19,112 @@
 
 #pragma once
 
-class MatrixStack : public std::stack<glm::mat4> {
+#if defined(_MSC_VER)
+#define MATRIX_STACK_ALIGN __declspec(align(64))
+#else
+#define MATRIX_STACK_ALIGN __attribute__((aligned(64)))
+#endif
+
+/**
+ * A fixed capacity stack of matrices.  Pushing and popping never allocate,
+ * and the common transforms (translate, scale and rotate) update only the
+ * columns they affect rather than building a full matrix and multiplying
+ * by it.  General products use SSE where it's available.
+ */
+class MatrixStack {
+public:
+  static const size_t CAPACITY = 32;
+
+private:
+  MATRIX_STACK_ALIGN glm::mat4 matrices[CAPACITY];
+  size_t depth{ 1 };
+
+#ifdef HAVE_SSE
+  static __m128 linear(const __m128 columns[4], const float * v) {
+    __m128 result = _mm_mul_ps(columns[0], _mm_set1_ps(v[0]));
+    result = _mm_add_ps(result, _mm_mul_ps(columns[1], _mm_set1_ps(v[1])));
+    result = _mm_add_ps(result, _mm_mul_ps(columns[2], _mm_set1_ps(v[2])));
+    return _mm_add_ps(result, _mm_mul_ps(columns[3], _mm_set1_ps(v[3])));
+  }
+
+  static void load(const glm::mat4 & m, __m128 columns[4]) {
+    for (int i = 0; i < 4; ++i) {
+      columns[i] = _mm_loadu_ps(&m[i][0]);
+    }
+  }
+#endif
+
+  // out = a * b.  out may be either of the inputs.
+  static void multiply(const glm::mat4 & a, const glm::mat4 & b, glm::mat4 & out) {
+#ifdef HAVE_SSE
+    __m128 columns[4];
+    load(a, columns);
+    for (int i = 0; i < 4; ++i) {
+      _mm_storeu_ps(&out[i][0], linear(columns, &b[i][0]));
+    }
+#else
+    out = a * b;
+#endif
+  }
+
+  // Post multiplies the top by a pure rotation, which leaves the
+  // translation column alone
+  MatrixStack & rotate3(const glm::mat3 & rotation) {
+    glm::mat4 & m = top();
+#ifdef HAVE_SSE
+    __m128 columns[4];
+    load(m, columns);
+    for (int i = 0; i < 3; ++i) {
+      float v[4] = { rotation[i][0], rotation[i][1], rotation[i][2], 0 };
+      _mm_storeu_ps(&m[i][0], linear(columns, v));
+    }
+#else
+    glm::vec4 c0 = m[0], c1 = m[1], c2 = m[2];
+    for (int i = 0; i < 3; ++i) {
+      m[i] = c0 * rotation[i][0] + c1 * rotation[i][1] + c2 * rotation[i][2];
+    }
+#endif
+    return *this;
+  }
 
 public:
 
   MatrixStack() {
-    push(glm::mat4());
+    matrices[0] = glm::mat4();
   }
 
-  explicit MatrixStack(const MatrixStack & other) {
-    *((std::stack<glm::mat4>*)this) = *((std::stack<glm::mat4>*)&other);
+  explicit MatrixStack(const MatrixStack & other) : depth(other.depth) {
+    std::copy(other.matrices, other.matrices + depth, matrices);
   }
 
   operator const glm::mat4 & () const {
     return top();
   }
 
+  glm::mat4 & top() {
+    return matrices[depth - 1];
+  }
+
+  const glm::mat4 & top() const {
+    return matrices[depth - 1];
+  }
+
+  size_t size() const {
+    return depth;
+  }
+
+  bool empty() const {
+    return 0 == depth;
+  }
+
   MatrixStack & pop() {
-    std::stack<glm::mat4>::pop();
+    --depth;
     assert(!empty());
     return *this;
   }
 
   MatrixStack & push() {
-    emplace(top());
-    return *this;
+    return push(top());
   }
 
   MatrixStack & identity() {
@@ -52,20 +133,23 @@ public:
   }
 
   MatrixStack & push(const glm::mat4 & mat) {
-    std::stack<glm::mat4>::push(mat);
+    if (CAPACITY == depth) {
+      FAIL("Matrix stack overflow");
+    }
+    matrices[depth++] = mat;
     return *this;
   }
 
   MatrixStack & rotate(const glm::mat3 & rotation) {
-    return postMultiply(glm::mat4(rotation));
+    return rotate3(rotation);
   }
 
   MatrixStack & rotate(const glm::quat & rotation) {
-    return postMultiply(glm::mat4_cast(rotation));
+    return rotate3(glm::mat3_cast(rotation));
   }
 
   MatrixStack & rotate(float theta, const glm::vec3 & axis) {
-    return postMultiply(glm::rotate(glm::mat4(), theta, axis));
+    return rotate3(glm::mat3(glm::rotate(glm::mat4(), theta, axis)));
   }
 
   MatrixStack & translate(float translation) {
@@ -77,20 +161,36 @@ public:
   }
 
   MatrixStack & translate(const glm::vec3 & translation) {
-    return postMultiply(glm::translate(glm::mat4(), translation));
+    glm::mat4 & m = top();
+#ifdef HAVE_SSE
+    __m128 columns[4];
+    load(m, columns);
+    float v[4] = { translation.x, translation.y, translation.z, 1 };
+    _mm_storeu_ps(&m[3][0], linear(columns, v));
+#else
+    m[3] = m[0] * translation.x + m[1] * translation.y + m[2] * translation.z + m[3];
+#endif
+    return *this;
   }
 
   MatrixStack & preTranslate(const glm::vec3 & translation) {
-    return preMultiply(glm::translate(glm::mat4(), translation));
+    glm::mat4 & m = top();
+    for (int i = 0; i < 4; ++i) {
+      m[i] += glm::vec4(translation * m[i].w, 0);
+    }
+    return *this;
   }
 
-
   MatrixStack & scale(float factor) {
     return scale(glm::vec3(factor));
   }
 
   MatrixStack & scale(const glm::vec3 & scale) {
-    return postMultiply(glm::scale(glm::mat4(), scale));
+    glm::mat4 & m = top();
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    return *this;
   }
 
   MatrixStack & transform(const glm::mat4 & xfm) {
@@ -98,20 +198,19 @@ public:
   }
 
   MatrixStack & preMultiply(const glm::mat4 & xfm) {
-    top() = xfm * top();
+    multiply(xfm, top(), top());
     return *this;
   }
 
   MatrixStack & postMultiply(const glm::mat4 & xfm) {
-    top() *= xfm;
+    multiply(top(), xfm, top());
     return *this;
   }
 
   // Remove the rotation component of a matrix.  useful for billboarding
   MatrixStack & unrotate() {
     glm::quat inverse = glm::inverse(glm::quat_cast(top()));
-    top() = top() * glm::mat4_cast(inverse);
-    return *this;
+    return rotate(inverse);
   }
 
   // Remove the translation component of a matrix.  useful for skyboxing
@@ -126,7 +225,7 @@ public:
     push();
     f();
     pop();
-    assert(startingDepth = size());
+    assert(startingDepth == size());
   }
 
   template <typename Function>
@@ -0,0 +1,285 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#include "Common.h"
+
+namespace oria {
+
+  float computeAcmr(const std::vector<uint32_t> & indices, size_t vertexCount, size_t cacheSize) {
+    size_t triangles = indices.size() / 3;
+    if (!triangles) {
+      return 0;
+    }
+    // Each vertex remembers when it entered the cache, so the FIFO is just
+    // a counter
+    std::vector<size_t> entered(vertexCount, 0);
+    size_t misses = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      size_t & time = entered[indices[i]];
+      if (!time || misses + 1 - time > cacheSize) {
+        ++misses;
+        time = misses;
+      }
+    }
+    return (float)misses / (float)triangles;
+  }
+
+  static const int FORSYTH_CACHE_SIZE = 32;
+  static const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+  static const float FORSYTH_LAST_TRI_SCORE = 0.75f;
+  static const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+  static const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+  static float forsythScore(int cachePosition, uint32_t remainingValence) {
+    if (!remainingValence) {
+      return -1.0f;
+    }
+    float score = 0;
+    if (cachePosition >= 0) {
+      if (cachePosition < 3) {
+        // The vertices of the triangle just drawn get a fixed score, so
+        // the order they were drawn in doesn't matter
+        score = FORSYTH_LAST_TRI_SCORE;
+      } else {
+        float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+        score = powf(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+      }
+    }
+    // Favor vertices with few triangles left, so they don't get stranded
+    score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remainingValence, -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+  }
+
+  void optimizeVertexCache(std::vector<uint32_t> & indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+      return;
+    }
+
+    // The triangles using each vertex, with the ones not yet drawn kept at
+    // the front of each vertex's range
+    std::vector<uint32_t> valence(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+      ++valence[indices[i]];
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+      offsets[v + 1] = offsets[v] + valence[v];
+    }
+    std::vector<uint32_t> adjacency(offsets[vertexCount]);
+    {
+      std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+      for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+          adjacency[fill[indices[t * 3 + k]]++] = (uint32_t)t;
+        }
+      }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+      vertexScore[v] = forsythScore(-1, valence[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    int64_t best = -1;
+    size_t scanStart = 0;
+    for (size_t drawn = 0; drawn < triangleCount; ++drawn) {
+      if (best < 0) {
+        // Nothing in the cache is useful, so start somewhere new with the
+        // best triangle left
+        float bestScore = -1;
+        while (emitted[scanStart]) {
+          ++scanStart;
+        }
+        for (size_t t = scanStart; t < triangleCount; ++t) {
+          if (!emitted[t] && triangleScore[t] > bestScore) {
+            bestScore = triangleScore[t];
+            best = t;
+          }
+        }
+      }
+
+      uint32_t triangle = (uint32_t)best;
+      emitted[triangle] = 1;
+      const uint32_t * corners = &indices[triangle * 3];
+      for (int k = 0; k < 3; ++k) {
+        uint32_t v = corners[k];
+        result.push_back(v);
+        // Move the triangle out of the vertex's live range
+        uint32_t * begin = &adjacency[offsets[v]];
+        uint32_t * end = begin + valence[v];
+        std::swap(*std::find(begin, end, triangle), *(end - 1));
+        --valence[v];
+      }
+
+      // The triangle's vertices go to the front of the cache
+      nextCache.assign(corners, corners + 3);
+      for (uint32_t v : cache) {
+        if (v != corners[0] && v != corners[1] && v != corners[2]) {
+          nextCache.push_back(v);
+        }
+      }
+      for (size_t i = 0; i < nextCache.size(); ++i) {
+        uint32_t v = nextCache[i];
+        cachePosition[v] = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+        vertexScore[v] = forsythScore(cachePosition[v], valence[v]);
+      }
+
+      // Rescore the triangles touching the cache, which is also where the
+      // next triangle most likely comes from
+      best = -1;
+      float bestScore = -1;
+      for (uint32_t v : nextCache) {
+        for (uint32_t i = 0; i < valence[v]; ++i) {
+          uint32_t t = adjacency[offsets[v] + i];
+          const uint32_t * tv = &indices[t * 3];
+          float score = vertexScore[tv[0]] + vertexScore[tv[1]] + vertexScore[tv[2]];
+          triangleScore[t] = score;
+          if (score > bestScore) {
+            bestScore = score;
+            best = t;
+          }
+        }
+      }
+
+      if (nextCache.size() > (size_t)FORSYTH_CACHE_SIZE) {
+        nextCache.resize(FORSYTH_CACHE_SIZE);
+      }
+      cache.swap(nextCache);
+    }
+    indices.swap(result);
+  }
+
+  void optimizeOverdraw(std::vector<uint32_t> & indices, const float * positions, size_t vertexCount, float threshold) {
+    static const size_t CACHE_SIZE = 16;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+      return;
+    }
+    float acmr = computeAcmr(indices, vertexCount, CACHE_SIZE);
+
+    // Split into clusters wherever the cache starts over, so the
+    // clusters can be reordered without hurting the cache much
+    std::vector<size_t> clusterStarts;
+    {
+      std::vector<size_t> entered(vertexCount, 0);
+      size_t misses = 0;
+      for (size_t t = 0; t < triangleCount; ++t) {
+        int triangleMisses = 0;
+        for (int k = 0; k < 3; ++k) {
+          size_t & time = entered[indices[t * 3 + k]];
+          if (!time || misses + 1 - time > CACHE_SIZE) {
+            ++misses;
+            ++triangleMisses;
+            time = misses;
+          }
+        }
+        if (0 == t || 3 == triangleMisses) {
+          clusterStarts.push_back(t);
+        }
+      }
+    }
+    if (clusterStarts.size() < 2) {
+      return;
+    }
+    clusterStarts.push_back(triangleCount);
+
+    auto position = [&](uint32_t v) {
+      return glm::make_vec3(positions + v * 3);
+    };
+
+    // Area weighted centroids and normals
+    glm::vec3 meshCentroid;
+    float meshArea = 0;
+    size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<glm::vec3> clusterCentroids(clusterCount);
+    std::vector<glm::vec3> clusterNormals(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+      float clusterArea = 0;
+      for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+        glm::vec3 a = position(indices[t * 3]);
+        glm::vec3 b = position(indices[t * 3 + 1]);
+        glm::vec3 d = position(indices[t * 3 + 2]);
+        glm::vec3 normal = glm::cross(b - a, d - a);
+        float area = glm::length(normal);
+        glm::vec3 center = (a + b + d) / 3.0f;
+        clusterCentroids[c] += center * area;
+        clusterNormals[c] += normal;
+        clusterArea += area;
+      }
+      meshCentroid += clusterCentroids[c];
+      meshArea += clusterArea;
+      if (clusterArea > 0) {
+        clusterCentroids[c] /= clusterArea;
+      }
+    }
+    if (meshArea <= 0) {
+      return;
+    }
+    meshCentroid /= meshArea;
+
+    std::vector<float> outwardness(clusterCount);
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+      float length = glm::length(clusterNormals[c]);
+      glm::vec3 normal = length > 0 ? clusterNormals[c] / length : glm::vec3();
+      outwardness[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+      order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return outwardness[a] > outwardness[b];
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t c : order) {
+      result.insert(result.end(),
+        indices.begin() + clusterStarts[c] * 3,
+        indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    if (computeAcmr(result, vertexCount, CACHE_SIZE) <= acmr * threshold) {
+      indices.swap(result);
+    }
+  }
+
+  std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> & indices, size_t vertexCount) {
+    std::vector<uint32_t> remap(vertexCount, ~0u);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      uint32_t & newIndex = remap[indices[i]];
+      if (~0u == newIndex) {
+        newIndex = next++;
+      }
+      indices[i] = newIndex;
+    }
+    return remap;
+  }
+}
@@ -0,0 +1,47 @@
+/************************************************************************************
+ 
+ Authors     :   Bradley Austin Davis <bdavis@saintandreas.org>
+ Copyright   :   Copyright Brad Davis. All Rights reserved.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ ************************************************************************************/
+
+#pragma once
+
+/**
+ * Offline style optimizations for indexed triangle lists, applied when a
+ * mesh is loaded.  Indices are always 32 bit here; narrowing them is up to
+ * whoever uploads the result.
+ */
+namespace oria {
+
+  // Average post-transform cache misses per triangle, simulating a FIFO
+  // cache of the given size.  1.0 or less is good, 3.0 is the worst case.
+  float computeAcmr(const std::vector<uint32_t> & indices, size_t vertexCount, size_t cacheSize = 16);
+
+  // Reorders the triangles for the post-transform vertex cache, using Tom
+  // Forsyth's "Linear-Speed Vertex Cache Optimisation"
+  void optimizeVertexCache(std::vector<uint32_t> & indices, size_t vertexCount);
+
+  // Reorders runs of triangles so that the ones facing away from the
+  // center of the mesh are drawn first and occlude the rest.  The new order
+  // is only kept if its ACMR is within threshold times the current one.
+  // positions holds three floats per vertex.
+  void optimizeOverdraw(std::vector<uint32_t> & indices, const float * positions, size_t vertexCount, float threshold = 1.05f);
+
+  // Renumbers the vertices in the order the indices first use them, so
+  // that vertex fetches walk forward through memory.  Returns the new
+  // index of each old vertex, or ~0 for unused vertices.
+  std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> & indices, size_t vertexCount);
+}
@@ -13,14 +13,55 @@ class AsyncTimewarpExample : public RiftGlfwApp {
   glm::mat4 eyeProjections[2];
 
   int perEyeDelay = 0;
-  // Offscreen rendering targets: two for each eye.
-  // One is used for rendering (writing) while the other 
-  // is  used for distortion (reading)
-  FramebufferWrapperPtr  eyeFramebuffers[2][2];
-  // Keep track of the index of the buffer currently being written to for each eye
-  unsigned int writeFramebuffersIndex{ 0 };
+
+  // Offscreen rendering targets are kept in a swap chain.  At any time
+  // one entry can be read by the distortion thread, one can be waiting
+  // for it, and the render thread needs one more to write into, so three
+  // is the minimum for the render thread never to wait.  Instead of
+  // calling glFinish, each side fences its work and the other side
+  // waits on that fence on the GPU before touching the framebuffers.
+  static const int SWAP_CHAIN_SIZE = 3;
+
+  enum EntryState {
+    FREE,
+    WRITING,
+    PENDING,
+    DISPLAYING,
+  };
+
+  struct SwapChainEntry {
+    FramebufferWrapperPtr framebuffers[2];
+    ovrPosef poses[2];
+    EntryState state{ FREE };
+    // Signalled when the render thread has finished drawing the entry
+    GLsync renderFence{ nullptr };
+    // Signalled when the distortion thread has finished reading it
+    GLsync releaseFence{ nullptr };
+    // When the poses were sampled, and the frame's order of submission
+    double poseTime{ 0 };
+    unsigned int sequence{ 0 };
+    bool displayed{ false };
+  };
+
+  SwapChainEntry swapChain[SWAP_CHAIN_SIZE];
+  int displayIndex{ -1 };
+  unsigned int submitted{ 0 };
   unsigned int distortionFrameIndex{ 0 };
 
+  // Render to display latency, measured from sampling the poses to the
+  // middle of scanout of the first frame that shows the result.  Guarded
+  // by ovrLock, like the swap chain.
+  struct LatencyStats {
+    unsigned int displayed{ 0 };
+    unsigned int dropped{ 0 };
+    unsigned int repeated{ 0 };
+    float lastMs{ 0 };
+    float averageMs{ 0 };
+    float maxMs{ 0 };
+  } latency;
+  // The render thread's copy, for display
+  LatencyStats frameLatency;
+
   std::unique_ptr<std::thread> threadPtr;
   std::mutex ovrLock;
 
@@ -102,9 +143,10 @@ public:
     for_each_eye([&](ovrEyeType eye){
       glm::uvec2 frameBufferSize =
         ovr::toGlm(eyeTextures[eye].Header.TextureSize);
-      for (int i = 0; i < 2; ++i) {
-        eyeFramebuffers[eye][i] =  FramebufferWrapperPtr(new FramebufferWrapper());
-        eyeFramebuffers[eye][i]->init(frameBufferSize);
+      for (int i = 0; i < SWAP_CHAIN_SIZE; ++i) {
+        FramebufferWrapperPtr & framebuffer = swapChain[i].framebuffers[eye];
+        framebuffer = FramebufferWrapperPtr(new FramebufferWrapper());
+        framebuffer->init(frameBufferSize);
       }
     });
 
@@ -161,6 +203,71 @@ public:
   }
 
 
+  // Called with ovrLock held.  Picks the newest submitted frame, if there
+  // is one, freeing the frame it replaces and any older ones which were
+  // never displayed.
+  void selectDisplayEntry() {
+    int newest = -1;
+    for (int i = 0; i < SWAP_CHAIN_SIZE; ++i) {
+      if (PENDING == swapChain[i].state &&
+        (-1 == newest || swapChain[i].sequence > swapChain[newest].sequence)) {
+        newest = i;
+      }
+    }
+    if (-1 == newest) {
+      if (-1 != displayIndex) {
+        ++latency.repeated;
+      }
+      return;
+    }
+
+    for (int i = 0; i < SWAP_CHAIN_SIZE; ++i) {
+      SwapChainEntry & entry = swapChain[i];
+      if (i == newest || (DISPLAYING != entry.state && PENDING != entry.state)) {
+        continue;
+      }
+      if (PENDING == entry.state) {
+        ++latency.dropped;
+        glDeleteSync(entry.renderFence);
+        entry.renderFence = nullptr;
+      } else {
+        // The SDK may still be sampling this one on the GPU
+        entry.releaseFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // The render context waits on this fence, so it has to reach the
+        // GPU even if this context doesn't flush for a while
+        glFlush();
+      }
+      entry.state = FREE;
+    }
+
+    SwapChainEntry & entry = swapChain[newest];
+    // Make the distortion context's GPU commands wait for the rendering
+    // to finish, without blocking this thread
+    glWaitSync(entry.renderFence, 0, GL_TIMEOUT_IGNORED);
+    glDeleteSync(entry.renderFence);
+    entry.renderFence = nullptr;
+    entry.state = DISPLAYING;
+    displayIndex = newest;
+    for_each_eye([&](ovrEyeType eye) {
+      ((ovrGLTexture&)(eyeTextures[eye])).OGL.TexId =
+        oglplus::GetName(entry.framebuffers[eye]->color);
+      eyePoses[eye] = entry.poses[eye];
+    });
+  }
+
+  void recordLatency(const ovrFrameTiming & frameTime) {
+    SwapChainEntry & entry = swapChain[displayIndex];
+    if (entry.displayed) {
+      return;
+    }
+    entry.displayed = true;
+    float ms = (float)((frameTime.ScanoutMidpointSeconds - entry.poseTime) * 1000.0);
+    ++latency.displayed;
+    latency.lastMs = ms;
+    latency.averageMs += (ms - latency.averageMs) / latency.displayed;
+    latency.maxMs = std::max(latency.maxMs, ms);
+  }
+
   void distortionThread() {
     Platform::setThreadPriority(Platform::HIGH);
     // Make the shared context current
@@ -180,15 +287,60 @@ public:
       }
 
       ovrLock.lock();
-      ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
+      selectDisplayEntry();
+      if (-1 != displayIndex) {
+        recordLatency(frameTime);
+      }
       ovrLock.unlock();
+
+      // eyePoses and eyeTextures are only touched by this thread, so the
+      // render thread doesn't need to wait for EndFrame
+      ovrHmd_EndFrame(hmd, eyePoses, eyeTextures);
     }
   }
 
+  // Called with ovrLock held.  There's always an entry which is neither
+  // displayed nor the newest pending one, so this never has to wait.
+  int acquireWriteEntry() {
+    int result = -1;
+    for (int i = 0; i < SWAP_CHAIN_SIZE; ++i) {
+      SwapChainEntry & entry = swapChain[i];
+      if (FREE == entry.state) {
+        result = i;
+        break;
+      }
+      if (PENDING == entry.state &&
+        (-1 == result || entry.sequence < swapChain[result].sequence)) {
+        result = i;
+      }
+    }
+
+    SwapChainEntry & entry = swapChain[result];
+    if (PENDING == entry.state) {
+      // Overwriting a frame the distortion thread never picked up
+      ++latency.dropped;
+      glDeleteSync(entry.renderFence);
+      entry.renderFence = nullptr;
+    }
+    if (entry.releaseFence) {
+      glWaitSync(entry.releaseFence, 0, GL_TIMEOUT_IGNORED);
+      glDeleteSync(entry.releaseFence);
+      entry.releaseFence = nullptr;
+    }
+    entry.state = WRITING;
+    return result;
+  }
+
   void draw() {
+    ovrLock.lock();
+    int writeIndex = acquireWriteEntry();
+    frameLatency = latency;
+    ovrLock.unlock();
+    SwapChainEntry & entry = swapChain[writeIndex];
+
     // The pose for each rendered framebuffer
-    ovrPosef renderPoses[2];
-    ovrHmd_GetEyePoses(hmd, distortionFrameIndex, hmdToEyeOffsets, renderPoses, nullptr);
+    entry.poseTime = ovr_GetTimeInSeconds();
+    ovrHmd_GetEyePoses(hmd, distortionFrameIndex, hmdToEyeOffsets, entry.poses, nullptr);
 
     for (int i = 0; i < 2; ++i) {
       ovrEyeType eye = hmd->EyeRenderOrder[i];
@@ -196,27 +348,26 @@ public:
       Stacks::projection().top() = eyeProjections[eye];
       Stacks::withPush(mv, [&]{
         // Apply the head pose
-        glm::mat4 m = ovr::toGlm(renderPoses[eye]);
+        glm::mat4 m = ovr::toGlm(entry.poses[eye]);
         mv.preMultiply(glm::inverse(m));
-        FramebufferWrapperPtr & frameBuffer =
-          eyeFramebuffers[eye][writeFramebuffersIndex];
         // Render the scene to an offscreen buffer
-        frameBuffer->Bind();
+        entry.framebuffers[eye]->Bind();
         renderScene();
       });
     } // for each eye
 
-    // Ensure all scene rendering commands have been completed
-    glFinish();
+    // Rather than waiting for the GPU here, let the distortion thread's
+    // context wait on this fence
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Make sure the fence reaches the GPU, or the other context could 
+    // wait on it forever
+    glFlush();
 
     ovrLock.lock();
-    for_each_eye([&](ovrEyeType eye) {
-      int renderBufferIndex = writeFramebuffersIndex;
-      ((ovrGLTexture&)(eyeTextures[eye])).OGL.TexId =
-        oglplus::GetName(eyeFramebuffers[eye][renderBufferIndex]->color);
-      eyePoses[eye] = renderPoses[eye];
-    });
-    writeFramebuffersIndex = writeFramebuffersIndex ? 0 : 1;
+    entry.renderFence = fence;
+    entry.sequence = ++submitted;
+    entry.displayed = false;
+    entry.state = PENDING;
     ovrLock.unlock();
   }
 
@@ -231,9 +382,14 @@ public:
 
     std::string maxfps = perEyeDelay ? 
       Platform::format("%0.2f", 500.0f / perEyeDelay) : "N/A";
+    const LatencyStats & stats = frameLatency;
     std::string message =
-      Platform::format("Per Eye Delay %dms\nMax FPS %s",
-      perEyeDelay, maxfps.c_str());
+      Platform::format("Per Eye Delay %dms\nMax FPS %s\n"
+      "Latency %0.1fms (avg %0.1fms, max %0.1fms)\n"
+      "Dropped %u Repeated %u",
+      perEyeDelay, maxfps.c_str(),
+      stats.lastMs, stats.averageMs, stats.maxMs,
+      stats.dropped, stats.repeated);
     renderStringAt(message, glm::vec2(-0.5, 0.5));
 
     // Simulate some really slow rendering
@@ -0,0 +1,137 @@
+#include "Common.h"
+#include <random>
+
+// Culls synthetic scenes of 10k to 1M objects against the combined stereo
+// frustum of a DK2's default field of view, and reports the time taken by
+// each stage: moving the bounding spheres into world space, testing them
+// one at a time with Frustum::intersects, testing them in batches with
+// Frustum::cull, and the batched test split across the JobSystem as
+// RenderQueue::cull does for large queues.  The batched results are
+// compared against the scalar test object by object, so a batched path
+// that disagrees fails the run.  The two round differently, so spheres
+// touching a plane to within rounding may go either way.
+//
+// The objects are scattered through a 200m cube around the viewer.  The
+// results also go to ORIA_CULL_BENCH_OUTPUT as CSV.
+class CullBench {
+  static const int REPEATS = 5;
+
+  struct Scene {
+    std::vector<glm::mat4> models;
+    std::vector<glm::vec4> localBounds;
+    std::vector<glm::vec4> worldBounds;
+    std::vector<uint8_t> visible;
+  };
+
+  static Scene makeScene(size_t count) {
+    Scene scene;
+    scene.models.reserve(count);
+    scene.localBounds.reserve(count);
+    // Fixed seed, so every run sees the same scene
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * PI);
+    for (size_t i = 0; i < count; ++i) {
+      glm::mat4 model = glm::translate(glm::mat4(), glm::vec3(position(random), position(random), position(random)));
+      model = glm::rotate(model, angle(random), glm::vec3(0, 1, 0));
+      scene.models.push_back(model);
+      scene.localBounds.push_back(glm::vec4(0, 0, 0, radius(random)));
+    }
+    scene.worldBounds.resize(count);
+    scene.visible.resize(count);
+    return scene;
+  }
+
+  // Objects the batched test disagrees with the scalar one on, other than
+  // spheres touching one of the planes to within rounding
+  static size_t countMismatches(const Frustum & frustum, const Scene & scene) {
+    size_t result = 0;
+    for (size_t i = 0; i < scene.worldBounds.size(); ++i) {
+      const glm::vec4 & sphere = scene.worldBounds[i];
+      if ((frustum.intersects(sphere) ? 1 : 0) == scene.visible[i]) {
+        continue;
+      }
+      float closest = std::numeric_limits<float>::max();
+      for (int p = 0; p < Frustum::PLANE_COUNT; ++p) {
+        float distance = glm::dot(frustum.getPlane(p), glm::vec4(glm::vec3(sphere), 1)) + sphere.w;
+        closest = std::min(closest, std::abs(distance));
+      }
+      if (closest > 1e-3f) {
+        ++result;
+      }
+    }
+    return result;
+  }
+
+public:
+  int run() {
+    ovrFovPort fovs[2];
+    for_each_eye([&](ovrEyeType eye) {
+      fovs[eye].UpTan = fovs[eye].DownTan = 1.3292f;
+      fovs[eye].LeftTan = ovrEye_Left == eye ? 1.0586f : 1.0924f;
+      fovs[eye].RightTan = ovrEye_Left == eye ? 1.0924f : 1.0586f;
+    });
+    glm::mat4 views[2] = {
+      glm::translate(glm::mat4(), glm::vec3(0.032f, 0, 0)),
+      glm::translate(glm::mat4(), glm::vec3(-0.032f, 0, 0)),
+    };
+    Frustum frustum = ovr::getStereoFrustum(fovs, views, 0.01f, 1000.0f);
+    JobSystem & jobs = JobSystem::get();
+
+    BenchReport report("ORIA_CULL_BENCH_OUTPUT", "cull_bench.csv",
+      Platform::format("%9s %8s %10s %10s %10s %10s %12s\n",
+        "objects", "visible", "transform", "scalar", "batched", "parallel", "Mobjects/s"),
+      "objects,visible,transformMs,scalarMs,batchedMs,parallelMs,batchedMegaObjectsPerSecond\n");
+    bool allMatch = true;
+    for (size_t count : { (size_t)10000, (size_t)100000, (size_t)1000000 }) {
+      Scene scene = makeScene(count);
+
+      float transformMs = BenchReport::bestMillis(REPEATS, [&] {
+        for (size_t i = 0; i < count; ++i) {
+          scene.worldBounds[i] = Frustum::transform(scene.models[i], scene.localBounds[i]);
+        }
+      });
+
+      size_t scalarVisible = 0;
+      float scalarMs = BenchReport::bestMillis(REPEATS, [&] {
+        scalarVisible = 0;
+        for (size_t i = 0; i < count; ++i) {
+          scalarVisible += frustum.intersects(scene.worldBounds[i]) ? 1 : 0;
+        }
+      });
+
+      size_t batchedVisible = 0;
+      float batchedMs = BenchReport::bestMillis(REPEATS, [&] {
+        batchedVisible = frustum.cull(scene.worldBounds.data(), count, scene.visible.data());
+      });
+
+      std::atomic<size_t> parallelVisible{ 0 };
+      float parallelMs = BenchReport::bestMillis(REPEATS, [&] {
+        parallelVisible = 0;
+        jobs.parallelFor(count, [&](size_t begin, size_t end) {
+          parallelVisible += frustum.cull(scene.worldBounds.data() + begin, end - begin, scene.visible.data() + begin);
+        }, 1024);
+      });
+
+      // The parallel pass wrote the visible flags last
+      size_t mismatches = countMismatches(frustum, scene);
+      if (mismatches || batchedVisible != parallelVisible) {
+        allMatch = false;
+        SAY_ERR("Culling disagrees for %d objects: scalar %d visible, batched %d, parallel %d, %d mismatched",
+          (int)count, (int)scalarVisible, (int)batchedVisible, (int)parallelVisible, (int)mismatches);
+      }
+      float rate = (float)count / batchedMs / 1e3f;
+      report.addRow(
+        Platform::format("%9d %8d %8.2f ms %7.2f ms %7.2f ms %7.2f ms %12.1f\n",
+          (int)count, (int)batchedVisible, transformMs, scalarMs, batchedMs, parallelMs, rate),
+        Platform::format("%d,%d,%f,%f,%f,%f,%f\n",
+          (int)count, (int)batchedVisible, transformMs, scalarMs, batchedMs, parallelMs, rate));
+    }
+    bool saved = report.save();
+    SAY("JobSystem threads: %d", (int)jobs.getThreadCount());
+    return saved && allMatch ? 0 : -1;
+  }
+};
+
+RUN_APP(CullBench);
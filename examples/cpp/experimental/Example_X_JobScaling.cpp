@@ -0,0 +1,52 @@
+#include "Common.h"
+
+// Measures how the startup asset load scales with the number of cores
+// given to the JobSystem.  Each run is SceneAssets::prepare, the step
+// oria::loadSceneAssets runs at startup: the skybox faces and the floor
+// texture are decoded, and the manikin mesh decoded and optimized, from
+// one core up to all of them.  The upload that follows needs a context
+// and isn't timed, so no window is needed.  The mesh cache is bypassed so
+// every run does the full decode.
+//
+// ORIA_JOB_SCALING_CORES caps the core count, and the results also go to
+// ORIA_JOB_SCALING_OUTPUT as CSV.  OpenCTM decodes large meshes on
+// threads of its own, which this doesn't control.
+class JobScaling {
+  static const int REPEATS = 3;
+
+  // The best of a few runs, in milliseconds
+  static float measure(int cores) {
+    JobSystem jobs(cores - 1);
+    return BenchReport::bestMillis(REPEATS, [&] {
+      SceneAssets assets;
+      assets.prepare(jobs, false);
+    });
+  }
+
+public:
+  int run() {
+    int maxCores = std::max(1, (int)std::thread::hardware_concurrency());
+    const char * cores = getenv("ORIA_JOB_SCALING_CORES");
+    if (cores) {
+      maxCores = std::max(1, atoi(cores));
+    }
+
+    BenchReport report("ORIA_JOB_SCALING_OUTPUT", "job_scaling.csv",
+      Platform::format("%5s %10s %8s %10s\n", "cores", "ms", "speedup", "efficiency"),
+      "cores,ms,speedup,efficiency\n");
+    float baseline = 0;
+    for (int c = 1; c <= maxCores; ++c) {
+      float ms = measure(c);
+      if (1 == c) {
+        baseline = ms;
+      }
+      float speedup = baseline / ms;
+      report.addRow(
+        Platform::format("%5d %10.2f %8.2f %9.0f%%\n", c, ms, speedup, 100.0f * speedup / c),
+        Platform::format("%d,%f,%f,%f\n", c, ms, speedup, speedup / c));
+    }
+    return report.save() ? 0 : -1;
+  }
+};
+
+RUN_APP(JobScaling);
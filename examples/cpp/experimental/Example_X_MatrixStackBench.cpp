@@ -0,0 +1,168 @@
+#include "Common.h"
+
+// Compares MatrixStack against the std::stack based implementation it
+// replaced, on the two workloads that drive it hardest: a push, translate
+// and scale per glyph of text, and a push, translate, rotate, scale and
+// model transform per object of a scene.  Every resulting matrix is
+// compared, element by element, so a fast path that gets the math wrong
+// shows up as a mismatch rather than a speedup.
+//
+// The results also go to ORIA_MATRIX_BENCH_OUTPUT as CSV.
+class MatrixStackBench {
+  // The original, kept to measure against
+  class DequeMatrixStack : public std::stack<glm::mat4> {
+  public:
+    DequeMatrixStack() {
+      std::stack<glm::mat4>::push(glm::mat4());
+    }
+
+    DequeMatrixStack & pop() {
+      std::stack<glm::mat4>::pop();
+      return *this;
+    }
+
+    DequeMatrixStack & push() {
+      emplace(top());
+      return *this;
+    }
+
+    DequeMatrixStack & rotate(const glm::quat & rotation) {
+      return postMultiply(glm::mat4_cast(rotation));
+    }
+
+    DequeMatrixStack & translate(const glm::vec3 & translation) {
+      return postMultiply(glm::translate(glm::mat4(), translation));
+    }
+
+    DequeMatrixStack & scale(const glm::vec3 & scale) {
+      return postMultiply(glm::scale(glm::mat4(), scale));
+    }
+
+    DequeMatrixStack & transform(const glm::mat4 & xfm) {
+      return postMultiply(xfm);
+    }
+
+    DequeMatrixStack & postMultiply(const glm::mat4 & xfm) {
+      top() *= xfm;
+      return *this;
+    }
+
+    template <typename Function>
+    void withPush(Function f) {
+      push();
+      f();
+      pop();
+    }
+  };
+
+  static const int GLYPHS = 4096;
+  static const int OBJECTS = 4096;
+  static const int REPEATS = 50;
+
+  std::vector<glm::vec3> offsets;
+  std::vector<glm::quat> orientations;
+  std::vector<glm::mat4> models;
+
+  // Each workload stores every matrix it produces, which both stacks pay
+  // for equally and which keeps the math from being optimized away
+  template <typename Stack>
+  void text(Stack & mv, std::vector<glm::mat4> & results) {
+    for (int i = 0; i < GLYPHS; ++i) {
+      mv.withPush([&] {
+        mv.translate(offsets[i]);
+        mv.scale(glm::vec3(0.02f));
+        results[i] = mv.top();
+      });
+    }
+  }
+
+  template <typename Stack>
+  void scene(Stack & mv, std::vector<glm::mat4> & results) {
+    for (int i = 0; i < OBJECTS; ++i) {
+      mv.withPush([&] {
+        mv.translate(offsets[i]);
+        mv.rotate(orientations[i]);
+        mv.scale(glm::vec3(0.5f));
+        mv.transform(models[i]);
+        results[i] = mv.top();
+      });
+    }
+  }
+
+  // Nanoseconds per item, the best of the repeats
+  template <typename Stack, typename Workload>
+  float measure(int items, Workload workload, std::vector<glm::mat4> & results) {
+    Stack mv;
+    mv.push();
+    mv.translate(glm::vec3(0, -1.6f, -2));
+    results.resize(items);
+    int64_t best = BenchReport::bestNanos(REPEATS, [&] {
+      workload(mv, results);
+    });
+    return (float)best / items;
+  }
+
+  // The largest difference between corresponding elements, relative to
+  // the element's size where that's above one
+  static float maxError(const std::vector<glm::mat4> & a, const std::vector<glm::mat4> & b) {
+    float result = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+      for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+          float difference = std::abs(a[i][c][r] - b[i][c][r]);
+          result = std::max(result, difference / std::max(1.0f, std::abs(a[i][c][r])));
+        }
+      }
+    }
+    return result;
+  }
+
+public:
+  MatrixStackBench() {
+    for (int i = 0; i < std::max(GLYPHS, OBJECTS); ++i) {
+      float f = (float)i;
+      offsets.push_back(glm::vec3(std::fmod(f * 0.37f, 10.0f) - 5.0f, std::fmod(f * 0.11f, 3.0f), -f * 0.01f));
+      orientations.push_back(glm::angleAxis(f * 0.01f, glm::normalize(glm::vec3(1, f, 0.5f))));
+      models.push_back(glm::rotate(glm::mat4(), f * 0.02f, glm::vec3(0, 1, 0)));
+    }
+  }
+
+  int run() {
+    struct Row {
+      const char * name;
+      int items;
+      float dequeNanos, fixedNanos, maxError;
+    } rows[] = {
+      { "text", GLYPHS, 0, 0, 0 },
+      { "scene", OBJECTS, 0, 0, 0 },
+    };
+    std::vector<glm::mat4> dequeResults, fixedResults;
+    rows[0].dequeNanos = measure<DequeMatrixStack>(GLYPHS, [&](DequeMatrixStack & mv, std::vector<glm::mat4> & out) { text(mv, out); }, dequeResults);
+    rows[0].fixedNanos = measure<MatrixStack>(GLYPHS, [&](MatrixStack & mv, std::vector<glm::mat4> & out) { text(mv, out); }, fixedResults);
+    rows[0].maxError = maxError(dequeResults, fixedResults);
+    rows[1].dequeNanos = measure<DequeMatrixStack>(OBJECTS, [&](DequeMatrixStack & mv, std::vector<glm::mat4> & out) { scene(mv, out); }, dequeResults);
+    rows[1].fixedNanos = measure<MatrixStack>(OBJECTS, [&](MatrixStack & mv, std::vector<glm::mat4> & out) { scene(mv, out); }, fixedResults);
+    rows[1].maxError = maxError(dequeResults, fixedResults);
+
+    BenchReport report("ORIA_MATRIX_BENCH_OUTPUT", "matrix_stack.csv",
+      Platform::format("%-8s %8s %12s %12s %8s %8s\n",
+        "workload", "items", "std::stack", "MatrixStack", "speedup", "match"),
+      "workload,items,dequeNanosPerItem,matrixStackNanosPerItem,speedup,maxError,match\n");
+    bool allMatch = true;
+    for (const Row & row : rows) {
+      // A few ulps of float rounding, since the fast paths may multiply
+      // in a different order
+      bool match = row.maxError <= 1e-5f;
+      allMatch = allMatch && match;
+      float speedup = row.dequeNanos / row.fixedNanos;
+      report.addRow(
+        Platform::format("%-8s %8d %10.1f ns %10.1f ns %8.2f %8s\n",
+          row.name, row.items, row.dequeNanos, row.fixedNanos, speedup, match ? "yes" : "NO"),
+        Platform::format("%s,%d,%f,%f,%f,%g,%d\n",
+          row.name, row.items, row.dequeNanos, row.fixedNanos, speedup, row.maxError, match ? 1 : 0));
+    }
+    return report.save() && allMatch ? 0 : -1;
+  }
+};
+
+RUN_APP(MatrixStackBench);
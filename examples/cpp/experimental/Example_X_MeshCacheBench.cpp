@@ -0,0 +1,75 @@
+#include "Common.h"
+
+// Compares the startup cost of each mesh with and without the mesh cache:
+// decoding the OpenCTM data and running the optimizations, against
+// mapping the prepared result from the cache directory.  The first cached
+// load writes the file if a previous run hasn't, and isn't counted.
+// Nothing is uploaded, so no window is needed.
+//
+// The cache is skipped if there's no safe cache directory, in which case
+// only the decode times are reported.  The results also go to
+// ORIA_MESH_BENCH_OUTPUT as CSV.
+class MeshCacheBench {
+  static const int REPEATS = 5;
+
+  // The best of a few loads, in milliseconds, or a negative value if any
+  // of them didn't come from where it was meant to
+  static float measure(Resource resource, bool useCache) {
+    float best = std::numeric_limits<float>::max();
+    for (int r = 0; r < REPEATS; ++r) {
+      Mesh::Source source;
+      Mesh::prepare({ "Position", "Normal", "TexCoord" }, resource, source, useCache);
+      if (source.fromCache != useCache) {
+        return -1;
+      }
+      best = std::min(best, source.loadMillis);
+    }
+    return best;
+  }
+
+public:
+  int run() {
+    static const std::pair<const char *, Resource> MESHES[] = {
+      { "manikin", Resource::MESHES_MANIKIN_CTM },
+      { "rift", Resource::MESHES_RIFT_CTM },
+      { "sphere", Resource::MESHES_SPHERE_CTM },
+    };
+
+    bool useCache = !Platform::getCacheDirectory().empty();
+    if (!useCache) {
+      SAY_ERR("No cache directory, only decoding");
+    }
+
+    BenchReport report("ORIA_MESH_BENCH_OUTPUT", "mesh_cache.csv",
+      Platform::format("%-10s %10s %10s %10s %8s\n",
+        "mesh", "triangles", "decode ms", "cache ms", "speedup"),
+      "mesh,triangles,decodeMs,cacheMs,speedup\n");
+    bool allCached = true;
+    for (const auto & entry : MESHES) {
+      Mesh::Source source;
+      // Writes the cache file if it's missing
+      Mesh::prepare({ "Position", "Normal", "TexCoord" }, entry.second, source, useCache);
+      int triangles = (int)source.header.triangleCount;
+
+      float decodeMs = measure(entry.second, false);
+      float cacheMs = 0, speedup = 0;
+      if (useCache) {
+        cacheMs = measure(entry.second, true);
+        if (cacheMs < 0) {
+          SAY_ERR("The %s mesh wasn't loaded from the cache", entry.first);
+          allCached = false;
+          continue;
+        }
+        speedup = decodeMs / cacheMs;
+      }
+      report.addRow(
+        Platform::format("%-10s %10d %10.3f %10.3f %8.1f\n",
+          entry.first, triangles, decodeMs, cacheMs, speedup),
+        Platform::format("%s,%d,%f,%f,%f\n",
+          entry.first, triangles, decodeMs, cacheMs, speedup));
+    }
+    return report.save() && allCached ? 0 : -1;
+  }
+};
+
+RUN_APP(MeshCacheBench);
@@ -0,0 +1,43 @@
+#include "Common.h"
+
+// Runs the pose predictors over a tracking recording and reports their
+// angular error against the prediction horizon.  ORIA_TRACKING_REPLAY
+// names the recording, ORIA_POSE_PREDICTOR limits the run to one
+// predictor, and the results also go to ORIA_PREDICTION_OUTPUT as CSV.
+class PredictionEvaluation {
+public:
+  int run() {
+    const char * input = getenv("ORIA_TRACKING_REPLAY");
+    if (!input) {
+      SAY_ERR("Set ORIA_TRACKING_REPLAY to a tracking recording");
+      return -1;
+    }
+    PredictionEvaluator evaluator;
+    if (!evaluator.load(input)) {
+      SAY_ERR("Unable to read the tracking recording %s", input);
+      return -1;
+    }
+
+    std::vector<std::string> predictors = PosePredictor::getNames();
+    const char * predictor = getenv("ORIA_POSE_PREDICTOR");
+    if (predictor) {
+      predictors = { predictor };
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PredictionEvaluator::Result> results = evaluator.evaluate(predictors);
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    SAY("%s", PredictionEvaluator::toTable(results).c_str());
+    SAY("Evaluated %d samples in %0.2f s", (int)evaluator.getSampleCount(), seconds);
+
+    const char * output = getenv("ORIA_PREDICTION_OUTPUT");
+    std::string outputPath = output ? output : "prediction_error.csv";
+    if (!oria::writeFile(outputPath, PredictionEvaluator::toCsv(results))) {
+      SAY_ERR("Unable to write %s", outputPath.c_str());
+      return -1;
+    }
+    return 0;
+  }
+};
+
+RUN_APP(PredictionEvaluation);
@@ -0,0 +1,96 @@
+#include "Common.h"
+
+// Times loading the shader programs used by the common rendering code
+// through oria::loadProgram.  The first load of each pair either compiles
+// it or, once a previous run has written the binary to the cache
+// directory, loads the binary from disk.  The second load of each pair
+// comes from the in memory cache.
+//
+// For the cold numbers, run with XDG_CACHE_HOME (LOCALAPPDATA on
+// Windows) pointing at an empty directory, then run again for the warm
+// ones.  The window is hidden and closes once the run is done.  The
+// results also go to ORIA_PROGRAM_BENCH_OUTPUT as CSV.
+class ProgramCacheBench : public GlfwApp {
+  struct Pair {
+    const char * name;
+    Resource vs;
+    Resource fs;
+  };
+
+  // Which path the last load took, from the change in the cache stats
+  static const char * classify(const oria::ProgramCacheStats & before, const oria::ProgramCacheStats & after) {
+    if (after.compiles != before.compiles) {
+      return "compiled";
+    }
+    if (after.diskHits != before.diskHits) {
+      return "disk";
+    }
+    if (after.memoryHits != before.memoryHits) {
+      return "memory";
+    }
+    return "none";
+  }
+
+  static float timeLoad(const Pair & pair, const char * & source) {
+    oria::ProgramCacheStats before = oria::getProgramCacheStats();
+    int64_t start = Platform::elapsedNanos();
+    ProgramPtr program = oria::loadProgram(pair.vs, pair.fs);
+    // Drivers may defer work until the program is first used
+    glUseProgram(oglplus::GetName(*program));
+    glFinish();
+    float ms = (float)(Platform::elapsedNanos() - start) / 1e6f;
+    glUseProgram(0);
+    source = classify(before, oria::getProgramCacheStats());
+    return ms;
+  }
+
+  void runBenchmark() {
+    static const Pair PAIRS[] = {
+      { "simple", Resource::SHADERS_SIMPLE_VS, Resource::SHADERS_COLORED_FS },
+      { "colorCube", Resource::SHADERS_COLORCUBE_VS, Resource::SHADERS_COLORCUBE_FS },
+      { "textured", Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS },
+      { "lit", Resource::SHADERS_LIT_VS, Resource::SHADERS_LITCOLORED_FS },
+      { "litMaterials", Resource::SHADERS_LITMATERIALS_VS, Resource::SHADERS_LITCOLORED_FS },
+      { "cubemap", Resource::SHADERS_CUBEMAP_VS, Resource::SHADERS_CUBEMAP_FS },
+      { "text", Resource::SHADERS_TEXT_VS, Resource::SHADERS_TEXT_FS },
+    };
+
+    std::string directory = Platform::getCacheDirectory();
+    SAY("Program cache directory: %s", directory.empty() ? "(disabled)" : directory.c_str());
+    BenchReport report("ORIA_PROGRAM_BENCH_OUTPUT", "program_cache.csv",
+      Platform::format("%-14s %10s %10s %10s %10s\n",
+        "program", "first", "ms", "second", "ms"),
+      "program,firstSource,firstMs,secondSource,secondMs\n");
+    float firstTotal = 0, secondTotal = 0;
+    for (const Pair & pair : PAIRS) {
+      const char * firstSource;
+      const char * secondSource;
+      float first = timeLoad(pair, firstSource);
+      float second = timeLoad(pair, secondSource);
+      firstTotal += first;
+      secondTotal += second;
+      report.addRow(
+        Platform::format("%-14s %10s %10.2f %10s %10.2f\n",
+          pair.name, firstSource, first, secondSource, second),
+        Platform::format("%s,%s,%f,%s,%f\n",
+          pair.name, firstSource, first, secondSource, second));
+    }
+    report.addTableRow(Platform::format("%-14s %10s %10.2f %10s %10.2f\n",
+      "total", "", firstTotal, "", secondTotal));
+    report.save();
+  }
+
+protected:
+  virtual GLFWwindow * createRenderingTarget(glm::uvec2 & outSize, glm::ivec2 & outPosition) {
+    outSize = uvec2(640, 480);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    return glfw::createWindow(outSize);
+  }
+
+  virtual void draw() {
+    runBenchmark();
+    glfwSetWindowShouldClose(window, 1);
+  }
+};
+
+RUN_APP(ProgramCacheBench);
@@ -0,0 +1,91 @@
+#include "Common.h"
+
+// Compares the cost of reading the startup resources through a string
+// and a stream, the way decoders used to, against a ResourceView.  For
+// each path it reports the bytes copied per read, from the resource
+// stats, and the best time of a few reads.  Every byte is summed so a
+// mapped view pays for faulting its pages in.
+//
+// Views are only mapped in builds that load resources from disk, so a
+// release build with embedded resources shows one copy per view.  The
+// results also go to ORIA_RESOURCE_BENCH_OUTPUT as CSV.
+class ResourceBench {
+  static const int REPEATS = 5;
+
+  struct Result {
+    float ms{ 0 };
+    size_t bytesCopied{ 0 };
+    size_t bytesMapped{ 0 };
+  };
+
+  static uint32_t sum(const void * data, size_t size) {
+    const uint8_t * bytes = (const uint8_t *)data;
+    uint32_t result = 0;
+    for (size_t i = 0; i < size; ++i) {
+      result += bytes[i];
+    }
+    return result;
+  }
+
+  template <typename F>
+  static Result measure(F read) {
+    ResourceStats & stats = Platform::getResourceStats();
+    Result result;
+    size_t copied = stats.bytesCopied;
+    size_t mapped = stats.bytesMapped;
+    result.ms = BenchReport::bestMillis(REPEATS, [&] {
+      volatile uint32_t checksum = read();
+      (void)checksum;
+    });
+    // Every read does the same work, so the stats are per read
+    result.bytesCopied = (stats.bytesCopied - copied) / REPEATS;
+    result.bytesMapped = (stats.bytesMapped - mapped) / REPEATS;
+    return result;
+  }
+
+public:
+  int run() {
+    static const std::pair<const char *, Resource> RESOURCES[] = {
+      { "font", Resource::FONTS_INCONSOLATA_MEDIUM_SDFF },
+      { "floor", Resource::IMAGES_FLOOR_PNG },
+      { "skyXNeg", Resource::IMAGES_SKY_CITY_XNEG_PNG },
+      { "manikin", Resource::MESHES_MANIKIN_CTM },
+      { "rift", Resource::MESHES_RIFT_CTM },
+      { "sphere", Resource::MESHES_SPHERE_CTM },
+      { "horizon", Resource::MESHES_ARTIFICIAL_HORIZON_OBJ },
+    };
+
+    BenchReport report("ORIA_RESOURCE_BENCH_OUTPUT", "resource_access.csv",
+      Platform::format("%-10s %10s %12s %10s %12s %12s %10s\n",
+        "resource", "bytes", "copy copied", "copy ms", "view copied", "view mapped", "view ms"),
+      "resource,bytes,copyBytesCopied,copyMs,viewBytesCopied,viewBytesMapped,viewMs\n");
+    for (const auto & entry : RESOURCES) {
+      Resource resource = entry.second;
+      // The old path: a string, then a stream over a copy of it
+      Result copy = measure([&] {
+        std::string data = Platform::getResourceString(resource);
+        std::stringstream stream;
+        stream.str(data);
+        std::string streamed = stream.str();
+        return sum(streamed.data(), streamed.size());
+      });
+      Result view = measure([&] {
+        ResourceView data = Platform::getResourceView(resource);
+        return sum(data.data(), data.size());
+      });
+      size_t size = Resources::getResourceSize(resource);
+      // The resource stats don't see the two copies the stream makes
+      copy.bytesCopied += 2 * size;
+      report.addRow(
+        Platform::format("%-10s %10d %12d %10.3f %12d %12d %10.3f\n",
+          entry.first, (int)size, (int)copy.bytesCopied, copy.ms,
+          (int)view.bytesCopied, (int)view.bytesMapped, view.ms),
+        Platform::format("%s,%d,%d,%f,%d,%d,%f\n",
+          entry.first, (int)size, (int)copy.bytesCopied, copy.ms,
+          (int)view.bytesCopied, (int)view.bytesMapped, view.ms));
+    }
+    return report.save() ? 0 : -1;
+  }
+};
+
+RUN_APP(ResourceBench);
@@ -69,9 +69,10 @@ class WebcamApp : public RiftApp {
 
 protected:
   
-  TexturePtr texture;
+  StreamingTexture videoTexture;
   ProgramPtr program;
   ShapeWrapperPtr videoGeometry;
+  oria::TextureHandle skybox;
   WebcamHandler captureHandler;
 
 public:
@@ -85,41 +86,46 @@ public:
 
   void initGl() {
     RiftApp::initGl();
-    using namespace oglplus;
-    texture = TexturePtr(new Texture());
-    Context::Bound(TextureTarget::_2D, *texture)
-      .MagFilter(TextureMagFilter::Linear)
-      .MinFilter(TextureMinFilter::Linear);
+    skybox = oria::resolveCubemapTexture(Resource::IMAGES_SKY_CITY_XNEG_PNG);
     program = oria::loadProgram(Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS);
     float aspectRatio = captureHandler.startCapture();
     videoGeometry = oria::loadPlane(program, aspectRatio);
   }
 
+  virtual void shutdownGl() {
+    videoTexture.shutdown();
+    RiftApp::shutdownGl();
+  }
+
   virtual void update() {
     CaptureData captureData;
     if (captureHandler.get(captureData)) {
-      using namespace oglplus;
-      Context::Bound(TextureTarget::_2D, *texture)
-        .Image2D(0, PixelDataInternalFormat::RGBA8, 
-          captureData.image.cols, captureData.image.rows, 0, 
-          PixelDataFormat::BGR, PixelDataType::UnsignedByte, 
-          captureData.image.data);
+      const cv::Mat & image = captureData.image;
+      uvec2 imageSize(image.cols, image.rows);
+      if (!videoTexture.isInitialized() || imageSize != videoTexture.getSize()) {
+        videoTexture.init(imageSize);
+      }
+      if (image.isContinuous()) {
+        videoTexture.upload(image.data, image.total() * image.elemSize());
+      }
     }
   }
 
   virtual void renderScene() {
     using namespace oglplus;
     glClear(GL_DEPTH_BUFFER_BIT);
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
+    oria::renderSkybox(skybox);
     MatrixStack & mv = Stacks::modelview();
     mv.withPush([&]{
       mv.identity();
       // Uncomment to position the frame always in front of you
        // mv.preMultiply(headPose);  
       mv.translate(glm::vec3(0, 0, -2));
-      texture->Bind(TextureTarget::_2D);
-      oria::renderGeometry(videoGeometry, program);
-      oglplus::DefaultTexture().Bind(TextureTarget::_2D);
+      if (videoTexture.isInitialized()) {
+        videoTexture.getTexture()->Bind(TextureTarget::_2D);
+        oria::renderGeometry(videoGeometry, program);
+        oglplus::DefaultTexture().Bind(TextureTarget::_2D);
+      }
     });
   }
 };
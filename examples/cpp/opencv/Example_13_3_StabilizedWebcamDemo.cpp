@@ -13,12 +13,12 @@ class WebcamHandler {
 
 private:
 
-  bool hasFrame{ false };
   bool stopped{ false };
   cv::VideoCapture videoCapture;
   std::thread captureThread;
-  std::mutex mutex;
-  CaptureData frame;
+  TripleBuffer<CaptureData> frames;
+  // Owned by the capture thread and reused every frame
+  cv::Mat raw;
   ovrHmd hmd;
 
 public:
@@ -30,10 +30,13 @@ public:
   float startCapture() {
     videoCapture.open(1);
     if (!videoCapture.isOpened()
-      || !videoCapture.read(frame.image)) {
+      || !videoCapture.read(raw)) {
       FAIL("Could not open video source to capture first frame");
     }
-    float aspectRatio = (float)frame.image.cols / (float)frame.image.rows;
+    float aspectRatio = (float)raw.cols / (float)raw.rows;
+    frames.forEachSlot([&](CaptureData & data) {
+      data.image.create(raw.rows, raw.cols, raw.type());
+    });
     captureThread = std::thread(&WebcamHandler::captureLoop, this);
     return aspectRatio;
   }
@@ -42,34 +45,33 @@ public:
     stopped = true;
     captureThread.join();
     videoCapture.release();
+    SAY("Capture stopped, %lu frames, %lu dropped, %lu duplicated",
+      (unsigned long)frames.getPublishedCount(),
+      (unsigned long)frames.getDroppedCount(),
+      (unsigned long)frames.getDuplicatedCount());
   }
 
-  void set(const CaptureData & newFrame) {
-    std::lock_guard<std::mutex> guard(mutex);
-    frame = newFrame;
-    hasFrame = true;
+  // Returns true if a new frame is available.  The frame returned by
+  // get() stays valid until the next call.
+  bool update() {
+    return frames.fetch();
   }
 
-  bool get(CaptureData & out) {
-    if (!hasFrame) {
-      return false;
-    }
-    std::lock_guard<std::mutex> guard(mutex);
-    out = frame;
-    hasFrame = false;
-    return true;
+  const CaptureData & get() const {
+    return frames.front();
   }
 
   void captureLoop() {
-    CaptureData captured;
     while (!stopped) {
+      CaptureData & captured = frames.back();
       float captureTime = ovr_GetTimeInSeconds();
       ovrTrackingState tracking = ovrHmd_GetTrackingState(hmd, captureTime);
       captured.pose = tracking.HeadPose.ThePose;
 
-      videoCapture.read(captured.image);
-      cv::flip(captured.image.clone(), captured.image, 0);
-      set(captured);
+      videoCapture.read(raw);
+      // Flipping into the preallocated slot avoids cloning the source
+      cv::flip(raw, captured.image, 0);
+      frames.publish();
     }
   }
 };
@@ -78,11 +80,11 @@ class WebcamApp : public RiftApp {
 
 protected:
 
-  TexturePtr texture;
+  StreamingTexture videoTexture;
   ProgramPtr program;
   ShapeWrapperPtr videoGeometry;
+  oria::TextureHandle skybox;
   WebcamHandler captureHandler;
-  CaptureData captureData;
 
 public:
 
@@ -95,35 +97,39 @@ public:
 
   void initGl() {
     RiftApp::initGl();
-    using namespace oglplus;
-    texture = TexturePtr(new Texture());
-    Context::Bound(TextureTarget::_2D, *texture)
-      .MagFilter(TextureMagFilter::Linear)
-      .MinFilter(TextureMinFilter::Linear);
+    skybox = oria::resolveCubemapTexture(Resource::IMAGES_SKY_CITY_XNEG_PNG);
     program = oria::loadProgram(Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS);
     float aspectRatio = captureHandler.startCapture();
     videoGeometry = oria::loadPlane(program, aspectRatio);
   }
 
+  virtual void shutdownGl() {
+    videoTexture.shutdown();
+    RiftApp::shutdownGl();
+  }
+
   virtual void update() {
-    if (captureHandler.get(captureData)) {
-      using namespace oglplus;
-      Context::Bound(TextureTarget::_2D, *texture)
-        .Image2D(0, PixelDataInternalFormat::RGBA8,
-        captureData.image.cols, captureData.image.rows, 0,
-        PixelDataFormat::BGR, PixelDataType::UnsignedByte,
-        captureData.image.data);
+    if (captureHandler.update()) {
+      const CaptureData & captureData = captureHandler.get();
+      const cv::Mat & image = captureData.image;
+      uvec2 imageSize(image.cols, image.rows);
+      if (!videoTexture.isInitialized() || imageSize != videoTexture.getSize()) {
+        videoTexture.init(imageSize);
+      }
+      if (image.isContinuous()) {
+        videoTexture.upload(image.data, image.total() * image.elemSize());
+      }
     }
   }
 
   virtual void renderScene() {
     glClear(GL_DEPTH_BUFFER_BIT);
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
+    oria::renderSkybox(skybox);
     MatrixStack & mv = Stacks::modelview();
 
     mv.withPush([&] {
       glm::quat eyePose = ovr::toGlm(getEyePose().Orientation);
-      glm::quat webcamPose = ovr::toGlm(captureData.pose.Orientation);
+      glm::quat webcamPose = ovr::toGlm(captureHandler.get().pose.Orientation);
       glm::mat4 webcamDelta = glm::mat4_cast(glm::inverse(eyePose) * webcamPose);
 
       mv.identity();
@@ -131,9 +137,11 @@ public:
 
       mv.translate(glm::vec3(0, 0, -2));
       using namespace oglplus;
-      texture->Bind(TextureTarget::_2D);
-      oria::renderGeometry(videoGeometry, program);
-      oglplus::DefaultTexture().Bind(TextureTarget::_2D);
+      if (videoTexture.isInitialized()) {
+        videoTexture.getTexture()->Bind(TextureTarget::_2D);
+        oria::renderGeometry(videoGeometry, program);
+        oglplus::DefaultTexture().Bind(TextureTarget::_2D);
+      }
     });
   }
 };
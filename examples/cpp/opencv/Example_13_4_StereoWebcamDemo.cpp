@@ -15,12 +15,12 @@ class WebcamHandler {
 
 private:
 
-  bool hasFrame{ false };
   bool stopped{ false };
   cv::VideoCapture videoCapture;
   std::thread captureThread;
-  std::mutex mutex;
-  CaptureData frame;
+  TripleBuffer<CaptureData> frames;
+  // Owned by the capture thread and reused every frame
+  cv::Mat raw;
   ovrHmd hmd;
 
 public:
@@ -35,13 +35,16 @@ public:
     if (!videoCapture.isOpened()) {
       FAIL("Could not open video source from webcam %i", which);
     }
-    for (int i = 0; i < 10 && !videoCapture.read(frame.image); i++) {
+    for (int i = 0; i < 10 && !videoCapture.read(raw); i++) {
       Platform::sleepMillis(10);
     }
-    if (!videoCapture.read(frame.image)) {
+    if (!videoCapture.read(raw)) {
       FAIL("Could not open get first frame from webcam %i", which);
     }
-    float aspectRatio = (float)frame.image.cols / (float)frame.image.rows;
+    float aspectRatio = (float)raw.cols / (float)raw.rows;
+    frames.forEachSlot([&](CaptureData & data) {
+      data.image.create(raw.rows, raw.cols, raw.type());
+    });
     captureThread = std::thread(&WebcamHandler::captureLoop, this);
 
     // Snooze for 200 ms to get past multithreading issues in OpenCV
@@ -53,34 +56,33 @@ public:
     stopped = true;
     captureThread.join();
     videoCapture.release();
+    SAY("Capture stopped, %lu frames, %lu dropped, %lu duplicated",
+      (unsigned long)frames.getPublishedCount(),
+      (unsigned long)frames.getDroppedCount(),
+      (unsigned long)frames.getDuplicatedCount());
   }
 
-  void set(const CaptureData & newFrame) {
-    std::lock_guard<std::mutex> guard(mutex);
-    frame = newFrame;
-    hasFrame = true;
+  // Returns true if a new frame is available.  The frame returned by
+  // get() stays valid until the next call.
+  bool update() {
+    return frames.fetch();
   }
 
-  bool get(CaptureData & out) {
-    if (!hasFrame) {
-      return false;
-    }
-    std::lock_guard<std::mutex> guard(mutex);
-    out = frame;
-    hasFrame = false;
-    return true;
+  const CaptureData & get() const {
+    return frames.front();
   }
 
   void captureLoop() {
-    CaptureData captured;
     while (!stopped) {
+      CaptureData & captured = frames.back();
       float captureTime = ovr_GetTimeInSeconds();
       ovrTrackingState tracking = ovrHmd_GetTrackingState(hmd, captureTime);
       captured.pose = tracking.HeadPose.ThePose;
 
-      videoCapture.read(captured.image);
-      cv::flip(captured.image.clone(), captured.image, 0);
-      set(captured);
+      videoCapture.read(raw);
+      // Flipping into the preallocated slot avoids cloning the source
+      cv::flip(raw, captured.image, 0);
+      frames.publish();
     }
   }
 };
@@ -90,10 +92,10 @@ class WebcamApp : public RiftApp {
 protected:
 
   ProgramPtr program;
-  TexturePtr texture[2];
+  StreamingTexture videoTexture[2];
   ShapeWrapperPtr videoGeometry[2];
+  oria::TextureHandle skybox;
   WebcamHandler captureHandler[2];
-  CaptureData captureData[2];
 
 public:
 
@@ -108,30 +110,37 @@ public:
 
   void initGl() {
     RiftApp::initGl();
+    skybox = oria::resolveCubemapTexture(Resource::IMAGES_SKY_CITY_XNEG_PNG);
     using namespace oglplus;
 
     program = oria::loadProgram(Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS);
 
     for (int i = 0; i < 2; i++) {
-      texture[i] = TexturePtr(new Texture());
-      Context::Bound(TextureTarget::_2D, *texture[i])
-        .MagFilter(TextureMagFilter::Linear)
-        .MinFilter(TextureMinFilter::Linear);
       program = oria::loadProgram(Resource::SHADERS_TEXTURED_VS, Resource::SHADERS_TEXTURED_FS);
       float aspect = captureHandler[i].startCapture(hmd, CAMERA_FOR_EYE[i]);
       videoGeometry[i] = oria::loadPlane(program, aspect);
     }
   }
 
+  virtual void shutdownGl() {
+    for (int i = 0; i < 2; i++) {
+      videoTexture[i].shutdown();
+    }
+    RiftApp::shutdownGl();
+  }
+
   virtual void update() {
     for (int i = 0; i < 2; i++) {
-      if (captureHandler[i].get(captureData[i])) {
-        using namespace oglplus;
-        Context::Bound(TextureTarget::_2D, *texture[i])
-          .Image2D(0, PixelDataInternalFormat::RGBA8,
-          captureData[i].image.cols, captureData[i].image.rows, 0,
-          PixelDataFormat::BGR, PixelDataType::UnsignedByte,
-          captureData[i].image.data);
+      if (captureHandler[i].update()) {
+        const CaptureData & captureData = captureHandler[i].get();
+        const cv::Mat & image = captureData.image;
+        uvec2 imageSize(image.cols, image.rows);
+        if (!videoTexture[i].isInitialized() || imageSize != videoTexture[i].getSize()) {
+          videoTexture[i].init(imageSize);
+        }
+        if (image.isContinuous()) {
+          videoTexture[i].upload(image.data, image.total() * image.elemSize());
+        }
       }
     }
   }
@@ -139,20 +148,23 @@ public:
   virtual void renderScene() {
     using namespace oglplus;
     glClear(GL_DEPTH_BUFFER_BIT);
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
+    oria::renderSkybox(skybox);
     MatrixStack & mv = Stacks::modelview();
 
     mv.withPush([&] {
       glm::quat eyePose = ovr::toGlm(getEyePose().Orientation);
-      glm::quat webcamPose = ovr::toGlm(captureData[getCurrentEye()].pose.Orientation);
+      glm::quat webcamPose = ovr::toGlm(captureHandler[getCurrentEye()].get().pose.Orientation);
       glm::mat4 webcamDelta = glm::mat4_cast(glm::inverse(eyePose) * webcamPose);
 
       mv.identity();
       mv.preMultiply(webcamDelta);
 
       mv.translate(glm::vec3(0, 0, -2.75));
-      texture[getCurrentEye()]->Bind(TextureTarget::_2D); 
-      oria::renderGeometry(videoGeometry[getCurrentEye()], program);
+      StreamingTexture & eyeTexture = videoTexture[getCurrentEye()];
+      if (eyeTexture.isInitialized()) {
+        eyeTexture.getTexture()->Bind(TextureTarget::_2D);
+        oria::renderGeometry(videoGeometry[getCurrentEye()], program);
+      }
     });
     oglplus::DefaultTexture().Bind(TextureTarget::_2D);
   }
@@ -86,6 +86,7 @@ protected:
   LeapHandler     captureHandler;
   ShapeWrapperPtr sphere;
   ProgramPtr      program;
+  oria::TextureHandle skybox;
 
   CaptureData latestFrame;
   glm::vec3 ballCenter;
@@ -103,6 +104,7 @@ public:
 
   void initGl() {
     RiftApp::initGl();
+    skybox = oria::resolveCubemapTexture(Resource::IMAGES_SKY_CITY_XNEG_PNG);
     program = oria::loadProgram(Resource::SHADERS_LIT_VS, Resource::SHADERS_LITCOLORED_FS);
     sphere = oria::loadSphere({"Position", "Normal"}, program);
     oria::bindLights(program);
@@ -132,7 +134,7 @@ public:
 
   virtual void renderScene() {
     glClear(GL_DEPTH_BUFFER_BIT);
-    oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
+    oria::renderSkybox(skybox);
     MatrixStack & mv = Stacks::modelview();
 
     mv.withPush([&]{
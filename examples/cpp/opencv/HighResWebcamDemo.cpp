@@ -18,19 +18,18 @@
 template <class T>
 class CaptureHandler {
 private:
-  typedef std::lock_guard<std::mutex> lock_guard;
-
   std::thread captureThread;
-  std::mutex mutex;
 
-  bool changed{ false };
   bool stop{ false };
 
-  float firstCapture{ -1 };
-  int captures{ -1 };
-  float cps{ -1 };
+  // Written by the capture thread
+  std::atomic<int> captures{ 0 };
+  // Owned by the thread calling getCapturesPerSecond()
+  double windowStart{ -1 };
+  int windowCaptures{ 0 };
+  float cps{ 0 };
 
-  T result;
+  TripleBuffer<T> frames;
 
 protected:
 
@@ -38,31 +37,49 @@ protected:
     return stop;
   }
 
-  void setResult(const T & newResult) {
-    if (0 == ++captures) {
-      firstCapture = Platform::elapsedSeconds();
-    }
-    lock_guard guard(mutex);
-    result = newResult;
-    changed = true;
+  // The slot the capture thread should fill in.  Its buffers are reused
+  // from earlier frames, so write into them rather than replacing them.
+  T & backBuffer() {
+    return frames.back();
+  }
+
+  template <typename F>
+  void forEachBuffer(F f) {
+    frames.forEachSlot(f);
+  }
+
+  void publishResult() {
+    ++captures;
+    frames.publish();
   }
 
 public:
 
+  // Averaged over windows of two seconds
   float getCapturesPerSecond() {
-    if (-1 == captures) {
+    double now = Platform::elapsedSeconds();
+    int total = captures;
+    if (windowStart < 0) {
+      windowStart = now;
+      windowCaptures = total;
       return 0;
     }
 
-    float elapsed = Platform::elapsedSeconds() - firstCapture;
-    if (elapsed > 2.0f) {
-      cps = (float)captures / elapsed;
-      captures = -1;
+    double elapsed = now - windowStart;
+    if (elapsed >= 2.0) {
+      cps = (float)((total - windowCaptures) / elapsed);
+      windowStart = now;
+      windowCaptures = total;
     }
-    if (cps > 0) {
-      return cps;
-    }
-    return (float)captures / elapsed;
+    return cps;
+  }
+
+  size_t getDroppedFrames() const {
+    return frames.getDroppedCount();
+  }
+
+  size_t getDuplicatedFrames() const {
+    return frames.getDuplicatedCount();
   }
 
   void startCapture() {
@@ -73,17 +90,20 @@ public:
   void stopCapture() {
     stop = true;
     captureThread.join();
+    SAY("Capture stopped, %lu frames, %lu dropped, %lu duplicated",
+      (unsigned long)frames.getPublishedCount(),
+      (unsigned long)frames.getDroppedCount(),
+      (unsigned long)frames.getDuplicatedCount());
   }
 
-  bool getResult(T & outResult) {
-    if (!changed) {
-      return false;
-    }
-    lock_guard guard(mutex);
-    changed = false;
-    outResult = result;
-    result = T();
-    return true;
+  // Returns true if a new result is available.  The result stays valid
+  // until the next call.
+  bool updateResult() {
+    return frames.fetch();
+  }
+
+  const T & getResult() const {
+    return frames.front();
   }
 
   virtual void captureLoop() = 0;
@@ -100,6 +120,9 @@ private:
   ovrHmd hmd;
   cv::Mat distortionMap;
   bool hasCalibration{ false };
+  // Scratch images, owned by the capture thread and reused every frame
+  cv::Mat raw;
+  cv::Mat undistorted;
 
 public:
 
@@ -131,28 +154,37 @@ public:
     videoCapture.set(CV_CAP_PROP_FRAME_WIDTH, CAMERA_WIDTH);
     videoCapture.set(CV_CAP_PROP_FRAME_HEIGHT, CAMERA_HEIGHT);
     videoCapture.set(CV_CAP_PROP_FPS, 60);
+
+    forEachBuffer([](CaptureData & data) {
+      data.image.create(CAMERA_HEIGHT, CAMERA_WIDTH, CV_8UC3);
+    });
   }
   
   virtual void captureLoop() {
+    Trace::setThreadName("capture");
     while (!isStopped()) {
-      CaptureData captured;
-      float captureTime = 
+      TRACE_SCOPE("captureFrame");
+      CaptureData & captured = backBuffer();
+      double captureTime = 
         ovr_GetTimeInSeconds() - CAMERA_LATENCY;
       ovrTrackingState tracking = 
         ovrHmd_GetTrackingState(hmd, captureTime);
       captured.pose = tracking.HeadPose.ThePose;
 
       if (!videoCapture.grab() ||
-          !videoCapture.retrieve(captured.image)) {
+          !videoCapture.retrieve(raw)) {
         FAIL("Failed video capture");
       }
 
+      // Every step writes into a different, already allocated image, so
+      // there's no need to clone the source
       if (hasCalibration) {
-        remap(captured.image.clone(), captured.image, distortionMap, cv::Mat(), cv::INTER_LINEAR);
+        remap(raw, undistorted, distortionMap, cv::Mat(), cv::INTER_LINEAR);
+        cv::flip(undistorted, captured.image, 0);
+      } else {
+        cv::flip(raw, captured.image, 0);
       }
-
-      cv::flip(captured.image.clone(), captured.image, 0);
-      setResult(captured);
+      publishResult();
     }
   }
 };
@@ -161,11 +193,11 @@ class WebcamApp : public RiftApp
 {
 protected:
   WebcamCaptureHandler captureHandler;
-  CaptureData captureData;
 
-  TexturePtr texture;
+  StreamingTexture videoTexture;
   ShapeWrapperPtr videoGeometry;
   ProgramPtr videoRenderProgram;
+  oria::TextureHandle skybox;
 
 public:
 
@@ -179,6 +211,7 @@ public:
 
 void initGl() {
   RiftApp::initGl();
+  skybox = oria::resolveCubemapTexture(Resource::IMAGES_SKY_CITY_XNEG_PNG);
   glEnable(GL_PRIMITIVE_RESTART);
   glPrimitiveRestartIndex(UINT_MAX);
   glEnable(GL_BLEND);
@@ -188,52 +221,60 @@ void initGl() {
     Resource::SHADERS_TEXTURED_VS,
     Resource::SHADERS_TEXTURED_FS);
 
-  using namespace oglplus;
-  texture = TexturePtr(new Texture());
-  Context::Bound(TextureTarget::_2D, *texture)
-    .MagFilter(TextureMagFilter::Linear)
-    .MinFilter(TextureMinFilter::Linear);
-  DefaultTexture().Bind(TextureTarget::_2D);
-
+  videoTexture.init(uvec2(CAMERA_WIDTH, CAMERA_HEIGHT));
   videoGeometry = oria::loadPlane(videoRenderProgram, CAMERA_ASPECT);
 }
 
+virtual void shutdownGl() {
+  videoTexture.shutdown();
+  RiftApp::shutdownGl();
+}
+
 virtual void update() {
-  if (captureHandler.getResult(captureData)) {
-    using namespace oglplus;
-    Context::Bound(TextureTarget::_2D, *texture)
-      .Image2D(0, PixelDataInternalFormat::RGBA8,
-             captureData.image.cols, captureData.image.rows, 0,
-             PixelDataFormat::BGR, PixelDataType::UnsignedByte,
-             captureData.image.data);
-    DefaultTexture().Bind(TextureTarget::_2D);
+  if (captureHandler.updateResult()) {
+    // Cameras don't always honor the requested resolution
+    const cv::Mat & image = captureHandler.getResult().image;
+    uvec2 imageSize(image.cols, image.rows);
+    if (imageSize != videoTexture.getSize()) {
+      videoTexture.init(imageSize);
+    }
+    if (image.isContinuous()) {
+      videoTexture.upload(image.data, image.total() * image.elemSize());
+    }
   }
 }
 
 virtual void renderScene() {
   glClear(GL_DEPTH_BUFFER_BIT);
-  oria::renderSkybox(Resource::IMAGES_SKY_CITY_XNEG_PNG);
+  oria::renderSkybox(skybox);
   MatrixStack & mv = Stacks::modelview();
 
   mv.withPush([&]{
     mv.identity();
 
     glm::quat eyePose = ovr::toGlm(getEyePose().Orientation);
-    glm::quat webcamPose = ovr::toGlm(captureData.pose.Orientation);
+    glm::quat webcamPose = ovr::toGlm(captureHandler.getResult().pose.Orientation);
     glm::mat4 webcamDelta = glm::mat4_cast(glm::inverse(eyePose) * webcamPose);
 
     mv.preMultiply(webcamDelta);
     mv.translate(glm::vec3(0, 0, -IMAGE_DISTANCE));
 
-    texture->Bind(oglplus::Texture::Target::_2D);
+    videoTexture.getTexture()->Bind(oglplus::Texture::Target::_2D);
     oria::renderGeometry(videoGeometry, videoRenderProgram);
     oglplus::DefaultTexture().Bind(oglplus::Texture::Target::_2D);
   });
 
   std::string message = Platform::format(
     "OpenGL FPS: %0.2f\n"
-    "Vidcap FPS: %0.2f\n",
-    fps, captureHandler.getCapturesPerSecond());
+    "Vidcap FPS: %0.2f\n"
+    "Dropped: %lu\n"
+    "Duplicated: %lu\n"
+    "Upload: %0.2f ms (max %0.2f ms)\n",
+    fps, captureHandler.getCapturesPerSecond(),
+    (unsigned long)captureHandler.getDroppedFrames(),
+    (unsigned long)captureHandler.getDuplicatedFrames(),
+    videoTexture.getStats().averageLatencyMs,
+    videoTexture.getStats().maxLatencyMs);
   GlfwApp::renderStringAt(message, glm::vec2(-0.5f, 0.5f));
 }
 };
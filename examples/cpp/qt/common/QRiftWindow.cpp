@@ -61,6 +61,30 @@ QRiftWindow::QRiftWindow() {
   m_context->create();
 
   renderThread.setLambda([&] { renderLoop(); });
+
+  // The GUI thread is the JobSystem's main thread, and the render thread
+  // its GL thread
+  JobSystem::get().setMainThread();
+  connect(&mainThreadJobTimer, &QTimer::timeout, [] {
+    JobSystem::get().runMainThreadJobs();
+  });
+  mainThreadJobTimer.start(5);
+
+  const char * budget = getenv("ORIA_TASK_BUDGET_MS");
+  if (budget) {
+    taskBudgetMs = std::max(0.0f, (float)atof(budget));
+  }
+
+#ifdef USE_RIFT
+  if (HeadlessBenchmark::get()) {
+    // Nothing is shown, the eye textures are all that's rendered
+    offscreenSurface = new QOffscreenSurface();
+    offscreenSurface->setFormat(format);
+    offscreenSurface->create();
+    return;
+  }
+#endif
+
   bool directHmdMode = false;
 
 #ifdef USE_RIFT
@@ -103,6 +127,7 @@ QRiftWindow::QRiftWindow() {
 
 QRiftWindow::~QRiftWindow() {
   stop();
+  delete offscreenSurface;
 }
 
 void QRiftWindow::start() {
@@ -118,14 +143,10 @@ void QRiftWindow::stop() {
     shuttingDown = true;
     renderThread.exit();
     renderThread.wait();
-    m_context->makeCurrent(this);
+    makeCurrent();
   }
 }
 
-void QRiftWindow::queueRenderThreadTask(Lambda task) {
-  tasks.queueTask(task);
-}
-
 
 void QRiftWindow::drawFrame() {
 #ifdef USE_RIFT
@@ -144,15 +165,24 @@ void QRiftWindow::drawFrame() {
 }
 
 void QRiftWindow::renderLoop() {
-  m_context->makeCurrent(this);
+  Trace::setThreadName("render");
+  JobSystem & jobs = JobSystem::get();
+  jobs.setGlThread();
+  makeCurrent();
   setup();
 
   while (!shuttingDown) {
     if (QCoreApplication::hasPendingEvents())
       QCoreApplication::processEvents();
-    tasks.drainTaskQueue();
+    tasks.drainTaskQueue(taskBudgetMs);
+#ifdef USE_RIFT
+    TaskQueueWrapper::Stats taskStats = tasks.getStats();
+    frameTiming.recordTaskQueue(taskStats.lastDrainMs, taskStats.depth);
+#endif
+    jobs.runGlThreadJobs();
 
-    m_context->makeCurrent(this);
+    makeCurrent();
+    TRACE_SCOPE("frame");
     drawFrame();
 #ifndef USE_RIFT
     m_context->swapBuffers(this);
@@ -170,7 +200,7 @@ void QRiftWindow::renderLoop() {
 }
 
 void QRiftWindow::setup() {
-  m_context->makeCurrent(this);
+  makeCurrent();
   glewExperimental = true;
   glewInit();
 
@@ -192,6 +222,12 @@ void QRiftWindow::setup() {
 #endif
 }
 
+#ifdef USE_RIFT
+void QRiftWindow::headlessFinished() {
+  QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+}
+#endif
+
 //#include "QRiftWindow.moc"
 
 #endif
@@ -30,7 +30,14 @@ class QRiftWindow :
   bool shuttingDown{ false };
   LambdaThread renderThread;
   TaskQueueWrapper tasks;
+  // Time per frame for running queued tasks, anything left over waits for
+  // the next frame.  Zero runs everything.  Set with ORIA_TASK_BUDGET_MS
+  float taskBudgetMs{ 2.0f };
   QOpenGLContext * m_context;
+  // Runs the JobSystem's main thread jobs on the GUI thread
+  QTimer mainThreadJobTimer;
+  // Rendered to in place of the window by headless runs
+  QOffscreenSurface * offscreenSurface{ nullptr };
 
 protected:
   float texRes{ 1.0f };
@@ -45,8 +52,12 @@ public:
     return m_context;
   }
 
+  QSurface * renderSurface() {
+    return offscreenSurface ? (QSurface *)offscreenSurface : (QSurface *)this;
+  }
+
   void makeCurrent() {
-    m_context->makeCurrent(this);
+    m_context->makeCurrent(renderSurface());
   }
 
   void start();
@@ -54,7 +65,11 @@ public:
   // Should only be called from the primary thread
   virtual void stop();
 
-  void queueRenderThreadTask(Lambda task);
+  // Safe to call from any thread
+  template <typename F>
+  void queueRenderThreadTask(F && task) {
+    tasks.queueTask(std::forward<F>(task));
+  }
 
   void * getNativeWindow() {
     return (void*)winId();
@@ -68,6 +83,10 @@ private:
 protected:
   virtual void setup();
 
+#ifdef USE_RIFT
+  virtual void headlessFinished();
+#endif
+
 #ifndef USE_RIFT
   virtual void updateFps(float fps) {
   }
@@ -81,6 +81,7 @@ MainWindow::MainWindow() {
     // with the UI thread binding a new FBO (specifically, generating a texture
     // for the FBO.
     // Perhaps I should just create N FBOs and have the UI object iterate over them
+    Trace::setThreadName("ui");
     {
         QString configLocation = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
         configPath = QDir(configLocation);
@@ -139,7 +140,8 @@ void MainWindow::setup() {
     uiFramebuffer->init(UI_SIZE);
 
     shaderFramebuffer = FramebufferWrapperPtr(new FramebufferWrapper());
-    shaderFramebuffer->init(textureSize());
+    // With a stencil, so the hidden area mask can cull the shader itself
+    shaderFramebuffer->init(textureSize(), true);
 
     DefaultFramebuffer().Bind(Framebuffer::Target::Draw);
 }
@@ -152,10 +154,16 @@ void MainWindow::setupOffscreenUi() {
     uiWindow->pause();
     uiWindow->setup(QSize(UI_SIZE.x, UI_SIZE.y), context());
     {
+        // Parsing every preset just for its name adds up, so fan it out
+        std::vector<QString> names(PRESETS.size());
+        JobSystem::get().parallelFor(names.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                names[i] = shadertoy::loadShaderFile(PRESETS.at((int)i)).name;
+            }
+        });
         QStringList dataList;
-        foreach(const QString path, PRESETS) {
-            shadertoy::Shader shader = shadertoy::loadShaderFile(path);
-            dataList.append(shader.name);
+        foreach(const QString & name, names) {
+            dataList.append(name);
         }
         auto qmlContext = uiWindow->m_qmlEngine->rootContext();
         qmlContext->setContextProperty("presetsModel", QVariant::fromValue(dataList));
@@ -524,6 +532,42 @@ bool MainWindow::event(QEvent * e) {
       if (oria::clearHSW(hmd)) {
         return true;
       }
+      switch (((QKeyEvent*)e)->key()) {
+      case Qt::Key_F3:
+        queueRenderThreadTask([&] {
+          showTimingOverlay = !showTimingOverlay;
+        });
+        return true;
+
+      case Qt::Key_F4: {
+        std::string basePath = configPath.absoluteFilePath(
+          "timing_" + QDateTime::currentDateTime().toString("yyyy.MM.dd_hh.mm.ss")).toStdString();
+        queueRenderThreadTask([&, basePath] {
+          exportTiming(basePath);
+          SAY("Frame timing written to %s.csv/.json", basePath.c_str());
+        });
+        return true;
+      }
+
+      case Qt::Key_F5:
+        if (!Trace::isRecording()) {
+          Trace::start();
+          SAY("Trace recording started");
+        } else {
+          Trace::stop();
+          std::string path = configPath.absoluteFilePath(
+            "trace_" + QDateTime::currentDateTime().toString("yyyy.MM.dd_hh.mm.ss") + ".json").toStdString();
+          Trace::save(path);
+          SAY("Trace written to %s", path.c_str());
+        }
+        return true;
+
+      case Qt::Key_F7:
+        queueRenderThreadTask([&] {
+          toggleHiddenAreaMask();
+        });
+        return true;
+      }
     }
 #endif
     if (uiWindow) {
@@ -544,6 +588,7 @@ void MainWindow::resizeEvent(QResizeEvent *e) {
 // Rendering functionality
 //
 void MainWindow::perFrameRender() {
+    renderer.updateTextures();
     Context::Enable(Capability::Blend);
     Context::BlendFunc(BlendFunction::SrcAlpha, BlendFunction::OneMinusSrcAlpha);
     Context::Disable(Capability::ScissorTest);
@@ -616,9 +661,22 @@ void MainWindow::perEyeRender() {
         oria::viewport(renderSize());
         renderer.setResolution(renderSize());
 #ifdef USE_RIFT
+        // The expensive pass is this one, not the copy into the eye buffer,
+        // so the mask is moved from the eye buffer to here.  Only the VR
+        // effects are stretched over the whole eye, as the mask assumes.
+        endHiddenAreaMask();
+        if (activeShader.vrEnabled) {
+            ovrRecti viewport;
+            viewport.Pos.x = viewport.Pos.y = 0;
+            viewport.Size = ovr::fromGlm(renderSize());
+            beginHiddenAreaMask(viewport);
+        }
         renderer.setPosition(ovr::toGlm(getEyePose().Position) * eyeOffsetScale);
 #endif
         renderer.render();
+#ifdef USE_RIFT
+        endHiddenAreaMask();
+#endif
     });
     oria::viewport(textureSize());
 
@@ -32,6 +32,7 @@ void Renderer::setup(QOpenGLContext * context) {
     skybox = oria::loadSkybox(shadertoyProgram);
 
     Platform::addShutdownHook([&] {
+        textureLoader.shutdownGl();
         textureCache.clear();
         shadertoyProgram.reset();
         vertexShader.reset();
@@ -48,8 +49,11 @@ void Renderer::initTextureCache() {
         QString path = TEXTURES.at(i);
         QString fileName = path.split("/").back();
         qDebug() << "Loading texture from " << path;
-        TextureData & cacheEntry = textureCache[path];
-        cacheEntry.tex = oria::load2dTexture(readFileToVector(":" + path), cacheEntry.size);
+        textureCache[path].tex = textureLoader.load2dTexture([=] {
+            return readFileToVector(":" + path);
+        }, [=](const uvec2 & size) {
+            onTextureLoaded(path, size);
+        });
         canonicalPathMap["qrc:" + path] = path;
 
         // Backward compatibility
@@ -71,15 +75,11 @@ void Renderer::initTextureCache() {
         QString path = pathTemplate.arg(0);
         QString fileName = path.split("/").back();
         qDebug() << "Processing path " << path;
-        TextureData & cacheEntry = textureCache[path];
-        cacheEntry.tex = oria::loadCubemapTexture([&](int i) {
-            QString texturePath = pathTemplate.arg(i);
-            ImagePtr image = oria::loadImage(readFileToVector(":" + texturePath), false);
-            if (image) {
-                cacheEntry.size = uvec2(image->Width(), image->Height());
-            }
-            return image;
-        });
+        textureCache[path].tex = textureLoader.loadCubemapTexture([=](int i) {
+            return readFileToVector(":" + pathTemplate.arg(i));
+        }, [=](const uvec2 & size) {
+            onTextureLoaded(path, size);
+        }, false);
         canonicalPathMap["qrc:" + path] = path;
 
         // Backward compatibility
@@ -100,6 +100,26 @@ void Renderer::initTextureCache() {
     });
 }
 
+void Renderer::onTextureLoaded(const QString & path, const uvec2 & size) {
+    textureCache[path].size = size;
+    // Channels bound to the placeholder need their resolution updated
+    bool channelsChanged = false;
+    for (int i = 0; i < 4; ++i) {
+        if (channels[i].texture && canonicalTexturePath(channelSources[i]) == path) {
+            channels[i].resolution = (channels[i].target == Texture::Target::CubeMap) ?
+                vec3(size.x) : vec3(size, 0);
+            channelsChanged = true;
+        }
+    }
+    if (channelsChanged && shadertoyProgram) {
+        updateUniforms();
+    }
+}
+
+void Renderer::updateTextures() {
+    textureLoader.update();
+}
+
 void Renderer::render() {
     Context::Clear().ColorBuffer();
     if (!shadertoyProgram) {
@@ -141,7 +161,7 @@ void Renderer::updateUniforms() {
     uniformLambdas.clear();
     if (activeUniforms.count(UNIFORM_GLOBALTIME)) {
         uniformLambdas.push_back([&] {
-            Uniform<GLfloat>(*shadertoyProgram, UNIFORM_GLOBALTIME).Set(Platform::elapsedSeconds() - startTime);
+            Uniform<GLfloat>(*shadertoyProgram, UNIFORM_GLOBALTIME).Set((float)(Platform::elapsedSeconds() - startTime));
         });
     }
 
@@ -202,7 +222,7 @@ bool Renderer::setShaderSourceInternal(QString source) {
         StrCRef src(fragmentSource);
         newFragmentShader->Source(GLSLSource(src));
         newFragmentShader->Compile();
-        ProgramPtr result(new Program());
+        ProgramPtr result = oria::newProgram();
         result->AttachShader(*vertexShader);
         result->AttachShader(*newFragmentShader);
 
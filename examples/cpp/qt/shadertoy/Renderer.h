@@ -36,6 +36,8 @@ protected:
     typedef std::map<QString, QString> CanonicalPathMap;
     CanonicalPathMap canonicalPathMap;
     TextureMap textureCache;
+    // Decodes and uploads the preset textures without blocking the render loop
+    TextureLoader textureLoader;
 
     QOpenGLContext * context;
 
@@ -54,7 +56,7 @@ protected:
     // Contains the current 'camera position'
     vec3 position;
     // The amount of time since we started running
-    float startTime{ 0.0f };
+    double startTime{ 0 };
 
     // The current fragment source
     LambdaList uniformLambdas;
@@ -69,10 +71,13 @@ protected:
     ProgramPtr shadertoyProgram;
 
     void initTextureCache();
+    void onTextureLoaded(const QString & path, const uvec2 & size);
 
 public:
     void setup(QOpenGLContext * context);
     void render();
+    // Perform any pending texture uploads, within a per-frame budget
+    void updateTextures();
     void updateUniforms();
 
     void restart() {
@@ -30,6 +30,10 @@ limitations under the License.
 #include <QtNetwork>
 #include <QDeclarativeEngine>
 
+#ifdef HAVE_OPENCV
+#include <opencv2/opencv.hpp>
+#endif
+
 const char * ORG_NAME = "Oculus Rift in Action";
 const char * ORG_DOMAIN = "oculusriftinaction.com";
 const char * APP_NAME = "VideoVR";
@@ -103,6 +107,82 @@ class MainWindow : public QRiftWindow {
     ProgramPtr planeProgram;
     ShapeWrapperPtr plane;
 
+    // Camera frames are handed from the capture thread through a triple
+    // buffer and streamed into a fixed size texture
+    StreamingTexture videoTexture;
+#ifdef HAVE_OPENCV
+    cv::VideoCapture videoCapture;
+    std::thread captureThread;
+    std::atomic<bool> capturing{ false };
+    TripleBuffer<cv::Mat> videoFrames;
+
+    void captureLoop() {
+        // A camera that fails or is unplugged keeps failing immediately, so
+        // back off between retries, and give up after about ten seconds
+        static const int MAX_RETRY_DELAY_MS = 500;
+        static const int MAX_FAILED_MS = 10000;
+        cv::Mat raw;
+        int retryDelayMs = 0;
+        int failedMs = 0;
+        while (capturing) {
+            if (!videoCapture.read(raw)) {
+                if (failedMs >= MAX_FAILED_MS) {
+                    qWarning() << "Video source stopped delivering frames, giving up";
+                    return;
+                }
+                retryDelayMs = std::min(std::max(retryDelayMs * 2, 10), MAX_RETRY_DELAY_MS);
+                failedMs += retryDelayMs;
+                Platform::sleepMillis(retryDelayMs);
+                continue;
+            }
+            retryDelayMs = 0;
+            failedMs = 0;
+            // Flip into the reused slot rather than cloning the frame
+            cv::flip(raw, videoFrames.back(), 0);
+            videoFrames.publish();
+        }
+    }
+
+    void startCapture() {
+        videoCapture.open(0);
+        if (!videoCapture.isOpened()) {
+            qWarning() << "Could not open video source";
+            return;
+        }
+        capturing = true;
+        captureThread = std::thread([&] {
+            Platform::setThreadPriority(Platform::LOW);
+            captureLoop();
+        });
+    }
+
+    void stopCapture() {
+        if (capturing) {
+            capturing = false;
+            captureThread.join();
+            videoCapture.release();
+        }
+    }
+
+    void updateVideoTexture() {
+        if (!videoFrames.fetch()) {
+            return;
+        }
+        const cv::Mat & frame = videoFrames.front();
+        uvec2 frameSize(frame.cols, frame.rows);
+        if (!videoTexture.isInitialized() || frameSize != videoTexture.getSize()) {
+            videoTexture.init(frameSize);
+        }
+        if (frame.isContinuous()) {
+            videoTexture.upload(frame.data, frame.total() * frame.elemSize());
+        }
+    }
+#else
+    void startCapture() {}
+    void stopCapture() {}
+    void updateVideoTexture() {}
+#endif
+
     // Measure the FPS for use in dynamic scaling
     GLuint exchangeUiTexture(GLuint newUiTexture) {
         return uiTexture.exchange(newUiTexture);
@@ -136,7 +216,9 @@ public:
         connect(&timer, &QTimer::timeout, this, &MainWindow::onTimer);
         timer.start(100);
         setupOffscreenUi();
+        startCapture();
         Platform::addShutdownHook([&] {
+            videoTexture.shutdown();
             vrFramebuffer.reset();
             uiProgram.reset();
             uiShape.reset();
@@ -150,6 +232,13 @@ public:
     }
 
     virtual void stop() {
+        stopCapture();
+        if (videoTexture.isInitialized()) {
+            const StreamingTexture::Stats & stats = videoTexture.getStats();
+            SAY("Video uploads %lu, skipped %lu, rejected %lu, latency avg %0.2f ms max %0.2f ms",
+                (unsigned long)stats.uploads, (unsigned long)stats.skipped, (unsigned long)stats.rejected,
+                stats.averageLatencyMs, stats.maxLatencyMs);
+        }
         delete uiWindow;
         uiWindow = nullptr;
     }
@@ -377,6 +466,7 @@ private:
     // Rendering functionality
     // 
     void perFrameRender() {
+        updateVideoTexture();
         Context::Enable(Capability::Blend);
         Context::BlendFunc(BlendFunction::SrcAlpha, BlendFunction::OneMinusSrcAlpha);
         Context::Disable(Capability::ScissorTest);
@@ -449,6 +539,14 @@ private:
             glClearColor(0.5f, 0.5f, 0.5f, 1);
             Context::Clear().ColorBuffer();
             oria::viewport(renderSize());
+            if (videoTexture.isInitialized()) {
+                videoTexture.getTexture()->Bind(Texture::Target::_2D);
+                Stacks::withIdentity([&] {
+                    oria::renderGeometry(plane, planeProgram, LambdaList({ [&] {
+                        Uniform<vec2>(*planeProgram, "UvMultiplier").Set(vec2(1));
+                    } }));
+                });
+            }
         });
         oria::viewport(textureSize());
 
@@ -358,9 +358,10 @@ static void _ctmMakeVertexDeltas(_CTMcontext * self, CTMint * aIntVertices,
   prevDeltaX = 0;
   for(i = 0; i < self->mVertexCount; ++ i)
   {
-    // Get grid box origin
+    // Get grid box origin (only when entering a new box)
     gridIdx = aSortVertices[i].mGridIndex;
-    _ctmGridIdxToPoint(aGrid, gridIdx, gridOrigin);
+    if((gridIdx != prevGridIndex) || (i == 0))
+      _ctmGridIdxToPoint(aGrid, gridIdx, gridOrigin);
 
     // Get old vertex coordinate index (before vertex sorting)
     oldIdx = aSortVertices[i].mOriginalIndex;
@@ -382,10 +383,14 @@ static void _ctmMakeVertexDeltas(_CTMcontext * self, CTMint * aIntVertices,
 }
 
 //-----------------------------------------------------------------------------
-// _ctmRestoreVertices() - Calculate inverse derivatives of the vertices.
+// _ctmRestoreVertexRange() - Calculate inverse derivatives of the vertices in
+// the range [aStart, aEnd). The X delta carried over from the vertices before
+// aStart is recovered by summing the deltas back to the start of its grid
+// box, so that any range gives the same result as a single pass.
 //-----------------------------------------------------------------------------
-static void _ctmRestoreVertices(_CTMcontext * self, CTMint * aIntVertices,
-  CTMuint * aGridIndices, _CTMgrid * aGrid, CTMfloat * aVertices)
+static void _ctmRestoreVertexRange(_CTMcontext * self, CTMint * aIntVertices,
+  CTMuint * aGridIndices, _CTMgrid * aGrid, CTMfloat * aVertices,
+  CTMuint aStart, CTMuint aEnd)
 {
   CTMuint i, gridIdx, prevGridIndex;
   CTMfloat gridOrigin[3], scale;
@@ -395,11 +400,23 @@ static void _ctmRestoreVertices(_CTMcontext * self, CTMint * aIntVertices,
 
   prevGridIndex = 0x7fffffff;
   prevDeltaX = 0;
-  for(i = 0; i < self->mVertexCount; ++ i)
+  if(aStart > 0)
+  {
+    prevGridIndex = aGridIndices[aStart - 1];
+    i = aStart - 1;
+    while((i > 0) && (aGridIndices[i - 1] == prevGridIndex))
+      -- i;
+    for(; i < aStart; ++ i)
+      prevDeltaX += aIntVertices[i * 3];
+  }
+
+  for(i = aStart; i < aEnd; ++ i)
   {
-    // Get grid box origin
+    // Get grid box origin (only when entering a new box, since the vertices
+    // are sorted by grid index)
     gridIdx = aGridIndices[i];
-    _ctmGridIdxToPoint(aGrid, gridIdx, gridOrigin);
+    if((gridIdx != prevGridIndex) || (i == aStart))
+      _ctmGridIdxToPoint(aGrid, gridIdx, gridOrigin);
 
     // Restore original point
     deltaX = aIntVertices[i * 3];
@@ -415,10 +432,45 @@ static void _ctmRestoreVertices(_CTMcontext * self, CTMint * aIntVertices,
 }
 
 //-----------------------------------------------------------------------------
-// _ctmCalcSmoothNormals() - Calculate the smooth normals for a given mesh.
-// These are used as the nominal normals for normal deltas & reconstruction.
+// _ctmRestoreVertices() - Calculate inverse derivatives of the vertices.
 //-----------------------------------------------------------------------------
-static void _ctmCalcSmoothNormals(_CTMcontext * self, CTMfloat * aVertices,
+static void _ctmRestoreVertices(_CTMcontext * self, CTMint * aIntVertices,
+  CTMuint * aGridIndices, _CTMgrid * aGrid, CTMfloat * aVertices)
+{
+  _ctmRestoreVertexRange(self, aIntVertices, aGridIndices, aGrid, aVertices,
+    0, self->mVertexCount);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmNormalizeSmoothNormals() - Normalize the smooth normal sums in the range
+// [aStart, aEnd).
+//-----------------------------------------------------------------------------
+static void _ctmNormalizeSmoothNormals(CTMfloat * aSmoothNormals,
+  CTMuint aStart, CTMuint aEnd)
+{
+  CTMuint i, j;
+  CTMfloat len;
+
+  for(i = aStart; i < aEnd; ++ i)
+  {
+    len = sqrtf(aSmoothNormals[i * 3] * aSmoothNormals[i * 3] + 
+                aSmoothNormals[i * 3 + 1] * aSmoothNormals[i * 3 + 1] +
+                aSmoothNormals[i * 3 + 2] * aSmoothNormals[i * 3 + 2]);
+    if(len > 1e-10f)
+      len = 1.0f / len;
+    else
+      len = 1.0f;
+    for(j = 0; j < 3; ++ j)
+      aSmoothNormals[i * 3 + j] *= len;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// _ctmSumSmoothNormals() - Sum up the flat normals of the triangles around
+// each vertex. The sums are order dependent, so this is always done in a
+// single pass.
+//-----------------------------------------------------------------------------
+static void _ctmSumSmoothNormals(_CTMcontext * self, CTMfloat * aVertices,
   CTMuint * aIndices, CTMfloat * aSmoothNormals)
 {
   CTMuint i, j, k, tri[3];
@@ -459,20 +511,19 @@ static void _ctmCalcSmoothNormals(_CTMcontext * self, CTMfloat * aVertices,
       for(j = 0; j < 3; ++ j)
         aSmoothNormals[tri[k] * 3 + j] += n[j];
   }
+}
+
+//-----------------------------------------------------------------------------
+// _ctmCalcSmoothNormals() - Calculate the smooth normals for a given mesh.
+// These are used as the nominal normals for normal deltas & reconstruction.
+//-----------------------------------------------------------------------------
+static void _ctmCalcSmoothNormals(_CTMcontext * self, CTMfloat * aVertices,
+  CTMuint * aIndices, CTMfloat * aSmoothNormals)
+{
+  _ctmSumSmoothNormals(self, aVertices, aIndices, aSmoothNormals);
 
   // Normalize the normal sums, which gives the unit length smooth normals
-  for(i = 0; i < self->mVertexCount; ++ i)
-  {
-    len = sqrtf(aSmoothNormals[i * 3] * aSmoothNormals[i * 3] + 
-                aSmoothNormals[i * 3 + 1] * aSmoothNormals[i * 3 + 1] +
-                aSmoothNormals[i * 3 + 2] * aSmoothNormals[i * 3 + 2]);
-    if(len > 1e-10f)
-      len = 1.0f / len;
-    else
-      len = 1.0f;
-    for(j = 0; j < 3; ++ j)
-      aSmoothNormals[i * 3 + j] *= len;
-  }
+  _ctmNormalizeSmoothNormals(aSmoothNormals, 0, self->mVertexCount);
 }
 
 //-----------------------------------------------------------------------------
@@ -607,29 +658,20 @@ static CTMint _ctmMakeNormalDeltas(_CTMcontext * self, CTMint * aIntNormals,
 }
 
 //-----------------------------------------------------------------------------
-// _ctmRestoreNormals() - Convert the normals back to cartesian coordinates.
+// _ctmRestoreNormalRange() - Convert the normals in the range [aStart, aEnd)
+// back to cartesian coordinates, given the smooth normals.
 //-----------------------------------------------------------------------------
-static CTMint _ctmRestoreNormals(_CTMcontext * self, CTMint * aIntNormals)
+static void _ctmRestoreNormalRange(_CTMcontext * self, CTMint * aIntNormals,
+  CTMfloat * aSmoothNormals, CTMuint aStart, CTMuint aEnd)
 {
   CTMuint i, j, intPhi;
   CTMfloat magn, phi, theta, scale, thetaScale;
-  CTMfloat * smoothNormals, n[3], n2[3], basisAxes[9];
-
-  // Allocate temporary memory for the nominal vertex normals
-  smoothNormals = (CTMfloat *) malloc(3 * sizeof(CTMfloat) * self->mVertexCount);
-  if(!smoothNormals)
-  {
-    self->mError = CTM_OUT_OF_MEMORY;
-    return CTM_FALSE;
-  }
-
-  // Calculate smooth normals (nominal normals)
-  _ctmCalcSmoothNormals(self, self->mVertices, self->mIndices, smoothNormals);
+  CTMfloat n[3], n2[3], basisAxes[9];
 
   // Normal scaling factor
   scale = self->mNormalPrecision;
 
-  for(i = 0; i < self->mVertexCount; ++ i)
+  for(i = aStart; i < aEnd; ++ i)
   {
     // Get the normal magnitude from the first of the three normal elements
     magn = aIntNormals[i * 3] * scale;
@@ -650,7 +692,7 @@ static CTMint _ctmRestoreNormals(_CTMcontext * self, CTMint * aIntNormals)
     n2[0] = sinf(phi) * cosf(theta);
     n2[1] = sinf(phi) * sinf(theta);
     n2[2] = cosf(phi);
-    _ctmMakeNormalCoordSys(&smoothNormals[i * 3], basisAxes);
+    _ctmMakeNormalCoordSys(&aSmoothNormals[i * 3], basisAxes);
     for(j = 0; j < 3; ++ j)
       n[j] = basisAxes[j] * n2[0] +
              basisAxes[3 + j] * n2[1] +
@@ -660,6 +702,28 @@ static CTMint _ctmRestoreNormals(_CTMcontext * self, CTMint * aIntNormals)
     for(j = 0; j < 3; ++ j)
       self->mNormals[i * 3 + j] = n[j] * magn;
   }
+}
+
+//-----------------------------------------------------------------------------
+// _ctmRestoreNormals() - Convert the normals back to cartesian coordinates.
+//-----------------------------------------------------------------------------
+static CTMint _ctmRestoreNormals(_CTMcontext * self, CTMint * aIntNormals)
+{
+  CTMfloat * smoothNormals;
+
+  // Allocate temporary memory for the nominal vertex normals
+  smoothNormals = (CTMfloat *) malloc(3 * sizeof(CTMfloat) * self->mVertexCount);
+  if(!smoothNormals)
+  {
+    self->mError = CTM_OUT_OF_MEMORY;
+    return CTM_FALSE;
+  }
+
+  // Calculate smooth normals (nominal normals)
+  _ctmCalcSmoothNormals(self, self->mVertices, self->mIndices, smoothNormals);
+
+  // Convert the normals
+  _ctmRestoreNormalRange(self, aIntNormals, smoothNormals, 0, self->mVertexCount);
 
   // Free temporary resources
   free(smoothNormals);
@@ -709,27 +773,8 @@ static void _ctmMakeUVCoordDeltas(_CTMcontext * self, _CTMfloatmap * aMap,
 static void _ctmRestoreUVCoords(_CTMcontext * self, _CTMfloatmap * aMap,
   CTMint * aIntUVCoords)
 {
-  CTMuint i;
-  CTMint u, v, prevU, prevV;
-  CTMfloat scale;
-
-  // UV coordinate scaling factor
-  scale = aMap->mPrecision;
-
-  prevU = prevV = 0;
-  for(i = 0; i < self->mVertexCount; ++ i)
-  {
-    // Calculate inverse delta
-    u = aIntUVCoords[i * 2] + prevU;
-    v = aIntUVCoords[i * 2 + 1] + prevV;
-
-    // Convert to floating point
-    aMap->mValues[i * 2] = (CTMfloat) u * scale;
-    aMap->mValues[i * 2 + 1] = (CTMfloat) v * scale;
-
-    prevU = u;
-    prevV = v;
-  }
+  _ctmRestoreDeltas(aIntUVCoords, aMap->mValues, self->mVertexCount, 2,
+                    aMap->mPrecision);
 }
 
 //-----------------------------------------------------------------------------
@@ -775,26 +820,8 @@ static void _ctmMakeAttribDeltas(_CTMcontext * self, _CTMfloatmap * aMap,
 static void _ctmRestoreAttribs(_CTMcontext * self, _CTMfloatmap * aMap,
   CTMint * aIntAttribs)
 {
-  CTMuint i, j;
-  CTMint value[4], prev[4];
-  CTMfloat scale;
-
-  // Attribute scaling factor
-  scale = aMap->mPrecision;
-
-  for(j = 0; j < 4; ++ j)
-    prev[j] = 0;
-
-  for(i = 0; i < self->mVertexCount; ++ i)
-  {
-    // Calculate inverse delta, and convert to floating point
-    for(j = 0; j < 4; ++ j)
-    {
-      value[j] = aIntAttribs[i * 4 + j] + prev[j];
-      aMap->mValues[i * 4 + j] = (CTMfloat) value[j] * scale;
-      prev[j] = value[j];
-    }
-  }
+  _ctmRestoreDeltas(aIntAttribs, aMap->mValues, self->mVertexCount, 4,
+                    aMap->mPrecision);
 }
 
 //-----------------------------------------------------------------------------
@@ -1077,13 +1104,370 @@ int _ctmCompressMesh_MG2(_CTMcontext * self)
   return CTM_TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// Meshes with fewer vertices than this are always decoded on the calling
+// thread, since starting the threads would cost more than it saves.
+//-----------------------------------------------------------------------------
+#define CTM_PARALLEL_MIN_VERTICES 32768
+
+//-----------------------------------------------------------------------------
+// _CTMunpackjob - One packed integer stream to uncompress.
+//-----------------------------------------------------------------------------
+typedef struct {
+  _CTMpackedblock mBlock;
+  CTMint * mData;
+  CTMuint mCount;
+  CTMuint mSize;
+  CTMint mSignedInts;
+  CTMenum mError;
+} _CTMunpackjob;
+
+//-----------------------------------------------------------------------------
+// _CTMrestorejob - A range of one of the restore passes.
+//-----------------------------------------------------------------------------
+typedef struct {
+  _CTMcontext * mContext;
+  _CTMgrid * mGrid;
+  CTMint * mIntData;
+  CTMuint * mGridIndices;
+  CTMfloat * mSmoothNormals;
+  _CTMfloatmap * mMap;
+  CTMuint mStart;
+  CTMuint mEnd;
+} _CTMrestorejob;
+
+static void _ctmUnpackJob(void * aArg)
+{
+  _CTMunpackjob * job = (_CTMunpackjob *) aArg;
+  job->mError = _ctmUnpackInts(&job->mBlock, job->mData, job->mCount,
+                               job->mSize, job->mSignedInts);
+  free(job->mBlock.mData);
+  job->mBlock.mData = 0;
+}
+
+static void _ctmRestoreVertexJob(void * aArg)
+{
+  _CTMrestorejob * job = (_CTMrestorejob *) aArg;
+  _ctmRestoreVertexRange(job->mContext, job->mIntData, job->mGridIndices,
+    job->mGrid, job->mContext->mVertices, job->mStart, job->mEnd);
+}
+
+static void _ctmRestoreIndexJob(void * aArg)
+{
+  _CTMrestorejob * job = (_CTMrestorejob *) aArg;
+  _ctmRestoreIndices(job->mContext, job->mContext->mIndices);
+}
+
+static void _ctmRestoreUVCoordJob(void * aArg)
+{
+  _CTMrestorejob * job = (_CTMrestorejob *) aArg;
+  _ctmRestoreUVCoords(job->mContext, job->mMap, job->mIntData);
+}
+
+static void _ctmRestoreAttribJob(void * aArg)
+{
+  _CTMrestorejob * job = (_CTMrestorejob *) aArg;
+  _ctmRestoreAttribs(job->mContext, job->mMap, job->mIntData);
+}
+
+static void _ctmRestoreNormalJob(void * aArg)
+{
+  _CTMrestorejob * job = (_CTMrestorejob *) aArg;
+  _ctmNormalizeSmoothNormals(job->mSmoothNormals, job->mStart, job->mEnd);
+  _ctmRestoreNormalRange(job->mContext, job->mIntData, job->mSmoothNormals,
+    job->mStart, job->mEnd);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmReadUnpackJob() - Read the packed block for one integer stream from the
+// input stream, leaving it to be uncompressed later.
+//-----------------------------------------------------------------------------
+static int _ctmReadUnpackJob(_CTMcontext * self, _CTMunpackjob * aJob,
+  CTMint * aData, CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  aJob->mData = aData;
+  aJob->mCount = aCount;
+  aJob->mSize = aSize;
+  aJob->mSignedInts = aSignedInts;
+  aJob->mError = CTM_NONE;
+  return _ctmStreamReadPackedBlock(self, &aJob->mBlock);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmReadPackedStreams_MG2() - Read all the packed streams, and the headers
+// between them, in stream order. The vertex, grid index, normal, UV and
+// attribute streams are given consecutive parts of aIntData; the triangle
+// indices are unpacked straight into the mesh.
+//-----------------------------------------------------------------------------
+static int _ctmReadPackedStreams_MG2(_CTMcontext * self, _CTMunpackjob * aJobs,
+  CTMint * aIntData)
+{
+  _CTMfloatmap * map;
+  CTMint * data = aIntData;
+  CTMuint vertexCount = self->mVertexCount;
+
+  if(_ctmStreamReadUINT(self) != FOURCC("VERT"))
+  {
+    self->mError = CTM_BAD_FORMAT;
+    return CTM_FALSE;
+  }
+  if(!_ctmReadUnpackJob(self, aJobs ++, data, vertexCount, 3, CTM_FALSE))
+    return CTM_FALSE;
+  data += vertexCount * 3;
+
+  if(_ctmStreamReadUINT(self) != FOURCC("GIDX"))
+  {
+    self->mError = CTM_BAD_FORMAT;
+    return CTM_FALSE;
+  }
+  if(!_ctmReadUnpackJob(self, aJobs ++, data, vertexCount, 1, CTM_FALSE))
+    return CTM_FALSE;
+  data += vertexCount;
+
+  if(_ctmStreamReadUINT(self) != FOURCC("INDX"))
+  {
+    self->mError = CTM_BAD_FORMAT;
+    return CTM_FALSE;
+  }
+  if(!_ctmReadUnpackJob(self, aJobs ++, (CTMint *) self->mIndices,
+                        self->mTriangleCount, 3, CTM_FALSE))
+    return CTM_FALSE;
+
+  if(self->mNormals)
+  {
+    if(_ctmStreamReadUINT(self) != FOURCC("NORM"))
+    {
+      self->mError = CTM_BAD_FORMAT;
+      return CTM_FALSE;
+    }
+    if(!_ctmReadUnpackJob(self, aJobs ++, data, vertexCount, 3, CTM_FALSE))
+      return CTM_FALSE;
+    data += vertexCount * 3;
+  }
+
+  for(map = self->mUVMaps; map; map = map->mNext)
+  {
+    if(_ctmStreamReadUINT(self) != FOURCC("TEXC"))
+    {
+      self->mError = CTM_BAD_FORMAT;
+      return CTM_FALSE;
+    }
+    _ctmStreamReadSTRING(self, &map->mName);
+    _ctmStreamReadSTRING(self, &map->mFileName);
+    map->mPrecision = _ctmStreamReadFLOAT(self);
+    if(map->mPrecision <= 0.0f)
+    {
+      self->mError = CTM_BAD_FORMAT;
+      return CTM_FALSE;
+    }
+    if(!_ctmReadUnpackJob(self, aJobs ++, data, vertexCount, 2, CTM_TRUE))
+      return CTM_FALSE;
+    data += vertexCount * 2;
+  }
+
+  for(map = self->mAttribMaps; map; map = map->mNext)
+  {
+    if(_ctmStreamReadUINT(self) != FOURCC("ATTR"))
+    {
+      self->mError = CTM_BAD_FORMAT;
+      return CTM_FALSE;
+    }
+    _ctmStreamReadSTRING(self, &map->mName);
+    map->mPrecision = _ctmStreamReadFLOAT(self);
+    if(map->mPrecision <= 0.0f)
+    {
+      self->mError = CTM_BAD_FORMAT;
+      return CTM_FALSE;
+    }
+    if(!_ctmReadUnpackJob(self, aJobs ++, data, vertexCount, 4, CTM_TRUE))
+      return CTM_FALSE;
+    data += vertexCount * 4;
+  }
+
+  return CTM_TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmRestoreMesh_MG2() - Run the restore passes over the unpacked streams.
+// The vertices are split into one range per thread, and run alongside the
+// triangle indices and the UV and attribute maps. The normals depend on both
+// the vertices and the indices, so they follow once those are done.
+//-----------------------------------------------------------------------------
+static int _ctmRestoreMesh_MG2(_CTMcontext * self, _CTMgrid * aGrid,
+  _CTMunpackjob * aUnpacked, _CTMrestorejob * aRestore, _CTMjob * aJobs,
+  CTMuint aThreads)
+{
+  _CTMfloatmap * map;
+  _CTMunpackjob * unpacked;
+  CTMuint * gridIndices, i, chunk, count;
+
+  // Restore grid indices (deltas)
+  gridIndices = (CTMuint *) aUnpacked[1].mData;
+  for(i = 1; i < self->mVertexCount; ++ i)
+    gridIndices[i] += gridIndices[i - 1];
+
+  chunk = (self->mVertexCount + aThreads - 1) / aThreads;
+  count = 0;
+  for(i = 0; i < self->mVertexCount; i += chunk)
+  {
+    aRestore[count].mContext = self;
+    aRestore[count].mGrid = aGrid;
+    aRestore[count].mIntData = aUnpacked[0].mData;
+    aRestore[count].mGridIndices = gridIndices;
+    aRestore[count].mStart = i;
+    aRestore[count].mEnd = (self->mVertexCount - i > chunk) ? i + chunk : self->mVertexCount;
+    aJobs[count].mFunc = _ctmRestoreVertexJob;
+    aJobs[count].mArg = &aRestore[count];
+    ++ count;
+  }
+
+  aRestore[count].mContext = self;
+  aJobs[count].mFunc = _ctmRestoreIndexJob;
+  aJobs[count].mArg = &aRestore[count];
+  ++ count;
+
+  unpacked = aUnpacked + (self->mNormals ? 4 : 3);
+  for(map = self->mUVMaps; map; map = map->mNext)
+  {
+    aRestore[count].mContext = self;
+    aRestore[count].mMap = map;
+    aRestore[count].mIntData = (unpacked ++)->mData;
+    aJobs[count].mFunc = _ctmRestoreUVCoordJob;
+    aJobs[count].mArg = &aRestore[count];
+    ++ count;
+  }
+  for(map = self->mAttribMaps; map; map = map->mNext)
+  {
+    aRestore[count].mContext = self;
+    aRestore[count].mMap = map;
+    aRestore[count].mIntData = (unpacked ++)->mData;
+    aJobs[count].mFunc = _ctmRestoreAttribJob;
+    aJobs[count].mArg = &aRestore[count];
+    ++ count;
+  }
+
+  _ctmRunJobs(aJobs, count, aThreads);
+
+  // Check that all indices are within range
+  for(i = 0; i < (self->mTriangleCount * 3); ++ i)
+  {
+    if(self->mIndices[i] >= self->mVertexCount)
+    {
+      self->mError = CTM_INVALID_MESH;
+      return CTM_FALSE;
+    }
+  }
+
+  if(self->mNormals)
+  {
+    CTMfloat * smoothNormals;
+
+    smoothNormals = (CTMfloat *) malloc(3 * sizeof(CTMfloat) * self->mVertexCount);
+    if(!smoothNormals)
+    {
+      self->mError = CTM_OUT_OF_MEMORY;
+      return CTM_FALSE;
+    }
+    _ctmSumSmoothNormals(self, self->mVertices, self->mIndices, smoothNormals);
+
+    count = 0;
+    for(i = 0; i < self->mVertexCount; i += chunk)
+    {
+      aRestore[count].mContext = self;
+      aRestore[count].mIntData = aUnpacked[3].mData;
+      aRestore[count].mSmoothNormals = smoothNormals;
+      aRestore[count].mStart = i;
+      aRestore[count].mEnd = (self->mVertexCount - i > chunk) ? i + chunk : self->mVertexCount;
+      aJobs[count].mFunc = _ctmRestoreNormalJob;
+      aJobs[count].mArg = &aRestore[count];
+      ++ count;
+    }
+    _ctmRunJobs(aJobs, count, aThreads);
+
+    free((void *) smoothNormals);
+  }
+
+  return CTM_TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmUncompressParallel_MG2() - Uncompress the streams following the MG2
+// header on several threads. The packed streams are read from the input in
+// order, since that is inherently sequential, then uncompressed concurrently
+// and restored in ranges. The result is identical to the serial decoder.
+//-----------------------------------------------------------------------------
+static int _ctmUncompressParallel_MG2(_CTMcontext * self, _CTMgrid * aGrid,
+  CTMuint aThreads)
+{
+  _CTMunpackjob * unpack;
+  _CTMrestorejob * restore;
+  _CTMjob * jobs;
+  CTMint * intData;
+  CTMuint blockCount, intsPerVertex, i;
+  int result;
+
+  blockCount = 3 + (self->mNormals ? 1 : 0) + self->mUVMapCount +
+               self->mAttribMapCount;
+  intsPerVertex = 4 + (self->mNormals ? 3 : 0) + 2 * self->mUVMapCount +
+                  4 * self->mAttribMapCount;
+
+  unpack = (_CTMunpackjob *) calloc(blockCount, sizeof(_CTMunpackjob));
+  restore = (_CTMrestorejob *) calloc(aThreads + blockCount, sizeof(_CTMrestorejob));
+  jobs = (_CTMjob *) calloc(aThreads + blockCount, sizeof(_CTMjob));
+  intData = (CTMint *) malloc(sizeof(CTMint) * self->mVertexCount * intsPerVertex);
+  if(!unpack || !restore || !jobs || !intData)
+  {
+    self->mError = CTM_OUT_OF_MEMORY;
+    result = CTM_FALSE;
+  }
+  else
+    result = _ctmReadPackedStreams_MG2(self, unpack, intData);
+
+  if(result)
+  {
+    // Uncompress all the streams at once
+    for(i = 0; i < blockCount; ++ i)
+    {
+      jobs[i].mFunc = _ctmUnpackJob;
+      jobs[i].mArg = &unpack[i];
+    }
+    _ctmRunJobs(jobs, blockCount, aThreads);
+
+    // Report the first error in stream order, as the serial decoder would
+    for(i = 0; result && (i < blockCount); ++ i)
+    {
+      if(unpack[i].mError != CTM_NONE)
+      {
+        self->mError = unpack[i].mError;
+        result = CTM_FALSE;
+      }
+    }
+  }
+
+  if(result)
+    result = _ctmRestoreMesh_MG2(self, aGrid, unpack, restore, jobs, aThreads);
+
+  // Free temporary resources, including any blocks left unread after an error
+  if(unpack)
+  {
+    for(i = 0; i < blockCount; ++ i)
+      free(unpack[i].mBlock.mData);
+  }
+  free((void *) intData);
+  free((void *) jobs);
+  free((void *) restore);
+  free((void *) unpack);
+
+  return result;
+}
+
 //-----------------------------------------------------------------------------
 // _ctmUncompressMesh_MG2() - Uncmpress the mesh from the input stream in the
 // CTM context, and store the resulting mesh in the CTM context.
 //-----------------------------------------------------------------------------
 int _ctmUncompressMesh_MG2(_CTMcontext * self)
 {
-  CTMuint * gridIndices, i;
+  CTMuint * gridIndices, i, threads;
   CTMint * intVertices, * intNormals, * intUVCoords, * intAttribs;
   _CTMfloatmap * map;
   _CTMgrid grid;
@@ -1132,6 +1516,11 @@ int _ctmUncompressMesh_MG2(_CTMcontext * self)
   for(i = 0; i < 3; ++ i)
     grid.mSize[i] = (grid.mMax[i] - grid.mMin[i]) / grid.mDivision[i];
 
+  // Large meshes are decoded on several threads
+  threads = _ctmDecodeThreads(self);
+  if((threads > 1) && (self->mVertexCount >= CTM_PARALLEL_MIN_VERTICES))
+    return _ctmUncompressParallel_MG2(self, &grid, threads);
+
   // Read vertices
   if(_ctmStreamReadUINT(self) != FOURCC("VERT"))
   {
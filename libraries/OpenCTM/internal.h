@@ -85,6 +85,9 @@ typedef struct {
   // The selected compression level
   CTMuint mCompressionLevel;
 
+  // Number of threads to decode with (0 = one per processor)
+  CTMuint mDecodeThreads;
+
   // Vertex coordinate precision
   CTMfloat mVertexPrecision;
 
@@ -104,6 +107,24 @@ typedef struct {
   void * mUserData;
 } _CTMcontext;
 
+//-----------------------------------------------------------------------------
+// _CTMpackedblock - An LZMA compressed block, as read from the stream but
+// not yet uncompressed.
+//-----------------------------------------------------------------------------
+typedef struct {
+  unsigned char * mData;
+  CTMuint mSize;
+  unsigned char mProps[5];
+} _CTMpackedblock;
+
+//-----------------------------------------------------------------------------
+// _CTMjob - A unit of work for _ctmRunJobs().
+//-----------------------------------------------------------------------------
+typedef struct {
+  void (* mFunc)(void * aArg);
+  void * mArg;
+} _CTMjob;
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -123,9 +144,29 @@ void _ctmStreamReadSTRING(_CTMcontext * self, char ** aValue);
 void _ctmStreamWriteSTRING(_CTMcontext * self, const char * aValue);
 int _ctmStreamReadPackedInts(_CTMcontext * self, CTMint * aData, CTMuint aCount, CTMuint aSize, CTMint aSignedInts);
 int _ctmStreamWritePackedInts(_CTMcontext * self, CTMint * aData, CTMuint aCount, CTMuint aSize, CTMint aSignedInts);
+int _ctmStreamReadPackedBlock(_CTMcontext * self, _CTMpackedblock * aBlock);
+CTMenum _ctmUnpackInts(const _CTMpackedblock * aBlock, CTMint * aData, CTMuint aCount, CTMuint aSize, CTMint aSignedInts);
 int _ctmStreamReadPackedFloats(_CTMcontext * self, CTMfloat * aData, CTMuint aCount, CTMuint aSize);
 int _ctmStreamWritePackedFloats(_CTMcontext * self, CTMfloat * aData, CTMuint aCount, CTMuint aSize);
 
+//-----------------------------------------------------------------------------
+// Funcion prototypes for thread.c
+//-----------------------------------------------------------------------------
+CTMuint _ctmProcessorCount(void);
+CTMuint _ctmDecodeThreads(_CTMcontext * self);
+void _ctmRunJobs(_CTMjob * aJobs, CTMuint aCount, CTMuint aThreads);
+
+//-----------------------------------------------------------------------------
+// Funcion prototypes for simd.c
+//-----------------------------------------------------------------------------
+#define CTM_SIMD_NONE 0
+#define CTM_SIMD_SSE2 1
+#define CTM_SIMD_AVX2 2
+int _ctmSimdLimit(int aLevel);
+void _ctmUnpackPlanes(const unsigned char * aPlanes, CTMint * aData, CTMuint aCount, CTMuint aSize, CTMint aSignedInts);
+void _ctmPackPlanes(const CTMint * aData, unsigned char * aPlanes, CTMuint aCount, CTMuint aSize, CTMint aSignedInts);
+void _ctmRestoreDeltas(const CTMint * aDeltas, CTMfloat * aValues, CTMuint aCount, CTMuint aSize, CTMfloat aScale);
+
 //-----------------------------------------------------------------------------
 // Funcion prototypes for compressRAW.c
 //-----------------------------------------------------------------------------
@@ -1101,6 +1101,25 @@ static CTMuint CTMCALL _ctmDefaultRead(void * aBuf, CTMuint aCount,
   return (CTMuint) fread(aBuf, 1, (size_t) aCount, (FILE *) aUserData);
 }
 
+//-----------------------------------------------------------------------------
+// ctmDecodeThreads()
+//-----------------------------------------------------------------------------
+CTMEXPORT void CTMCALL ctmDecodeThreads(CTMcontext aContext, CTMuint aCount)
+{
+  _CTMcontext * self = (_CTMcontext *) aContext;
+  if(!self) return;
+
+  // Decoding only happens in import mode
+  if(self->mMode != CTM_IMPORT)
+  {
+    self->mError = CTM_INVALID_OPERATION;
+    return;
+  }
+
+  // Set the thread count
+  self->mDecodeThreads = aCount;
+}
+
 //-----------------------------------------------------------------------------
 // ctmLoad()
 //-----------------------------------------------------------------------------
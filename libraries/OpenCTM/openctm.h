@@ -603,6 +603,16 @@ CTMEXPORT CTMenum CTMCALL ctmAddUVMap(CTMcontext aContext,
 CTMEXPORT CTMenum CTMCALL ctmAddAttribMap(CTMcontext aContext,
   const CTMfloat * aAttribValues, const char * aName);
 
+/// Set how many threads to use when loading MG2 compressed meshes. Large
+/// meshes are decoded with their packed streams uncompressed concurrently, and
+/// the result is identical to decoding on a single thread.
+/// @param[in] aContext An OpenCTM context that has been created by
+///            ctmNewContext().
+/// @param[in] aCount The number of threads, including the calling thread. The
+///            default, 0, uses one thread per processor, and 1 decodes on the
+///            calling thread only.
+CTMEXPORT void CTMCALL ctmDecodeThreads(CTMcontext aContext, CTMuint aCount);
+
 /// Load an OpenCTM format file into the context. The mesh data can be retrieved
 /// with the various ctmGet functions.
 /// @param[in] aContext An OpenCTM context that has been created by
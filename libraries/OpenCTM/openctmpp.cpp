@@ -4,3 +4,14 @@ CTMuint CTMimporter::StreamLoaderFn(void * aBuf, CTMuint aCount, void * aUserDat
     std::istream & instream = *(std::istream *) aUserData;
     return (CTMuint)instream.readsome((char*) aBuf, aCount);
 }
+
+CTMuint CTMimporter::MemoryLoaderFn(void * aBuf, CTMuint aCount, void * aUserData) {
+    MemorySource & source = *(MemorySource *) aUserData;
+    size_t remaining = source.mSize - source.mOffset;
+    if (aCount > remaining) {
+        aCount = (CTMuint) remaining;
+    }
+    memcpy(aBuf, source.mData + source.mOffset, aCount);
+    source.mOffset += aCount;
+    return aCount;
+}
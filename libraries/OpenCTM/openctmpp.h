@@ -39,6 +39,7 @@
 #include <exception>
 #include <istream>
 #include <sstream>
+#include <cstring>
 
 /// OpenCTM exception. When an error occurs, a \c ctm_error exception is
 /// thrown. Its what() function returns the name of the OpenCTM error code
@@ -103,6 +104,13 @@ class CTMimporter {
 
     static CTMuint CTMCALL StreamLoaderFn(void * aBuf, CTMuint aCount, void * aUserData);
 
+    struct MemorySource {
+      const char * mData;
+      size_t mSize;
+      size_t mOffset;
+    };
+    static CTMuint CTMCALL MemoryLoaderFn(void * aBuf, CTMuint aCount, void * aUserData);
+
   public:
     /// Constructor
     CTMimporter()
@@ -204,6 +212,13 @@ class CTMimporter {
       return res;
     }
 
+    /// Wrapper for ctmDecodeThreads()
+    void DecodeThreads(CTMuint aCount)
+    {
+      ctmDecodeThreads(mContext, aCount);
+      CheckError();
+    }
+
     /// Wrapper for ctmLoad()
     void Load(const char * aFileName)
     {
@@ -225,6 +240,14 @@ class CTMimporter {
         LoadCustom(StreamLoaderFn, &stream);
     }
 
+    /// Wrapper for ctmLoadCustom() reading directly from a memory buffer,
+    /// without copying it first
+    void LoadData(const void * aData, size_t aSize)
+    {
+        MemorySource source = { (const char *) aData, aSize, 0 };
+        LoadCustom(MemoryLoaderFn, &source);
+    }
+
     // You can not copy nor assign from one CTMimporter object to another, since
     // the object contains hidden state. By declaring these dummy prototypes
     // without an implementation, you will at least get linker errors if you try
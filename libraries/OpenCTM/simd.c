@@ -0,0 +1,532 @@
+//-----------------------------------------------------------------------------
+// Product:     OpenCTM
+// File:        simd.c
+// Description: Vectorized kernels for the packed streams and the MG2 restore
+//              passes, with scalar fallbacks.
+//-----------------------------------------------------------------------------
+// This file is an addition to the original OpenCTM distribution, and is
+// provided under the same terms as the rest of the library.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//     distribution.
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "openctm.h"
+#include "internal.h"
+
+// The vector paths are x86 only, and can be disabled with CTM_NO_SIMD
+#if !defined(CTM_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || \
+                              defined(__i386__) || defined(_M_IX86))
+#define CTM_X86_SIMD
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CTM_TARGET_SSE2
+#define CTM_TARGET_AVX2
+#define CTM_INLINE __forceinline
+#else
+#include <cpuid.h>
+#define CTM_TARGET_SSE2 __attribute__((target("sse2")))
+#define CTM_TARGET_AVX2 __attribute__((target("avx2")))
+#define CTM_INLINE __inline__ __attribute__((always_inline))
+#endif
+#endif
+
+// The highest instruction set the kernels may use, see _ctmSimdLimit()
+static volatile int _ctmSimdMax = CTM_SIMD_AVX2;
+
+
+//-----------------------------------------------------------------------------
+// Scalar kernels. These define the results; the vector kernels must match
+// them bit for bit. Each one starts at aFirst, so that it can also finish
+// off whatever the vector kernels leave over.
+//-----------------------------------------------------------------------------
+
+static void _ctmUnpackPlanes_C(const unsigned char * aPlanes, CTMint * aData,
+  CTMuint aFirst, CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  CTMuint i, k, x;
+  CTMint value;
+
+  for(i = aFirst; i < aCount; ++ i)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      value = (CTMint) aPlanes[i + k * aCount + 3 * aCount * aSize] |
+              (((CTMint) aPlanes[i + k * aCount + 2 * aCount * aSize]) << 8) |
+              (((CTMint) aPlanes[i + k * aCount + aCount * aSize]) << 16) |
+              (((CTMint) aPlanes[i + k * aCount]) << 24);
+      // Convert signed magnitude to two's complement?
+      if(aSignedInts)
+      {
+        x = (CTMuint) value;
+        value = (x & 1) ? -(CTMint)((x + 1) >> 1) : (CTMint)(x >> 1);
+      }
+      aData[i * aSize + k] = value;
+    }
+  }
+}
+
+static void _ctmPackPlanes_C(const CTMint * aData, unsigned char * aPlanes,
+  CTMuint aFirst, CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  CTMuint i, k;
+  CTMint value;
+
+  for(i = aFirst; i < aCount; ++ i)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      value = aData[i * aSize + k];
+      // Convert two's complement to signed magnitude?
+      if(aSignedInts)
+        value = value < 0 ? -1 - (value << 1) : value << 1;
+      aPlanes[i + k * aCount + 3 * aCount * aSize] = value & 0x000000ff;
+      aPlanes[i + k * aCount + 2 * aCount * aSize] = (value >> 8) & 0x000000ff;
+      aPlanes[i + k * aCount + aCount * aSize] = (value >> 16) & 0x000000ff;
+      aPlanes[i + k * aCount] = (value >> 24) & 0x000000ff;
+    }
+  }
+}
+
+static void _ctmRestoreDeltas_C(const CTMint * aDeltas, CTMfloat * aValues,
+  CTMuint aFirst, CTMuint aCount, CTMuint aSize, CTMfloat aScale,
+  CTMint * aPrev)
+{
+  CTMuint i, k;
+
+  for(i = aFirst; i < aCount; ++ i)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      aPrev[k] += aDeltas[i * aSize + k];
+      aValues[i * aSize + k] = (CTMfloat) aPrev[k] * aScale;
+    }
+  }
+}
+
+#ifdef CTM_X86_SIMD
+
+//-----------------------------------------------------------------------------
+// _ctmDetectSimd() - Find the best instruction set this CPU, and the OS,
+// supports.
+//-----------------------------------------------------------------------------
+static int _ctmDetectSimd(void)
+{
+  unsigned int regs[4], maxLeaf, xcr0;
+  int level = CTM_SIMD_NONE;
+
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  maxLeaf = (unsigned int) info[0];
+  __cpuid(info, 1);
+  memcpy(regs, info, sizeof(regs));
+#else
+  maxLeaf = __get_cpuid_max(0, 0);
+  __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+  // EDX bit 26: SSE2
+  if(regs[3] & (1u << 26))
+    level = CTM_SIMD_SSE2;
+
+  // ECX bit 27: OSXSAVE, bit 28: AVX. The OS must also save the YMM state.
+  if((maxLeaf >= 7) && (regs[2] & (1u << 27)) && (regs[2] & (1u << 28)))
+  {
+#if defined(_MSC_VER)
+    xcr0 = (unsigned int) _xgetbv(0);
+#else
+    unsigned int xcr0High;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+#endif
+    if((xcr0 & 6) == 6)
+    {
+#if defined(_MSC_VER)
+      __cpuidex(info, 7, 0);
+      memcpy(regs, info, sizeof(regs));
+#else
+      __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+      // EBX bit 5: AVX2
+      if(regs[1] & (1u << 5))
+        level = CTM_SIMD_AVX2;
+    }
+  }
+
+  return level;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmSimdLevel() - The detected instruction set. Detection is repeatable,
+// so it doesn't matter if several threads race to fill in the cache.
+//-----------------------------------------------------------------------------
+static int _ctmSimdLevel(void)
+{
+  static volatile int level = -1;
+  if(level < 0)
+    level = _ctmDetectSimd();
+  return level < _ctmSimdMax ? level : _ctmSimdMax;
+}
+
+//-----------------------------------------------------------------------------
+// Sign conversions, as in the scalar kernels. These helpers are always
+// inlined, so that the AVX2 kernel doesn't mix in legacy SSE encodings.
+//-----------------------------------------------------------------------------
+CTM_TARGET_SSE2
+static CTM_INLINE __m128i _ctmFromSignedMagnitude_SSE2(__m128i aValue)
+{
+  return _mm_xor_si128(_mm_srli_epi32(aValue, 1),
+    _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(aValue, _mm_set1_epi32(1))));
+}
+
+CTM_TARGET_SSE2
+static CTM_INLINE __m128i _ctmToSignedMagnitude_SSE2(__m128i aValue)
+{
+  return _mm_xor_si128(_mm_slli_epi32(aValue, 1), _mm_srai_epi32(aValue, 31));
+}
+
+//-----------------------------------------------------------------------------
+// _ctmStoreInterleaved_SSE2() - Interleave the components of 4 * aVectors
+// elements. aComponents[k * aVectors + j] holds elements 4j to 4j + 3 of
+// component k. Three components are transposed as four, with overlapping
+// stores, so this writes one word past the last element; the caller must
+// make sure there is at least one more element, which it then overwrites.
+//-----------------------------------------------------------------------------
+CTM_TARGET_SSE2
+static CTM_INLINE void _ctmStoreInterleaved_SSE2(CTMint * aData, const __m128i * aComponents,
+  CTMuint aVectors, CTMuint aSize)
+{
+  CTMuint j;
+  __m128i t0, t1, t2, t3;
+
+  for(j = 0; j < aVectors; ++ j)
+  {
+    switch(aSize)
+    {
+      case 1:
+        _mm_storeu_si128((__m128i *) (aData + j * 4), aComponents[j]);
+        break;
+
+      case 2:
+        t0 = aComponents[j];
+        t1 = aComponents[aVectors + j];
+        _mm_storeu_si128((__m128i *) (aData + j * 8), _mm_unpacklo_epi32(t0, t1));
+        _mm_storeu_si128((__m128i *) (aData + j * 8 + 4), _mm_unpackhi_epi32(t0, t1));
+        break;
+
+      case 4:
+        // 4x4 transpose
+        t0 = _mm_unpacklo_epi32(aComponents[j], aComponents[aVectors + j]);
+        t1 = _mm_unpacklo_epi32(aComponents[2 * aVectors + j], aComponents[3 * aVectors + j]);
+        t2 = _mm_unpackhi_epi32(aComponents[j], aComponents[aVectors + j]);
+        t3 = _mm_unpackhi_epi32(aComponents[2 * aVectors + j], aComponents[3 * aVectors + j]);
+        _mm_storeu_si128((__m128i *) (aData + j * 16), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) (aData + j * 16 + 4), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) (aData + j * 16 + 8), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i *) (aData + j * 16 + 12), _mm_unpackhi_epi64(t2, t3));
+        break;
+
+      case 3:
+        t0 = _mm_unpacklo_epi32(aComponents[j], aComponents[aVectors + j]);
+        t1 = _mm_unpacklo_epi32(aComponents[2 * aVectors + j], aComponents[2 * aVectors + j]);
+        t2 = _mm_unpackhi_epi32(aComponents[j], aComponents[aVectors + j]);
+        t3 = _mm_unpackhi_epi32(aComponents[2 * aVectors + j], aComponents[2 * aVectors + j]);
+        _mm_storeu_si128((__m128i *) (aData + j * 12), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) (aData + j * 12 + 3), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) (aData + j * 12 + 6), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i *) (aData + j * 12 + 9), _mm_unpackhi_epi64(t2, t3));
+        break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// _ctmUnpackPlanes_SSE2() - 16 elements at a time. The four byte planes of a
+// component are merged into 32-bit words with two rounds of unpacks, least
+// significant plane first.
+//-----------------------------------------------------------------------------
+CTM_TARGET_SSE2
+static CTMuint _ctmUnpackPlanes_SSE2(const unsigned char * aPlanes, CTMint * aData,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  __m128i components[16], b0, b1, b2, b3, lo, hi, lo2, hi2;
+  const unsigned char * p;
+  CTMuint i, k, j, planeStride, last;
+
+  // Leave one element over for the overlapping stores of three components
+  planeStride = aCount * aSize;
+  last = (aSize == 3) ? 17 : 16;
+  for(i = 0; i + last <= aCount; i += 16)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      p = aPlanes + k * aCount + i;
+      b0 = _mm_loadu_si128((const __m128i *) p);
+      b1 = _mm_loadu_si128((const __m128i *) (p + planeStride));
+      b2 = _mm_loadu_si128((const __m128i *) (p + 2 * planeStride));
+      b3 = _mm_loadu_si128((const __m128i *) (p + 3 * planeStride));
+      lo = _mm_unpacklo_epi8(b3, b2);
+      hi = _mm_unpackhi_epi8(b3, b2);
+      lo2 = _mm_unpacklo_epi8(b1, b0);
+      hi2 = _mm_unpackhi_epi8(b1, b0);
+      components[k * 4] = _mm_unpacklo_epi16(lo, lo2);
+      components[k * 4 + 1] = _mm_unpackhi_epi16(lo, lo2);
+      components[k * 4 + 2] = _mm_unpacklo_epi16(hi, hi2);
+      components[k * 4 + 3] = _mm_unpackhi_epi16(hi, hi2);
+      if(aSignedInts)
+      {
+        for(j = 0; j < 4; ++ j)
+          components[k * 4 + j] = _ctmFromSignedMagnitude_SSE2(components[k * 4 + j]);
+      }
+    }
+    _ctmStoreInterleaved_SSE2(aData + i * aSize, components, 4, aSize);
+  }
+
+  return i;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmUnpackPlanes_AVX2() - 32 elements at a time. The unpacks work within
+// each 128-bit half, so the low halves hold elements 0-15 and the high halves
+// elements 16-31, which is untangled when splitting them up for the stores.
+//-----------------------------------------------------------------------------
+CTM_TARGET_AVX2
+static CTMuint _ctmUnpackPlanes_AVX2(const unsigned char * aPlanes, CTMint * aData,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  __m128i components[32];
+  __m256i b0, b1, b2, b3, lo, hi, lo2, hi2, words[4], one;
+  const unsigned char * p;
+  CTMuint i, k, j, planeStride, last;
+
+  // Leave one element over for the overlapping stores of three components
+  one = _mm256_set1_epi32(1);
+  planeStride = aCount * aSize;
+  last = (aSize == 3) ? 33 : 32;
+  for(i = 0; i + last <= aCount; i += 32)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      p = aPlanes + k * aCount + i;
+      b0 = _mm256_loadu_si256((const __m256i *) p);
+      b1 = _mm256_loadu_si256((const __m256i *) (p + planeStride));
+      b2 = _mm256_loadu_si256((const __m256i *) (p + 2 * planeStride));
+      b3 = _mm256_loadu_si256((const __m256i *) (p + 3 * planeStride));
+      lo = _mm256_unpacklo_epi8(b3, b2);
+      hi = _mm256_unpackhi_epi8(b3, b2);
+      lo2 = _mm256_unpacklo_epi8(b1, b0);
+      hi2 = _mm256_unpackhi_epi8(b1, b0);
+      words[0] = _mm256_unpacklo_epi16(lo, lo2);
+      words[1] = _mm256_unpackhi_epi16(lo, lo2);
+      words[2] = _mm256_unpacklo_epi16(hi, hi2);
+      words[3] = _mm256_unpackhi_epi16(hi, hi2);
+      for(j = 0; j < 4; ++ j)
+      {
+        if(aSignedInts)
+          words[j] = _mm256_xor_si256(_mm256_srli_epi32(words[j], 1),
+            _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(words[j], one)));
+      }
+
+      if(aSize == 1)
+      {
+        // Swap the middle halves to get the elements in order
+        _mm256_storeu_si256((__m256i *) (aData + i),
+          _mm256_permute2x128_si256(words[0], words[1], 0x20));
+        _mm256_storeu_si256((__m256i *) (aData + i + 8),
+          _mm256_permute2x128_si256(words[2], words[3], 0x20));
+        _mm256_storeu_si256((__m256i *) (aData + i + 16),
+          _mm256_permute2x128_si256(words[0], words[1], 0x31));
+        _mm256_storeu_si256((__m256i *) (aData + i + 24),
+          _mm256_permute2x128_si256(words[2], words[3], 0x31));
+      }
+      else
+      {
+        for(j = 0; j < 4; ++ j)
+        {
+          components[k * 8 + j] = _mm256_castsi256_si128(words[j]);
+          components[k * 8 + 4 + j] = _mm256_extracti128_si256(words[j], 1);
+        }
+      }
+    }
+    if(aSize > 1)
+      _ctmStoreInterleaved_SSE2(aData + i * aSize, components, 8, aSize);
+  }
+
+  return i;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmPackPlanes_SSE2() - 16 elements at a time. Each byte plane is the
+// matching byte of every word, narrowed with two saturating packs (the values
+// are masked to 0-255 first, so they never saturate).
+//-----------------------------------------------------------------------------
+CTM_TARGET_SSE2
+static CTMuint _ctmPackPlanes_SSE2(const CTMint * aData, unsigned char * aPlanes,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  CTMint gathered[16];
+  __m128i words[4], mask, t[4];
+  CTMuint i, k, j, n, planeStride;
+
+  mask = _mm_set1_epi32(0xff);
+  planeStride = aCount * aSize;
+  for(i = 0; i + 16 <= aCount; i += 16)
+  {
+    for(k = 0; k < aSize; ++ k)
+    {
+      for(j = 0; j < 16; ++ j)
+        gathered[j] = aData[(i + j) * aSize + k];
+      for(j = 0; j < 4; ++ j)
+      {
+        words[j] = _mm_loadu_si128((const __m128i *) (gathered + j * 4));
+        if(aSignedInts)
+          words[j] = _ctmToSignedMagnitude_SSE2(words[j]);
+      }
+
+      // Byte n goes to plane 3 - n
+      for(n = 0; n < 4; ++ n)
+      {
+        for(j = 0; j < 4; ++ j)
+          t[j] = _mm_and_si128(_mm_srli_epi32(words[j], (int) (n * 8)), mask);
+        _mm_storeu_si128((__m128i *) (aPlanes + (3 - n) * planeStride + k * aCount + i),
+          _mm_packus_epi16(_mm_packs_epi32(t[0], t[1]), _mm_packs_epi32(t[2], t[3])));
+      }
+    }
+  }
+
+  return i;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmRestoreDeltas_SSE2() - For four components each vertex is one vector,
+// and the running sum is a plain vector add. For two components each vector
+// holds two vertices, so the first is added into the second before adding
+// the sums carried over from the vertices before them.
+//-----------------------------------------------------------------------------
+CTM_TARGET_SSE2
+static CTMuint _ctmRestoreDeltas_SSE2(const CTMint * aDeltas, CTMfloat * aValues,
+  CTMuint aCount, CTMuint aSize, CTMfloat aScale, CTMint * aPrev)
+{
+  __m128i sum, x;
+  __m128 scale;
+  CTMuint i;
+  CTMint prev[4];
+
+  scale = _mm_set1_ps(aScale);
+  if(aSize == 4)
+  {
+    sum = _mm_setzero_si128();
+    for(i = 0; i < aCount; ++ i)
+    {
+      sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *) (aDeltas + i * 4)));
+      _mm_storeu_ps(aValues + i * 4, _mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+    }
+  }
+  else if(aSize == 2)
+  {
+    sum = _mm_setzero_si128();
+    for(i = 0; i + 2 <= aCount; i += 2)
+    {
+      x = _mm_loadu_si128((const __m128i *) (aDeltas + i * 2));
+      x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+      x = _mm_add_epi32(x, sum);
+      _mm_storeu_ps(aValues + i * 2, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+      sum = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+  }
+  else
+    return 0;
+
+  // Hand the running sums over to the scalar kernel
+  _mm_storeu_si128((__m128i *) prev, sum);
+  memcpy(aPrev, prev, aSize * sizeof(CTMint));
+  return i;
+}
+
+#endif // CTM_X86_SIMD
+
+
+//-----------------------------------------------------------------------------
+// _ctmSimdLimit() - Cap the instruction set the kernels use, so that the
+// vector kernels can be tested and timed against the scalar ones. Returns the
+// level in effect afterwards.
+//-----------------------------------------------------------------------------
+int _ctmSimdLimit(int aLevel)
+{
+  _ctmSimdMax = aLevel;
+#ifdef CTM_X86_SIMD
+  return _ctmSimdLevel();
+#else
+  return CTM_SIMD_NONE;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// _ctmUnpackPlanes() - Convert an array of byte planes, as stored in packed
+// streams, to aCount elements of aSize integers. The planes hold the most
+// significant byte of every element first, and within each plane the
+// elements are grouped by component.
+//-----------------------------------------------------------------------------
+void _ctmUnpackPlanes(const unsigned char * aPlanes, CTMint * aData,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  CTMuint done = 0;
+#ifdef CTM_X86_SIMD
+  int level = _ctmSimdLevel();
+  if(level >= CTM_SIMD_AVX2)
+    done = _ctmUnpackPlanes_AVX2(aPlanes, aData, aCount, aSize, aSignedInts);
+  else if(level >= CTM_SIMD_SSE2)
+    done = _ctmUnpackPlanes_SSE2(aPlanes, aData, aCount, aSize, aSignedInts);
+#endif
+  _ctmUnpackPlanes_C(aPlanes, aData, done, aCount, aSize, aSignedInts);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmPackPlanes() - The inverse of _ctmUnpackPlanes().
+//-----------------------------------------------------------------------------
+void _ctmPackPlanes(const CTMint * aData, unsigned char * aPlanes,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  CTMuint done = 0;
+#ifdef CTM_X86_SIMD
+  if(_ctmSimdLevel() >= CTM_SIMD_SSE2)
+    done = _ctmPackPlanes_SSE2(aData, aPlanes, aCount, aSize, aSignedInts);
+#endif
+  _ctmPackPlanes_C(aData, aPlanes, done, aCount, aSize, aSignedInts);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmRestoreDeltas() - Running sums of aCount elements of aSize integer
+// deltas, converted to floats with aScale.
+//-----------------------------------------------------------------------------
+void _ctmRestoreDeltas(const CTMint * aDeltas, CTMfloat * aValues,
+  CTMuint aCount, CTMuint aSize, CTMfloat aScale)
+{
+  CTMint prev[4] = { 0, 0, 0, 0 };
+  CTMuint done = 0;
+#ifdef CTM_X86_SIMD
+  if(_ctmSimdLevel() >= CTM_SIMD_SSE2)
+    done = _ctmRestoreDeltas_SSE2(aDeltas, aValues, aCount, aSize, aScale, prev);
+#endif
+  _ctmRestoreDeltas_C(aDeltas, aValues, done, aCount, aSize, aScale, prev);
+}
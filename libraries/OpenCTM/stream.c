@@ -168,81 +168,92 @@ void _ctmStreamWriteSTRING(_CTMcontext * self, const char * aValue)
 }
 
 //-----------------------------------------------------------------------------
-// _ctmStreamReadPackedInts() - Read an compressed binary integer data array
-// from a stream, and uncompress it.
+// _ctmStreamReadPackedBlock() - Read an LZMA compressed block from a stream,
+// without uncompressing it. The caller must free aBlock->mData.
 //-----------------------------------------------------------------------------
-int _ctmStreamReadPackedInts(_CTMcontext * self, CTMint * aData,
-  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+int _ctmStreamReadPackedBlock(_CTMcontext * self, _CTMpackedblock * aBlock)
 {
-  size_t packedSize, unpackedSize;
-  CTMuint i, k, x;
-  CTMint value;
-  unsigned char * packed, * tmp;
-  unsigned char props[5];
-  int lzmaRes;
-
   // Read packed data size from the stream
-  packedSize = (size_t) _ctmStreamReadUINT(self);
+  aBlock->mSize = _ctmStreamReadUINT(self);
 
   // Read LZMA compression props from the stream
-  _ctmStreamRead(self, (void *) props, 5);
+  _ctmStreamRead(self, (void *) aBlock->mProps, 5);
 
   // Allocate memory and read the packed data from the stream
-  packed = (unsigned char *) malloc(packedSize);
-  if(!packed)
+  aBlock->mData = (unsigned char *) malloc(aBlock->mSize);
+  if(!aBlock->mData)
   {
     self->mError = CTM_OUT_OF_MEMORY;
     return CTM_FALSE;
   }
-  _ctmStreamRead(self, (void *) packed, packedSize);
+  _ctmStreamRead(self, (void *) aBlock->mData, aBlock->mSize);
+
+  return CTM_TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmUnpackInts() - Uncompress a packed block into an integer data array.
+// This does not touch the context, so several blocks can be unpacked at once
+// on different threads. Returns CTM_NONE or an error code.
+//-----------------------------------------------------------------------------
+CTMenum _ctmUnpackInts(const _CTMpackedblock * aBlock, CTMint * aData,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  size_t packedSize, unpackedSize;
+  unsigned char * tmp;
+  int lzmaRes;
 
   // Allocate memory for interleaved array
   tmp = (unsigned char *) malloc(aCount * aSize * 4);
   if(!tmp)
-  {
-    free(packed);
-    self->mError = CTM_OUT_OF_MEMORY;
-    return CTM_FALSE;
-  }
+    return CTM_OUT_OF_MEMORY;
 
   // Uncompress
+  packedSize = (size_t) aBlock->mSize;
   unpackedSize = aCount * aSize * 4;
-  lzmaRes = LzmaUncompress(tmp, &unpackedSize, packed,
-                           &packedSize, props, 5);
-
-  // Free the packed array
-  free(packed);
+  lzmaRes = LzmaUncompress(tmp, &unpackedSize, aBlock->mData,
+                           &packedSize, aBlock->mProps, 5);
 
   // Error?
   if((lzmaRes != SZ_OK) || (unpackedSize != aCount * aSize * 4))
   {
-    self->mError = CTM_LZMA_ERROR;
     free(tmp);
-    return CTM_FALSE;
+    return CTM_LZMA_ERROR;
   }
 
   // Convert interleaved array to integers
-  for(i = 0; i < aCount; ++ i)
-  {
-    for(k = 0; k < aSize; ++ k)
-    {
-      value = (CTMint) tmp[i + k * aCount + 3 * aCount * aSize] |
-              (((CTMint) tmp[i + k * aCount + 2 * aCount * aSize]) << 8) |
-              (((CTMint) tmp[i + k * aCount + aCount * aSize]) << 16) |
-              (((CTMint) tmp[i + k * aCount]) << 24);
-      // Convert signed magnitude to two's complement?
-      if(aSignedInts)
-      {
-        x = (CTMuint) value;
-        value = (x & 1) ? -(CTMint)((x + 1) >> 1) : (CTMint)(x >> 1);
-      }
-      aData[i * aSize + k] = value;
-    }
-  }
+  _ctmUnpackPlanes(tmp, aData, aCount, aSize, aSignedInts);
 
   // Free the interleaved array
   free(tmp);
 
+  return CTM_NONE;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmStreamReadPackedInts() - Read an compressed binary integer data array
+// from a stream, and uncompress it.
+//-----------------------------------------------------------------------------
+int _ctmStreamReadPackedInts(_CTMcontext * self, CTMint * aData,
+  CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
+{
+  _CTMpackedblock block;
+  CTMenum err;
+
+  if(!_ctmStreamReadPackedBlock(self, &block))
+    return CTM_FALSE;
+
+  err = _ctmUnpackInts(&block, aData, aCount, aSize, aSignedInts);
+
+  // Free the packed array
+  free(block.mData);
+
+  if(err != CTM_NONE)
+  {
+    self->mError = err;
+    return CTM_FALSE;
+  }
+
   return CTM_TRUE;
 }
 
@@ -254,12 +265,10 @@ int _ctmStreamWritePackedInts(_CTMcontext * self, CTMint * aData,
   CTMuint aCount, CTMuint aSize, CTMint aSignedInts)
 {
   int lzmaRes, lzmaAlgo;
-  CTMuint i, k;
-  CTMint value;
   size_t bufSize, outPropsSize;
   unsigned char * packed, outProps[5], *tmp;
 #ifdef __DEBUG_
-  CTMuint negCount = 0;  
+  CTMuint i, negCount = 0;  
 #endif
 
   // Allocate memory for interleaved array
@@ -271,24 +280,17 @@ int _ctmStreamWritePackedInts(_CTMcontext * self, CTMint * aData,
   }
 
   // Convert integers to an interleaved array
-  for(i = 0; i < aCount; ++ i)
+  _ctmPackPlanes(aData, tmp, aCount, aSize, aSignedInts);
+#ifdef __DEBUG_
+  if(!aSignedInts)
   {
-    for(k = 0; k < aSize; ++ k)
+    for(i = 0; i < aCount * aSize; ++ i)
     {
-      value = aData[i * aSize + k];
-      // Convert two's complement to signed magnitude?
-      if(aSignedInts)
-        value = value < 0 ? -1 - (value << 1) : value << 1;
-#ifdef __DEBUG_
-      else if(value < 0)
+      if(aData[i] < 0)
         ++ negCount;
-#endif
-      tmp[i + k * aCount + 3 * aCount * aSize] = value & 0x000000ff;
-      tmp[i + k * aCount + 2 * aCount * aSize] = (value >> 8) & 0x000000ff;
-      tmp[i + k * aCount + aCount * aSize] = (value >> 16) & 0x000000ff;
-      tmp[i + k * aCount] = (value >> 24) & 0x000000ff;
     }
   }
+#endif
 
   // Allocate memory for the packed data
   bufSize = 1000 + aCount * aSize * 4;
@@ -351,73 +353,10 @@ int _ctmStreamWritePackedInts(_CTMcontext * self, CTMint * aData,
 int _ctmStreamReadPackedFloats(_CTMcontext * self, CTMfloat * aData,
   CTMuint aCount, CTMuint aSize)
 {
-  CTMuint i, k;
-  size_t packedSize, unpackedSize;
-  union {
-    CTMfloat f;
-    CTMint i;
-  } value;
-  unsigned char * packed, * tmp;
-  unsigned char props[5];
-  int lzmaRes;
-
-  // Read packed data size from the stream
-  packedSize = (size_t) _ctmStreamReadUINT(self);
-
-  // Read LZMA compression props from the stream
-  _ctmStreamRead(self, (void *) props, 5);
-
-  // Allocate memory and read the packed data from the stream
-  packed = (unsigned char *) malloc(packedSize);
-  if(!packed)
-  {
-    self->mError = CTM_OUT_OF_MEMORY;
-    return CTM_FALSE;
-  }
-  _ctmStreamRead(self, (void *) packed, packedSize);
-
-  // Allocate memory for interleaved array
-  tmp = (unsigned char *) malloc(aCount * aSize * 4);
-  if(!tmp)
-  {
-    free(packed);
-    self->mError = CTM_OUT_OF_MEMORY;
-    return CTM_FALSE;
-  }
-
-  // Uncompress
-  unpackedSize = aCount * aSize * 4;
-  lzmaRes = LzmaUncompress(tmp, &unpackedSize, packed,
-                           &packedSize, props, 5);
-
-  // Free the packed array
-  free(packed);
-
-  // Error?
-  if((lzmaRes != SZ_OK) || (unpackedSize != aCount * aSize * 4))
-  {
-    self->mError = CTM_LZMA_ERROR;
-    free(tmp);
-    return CTM_FALSE;
-  }
-
-  // Convert interleaved array to floats
-  for(i = 0; i < aCount; ++ i)
-  {
-    for(k = 0; k < aSize; ++ k)
-    {
-      value.i = (CTMint) tmp[i + k * aCount + 3 * aCount * aSize] |
-                (((CTMint) tmp[i + k * aCount + 2 * aCount * aSize]) << 8) |
-                (((CTMint) tmp[i + k * aCount + aCount * aSize]) << 16) |
-                (((CTMint) tmp[i + k * aCount]) << 24);
-      aData[i * aSize + k] = value.f;
-    }
-  }
-
-  // Free the interleaved array
-  free(tmp);
-
-  return CTM_TRUE;
+  // Floats are stored as their bit patterns, so this is the same as reading
+  // unsigned integers
+  return _ctmStreamReadPackedInts(self, (CTMint *) aData, aCount, aSize,
+                                  CTM_FALSE);
 }
 
 //-----------------------------------------------------------------------------
@@ -428,11 +367,6 @@ int _ctmStreamWritePackedFloats(_CTMcontext * self, CTMfloat * aData,
   CTMuint aCount, CTMuint aSize)
 {
   int lzmaRes, lzmaAlgo;
-  CTMuint i, k;
-  union {
-    CTMfloat f;
-    CTMint i;
-  } value;
   size_t bufSize, outPropsSize;
   unsigned char * packed, outProps[5], *tmp;
 
@@ -444,18 +378,8 @@ int _ctmStreamWritePackedFloats(_CTMcontext * self, CTMfloat * aData,
     return CTM_FALSE;
   }
 
-  // Convert floats to an interleaved array
-  for(i = 0; i < aCount; ++ i)
-  {
-    for(k = 0; k < aSize; ++ k)
-    {
-      value.f = aData[i * aSize + k];
-      tmp[i + k * aCount + 3 * aCount * aSize] = value.i & 0x000000ff;
-      tmp[i + k * aCount + 2 * aCount * aSize] = (value.i >> 8) & 0x000000ff;
-      tmp[i + k * aCount + aCount * aSize] = (value.i >> 16) & 0x000000ff;
-      tmp[i + k * aCount] = (value.i >> 24) & 0x000000ff;
-    }
-  }
+  // Convert floats to an interleaved array (as their bit patterns)
+  _ctmPackPlanes((const CTMint *) aData, tmp, aCount, aSize, CTM_FALSE);
 
   // Allocate memory for the packed data
   bufSize = 1000 + aCount * aSize * 4;
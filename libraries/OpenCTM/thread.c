@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+// Product:     OpenCTM
+// File:        thread.c
+// Description: Minimal thread support for the parallel decoders.
+//-----------------------------------------------------------------------------
+// This file is an addition to the original OpenCTM distribution, and is
+// provided under the same terms as the rest of the library.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//     distribution.
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "openctm.h"
+#include "internal.h"
+
+#if defined(CTM_NO_THREADS)
+// Everything runs on the calling thread
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define CTM_WIN32_THREADS
+#else
+#include <pthread.h>
+#include <unistd.h>
+#define CTM_POSIX_THREADS
+#endif
+
+// Upper limit for the number of decoding threads
+#define CTM_MAX_THREADS 16
+
+//-----------------------------------------------------------------------------
+// _CTMstripe - Every mStride:th job, starting at mFirst.
+//-----------------------------------------------------------------------------
+typedef struct {
+  _CTMjob * mJobs;
+  CTMuint mCount;
+  CTMuint mFirst;
+  CTMuint mStride;
+} _CTMstripe;
+
+//-----------------------------------------------------------------------------
+// _ctmRunStripe() - Run all the jobs in a stripe.
+//-----------------------------------------------------------------------------
+static void _ctmRunStripe(_CTMstripe * aStripe)
+{
+  CTMuint i;
+  for(i = aStripe->mFirst; i < aStripe->mCount; i += aStripe->mStride)
+    aStripe->mJobs[i].mFunc(aStripe->mJobs[i].mArg);
+}
+
+#if defined(CTM_WIN32_THREADS)
+static DWORD WINAPI _ctmThreadMain(LPVOID aArg)
+{
+  _ctmRunStripe((_CTMstripe *) aArg);
+  return 0;
+}
+#elif defined(CTM_POSIX_THREADS)
+static void * _ctmThreadMain(void * aArg)
+{
+  _ctmRunStripe((_CTMstripe *) aArg);
+  return NULL;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// _ctmProcessorCount() - Number of processors available to this process.
+//-----------------------------------------------------------------------------
+CTMuint _ctmProcessorCount(void)
+{
+#if defined(CTM_WIN32_THREADS)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (CTMuint) info.dwNumberOfProcessors : 1;
+#elif defined(CTM_POSIX_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (CTMuint) count : 1;
+#else
+  return 1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// _ctmDecodeThreads() - Number of threads to decode with for this context.
+//-----------------------------------------------------------------------------
+CTMuint _ctmDecodeThreads(_CTMcontext * self)
+{
+  CTMuint count = self->mDecodeThreads;
+  if(count == 0)
+    count = _ctmProcessorCount();
+#if defined(CTM_NO_THREADS)
+  count = 1;
+#endif
+  return count > CTM_MAX_THREADS ? CTM_MAX_THREADS : count;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmRunJobs() - Run a set of independent jobs on up to aThreads threads
+// (including the calling thread), and wait for all of them to finish. The
+// jobs are dealt out round robin. If a thread can't be started, its share of
+// the jobs is run on the calling thread instead.
+//-----------------------------------------------------------------------------
+void _ctmRunJobs(_CTMjob * aJobs, CTMuint aCount, CTMuint aThreads)
+{
+  _CTMstripe stripes[CTM_MAX_THREADS];
+  CTMuint i;
+#if defined(CTM_WIN32_THREADS)
+  HANDLE threads[CTM_MAX_THREADS];
+#elif defined(CTM_POSIX_THREADS)
+  pthread_t threads[CTM_MAX_THREADS];
+  int started[CTM_MAX_THREADS];
+#endif
+
+  if(aThreads > aCount)
+    aThreads = aCount;
+  if(aThreads > CTM_MAX_THREADS)
+    aThreads = CTM_MAX_THREADS;
+  if(aThreads < 1)
+    aThreads = 1;
+
+  for(i = 0; i < aThreads; ++ i)
+  {
+    stripes[i].mJobs = aJobs;
+    stripes[i].mCount = aCount;
+    stripes[i].mFirst = i;
+    stripes[i].mStride = aThreads;
+  }
+
+#if defined(CTM_WIN32_THREADS)
+  for(i = 1; i < aThreads; ++ i)
+    threads[i] = CreateThread(NULL, 0, _ctmThreadMain, &stripes[i], 0, NULL);
+  _ctmRunStripe(&stripes[0]);
+  for(i = 1; i < aThreads; ++ i)
+  {
+    if(threads[i])
+    {
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+    }
+    else
+      _ctmRunStripe(&stripes[i]);
+  }
+#elif defined(CTM_POSIX_THREADS)
+  for(i = 1; i < aThreads; ++ i)
+    started[i] = (pthread_create(&threads[i], NULL, _ctmThreadMain, &stripes[i]) == 0);
+  _ctmRunStripe(&stripes[0]);
+  for(i = 1; i < aThreads; ++ i)
+  {
+    if(started[i])
+      pthread_join(threads[i], NULL);
+    else
+      _ctmRunStripe(&stripes[i]);
+  }
+#else
+  for(i = 0; i < aThreads; ++ i)
+    _ctmRunStripe(&stripes[i]);
+#endif
+}
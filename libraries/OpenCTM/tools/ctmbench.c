@@ -0,0 +1,239 @@
+//-----------------------------------------------------------------------------
+// Product:     OpenCTM
+// File:        ctmbench.c
+// Description: Throughput of the packed stream kernels for each instruction
+//              set, and of MG2 decoding a large synthetic mesh on different
+//              numbers of threads.
+//
+//              Usage: ctmbench [grid side] [CSV file]
+//
+//              The default side of 725 gives a mesh of just over a million
+//              triangles, with normals, a UV map and an attribute map.
+//-----------------------------------------------------------------------------
+// This file is an addition to the original OpenCTM distribution, and is
+// provided under the same terms as the rest of the library.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//     distribution.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "ctmtools.h"
+#include "internal.h"
+
+#define REPEATS 5
+
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2" };
+
+//-----------------------------------------------------------------------------
+// _CTMkernelbench - Buffers for timing the kernels. Every kernel is fed the
+// same number of integers, three components per element.
+//-----------------------------------------------------------------------------
+typedef struct {
+  CTMuint mCount;
+  unsigned char * mPlanes;
+  CTMint * mInts;
+  CTMint * mDeltas;
+  CTMfloat * mFloats;
+} _CTMkernelbench;
+
+//-----------------------------------------------------------------------------
+// _ctmBenchKernel() - Best time of a few runs of one kernel, in seconds.
+//-----------------------------------------------------------------------------
+static double _ctmBenchKernel(_CTMkernelbench * aBench, int aKernel)
+{
+  double best = 1e30, start, elapsed;
+  CTMuint ints = aBench->mCount * 3;
+  int r;
+  for(r = 0; r < REPEATS; ++ r)
+  {
+    start = _ctmToolSeconds();
+    switch(aKernel)
+    {
+      case 0:
+        _ctmUnpackPlanes(aBench->mPlanes, aBench->mInts, aBench->mCount, 3, CTM_TRUE);
+        break;
+      case 1:
+        _ctmPackPlanes(aBench->mInts, aBench->mPlanes, aBench->mCount, 3, CTM_TRUE);
+        break;
+      case 2:
+        _ctmRestoreDeltas(aBench->mDeltas, aBench->mFloats, ints / 2, 2, 0.001f);
+        break;
+      default:
+        _ctmRestoreDeltas(aBench->mDeltas, aBench->mFloats, ints / 4, 4, 0.001f);
+        break;
+    }
+    elapsed = _ctmToolSeconds() - start;
+    if(elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmBenchDecode() - Best time of a few decodes of aBuffer, in seconds, or a
+// negative value if it doesn't load.
+//-----------------------------------------------------------------------------
+static double _ctmBenchDecode(_CTMtoolbuffer * aBuffer, CTMuint aThreads)
+{
+  double best = 1e30, start, elapsed;
+  CTMcontext context;
+  CTMenum error;
+  int r;
+  for(r = 0; r < REPEATS; ++ r)
+  {
+    context = ctmNewContext(CTM_IMPORT);
+    ctmDecodeThreads(context, aThreads);
+    aBuffer->mOffset = 0;
+    start = _ctmToolSeconds();
+    ctmLoadCustom(context, _ctmToolRead, aBuffer);
+    elapsed = _ctmToolSeconds() - start;
+    error = ctmGetError(context);
+    ctmFreeContext(context);
+    if(error != CTM_NONE)
+    {
+      printf("Load failed: %s\n", ctmErrorString(error));
+      return -1.0;
+    }
+    if(elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char ** argv)
+{
+  static const char * kernelNames[] = { "unpack x3", "pack x3", "deltas x2", "deltas x4" };
+  static const CTMuint threads[] = { 1, 2, 4, 8, 16 };
+  CTMuint side = argc > 1 ? (CTMuint) atoi(argv[1]) : 725;
+  FILE * csv = NULL;
+  _CTMkernelbench bench;
+  _CTMtoolmesh mesh;
+  _CTMtoolbuffer buffer;
+  CTMuint state = 12345, i, t, processors = _ctmProcessorCount();
+  size_t bytes, decodedBytes;
+  double scalarSeconds = 0.0;
+  int bestLevel, level, k;
+  CTMenum error;
+
+  if(argc > 2)
+  {
+    csv = fopen(argv[2], "w");
+    if(!csv)
+    {
+      printf("Unable to write %s\n", argv[2]);
+      return 1;
+    }
+    fprintf(csv, "test,simd,threads,ms,MBps\n");
+  }
+
+  bestLevel = _ctmSimdLimit(CTM_SIMD_AVX2);
+
+  // Kernels, on 48 MB of integers
+  bench.mCount = 4 << 20;
+  bytes = sizeof(CTMint) * 3 * (size_t) bench.mCount;
+  bench.mPlanes = (unsigned char *) malloc(bytes);
+  bench.mInts = (CTMint *) malloc(bytes);
+  bench.mDeltas = (CTMint *) malloc(bytes);
+  bench.mFloats = (CTMfloat *) malloc(bytes);
+  if(!bench.mPlanes || !bench.mInts || !bench.mDeltas || !bench.mFloats)
+  {
+    printf("Out of memory\n");
+    return 1;
+  }
+  for(i = 0; i < bench.mCount * 3; ++ i)
+    bench.mDeltas[i] = (CTMint) (_ctmToolRandom(&state) % 2001) - 1000;
+  for(i = 0; i < bench.mCount * 12; ++ i)
+    bench.mPlanes[i] = (unsigned char) _ctmToolRandom(&state);
+
+  printf("%-10s %-7s %10s %8s\n", "kernel", "simd", "MB/s", "speedup");
+  for(k = 0; k < 4; ++ k)
+  {
+    double scalar = 0.0;
+    for(level = CTM_SIMD_NONE; level <= bestLevel; ++ level)
+    {
+      double seconds;
+      _ctmSimdLimit(level);
+      seconds = _ctmBenchKernel(&bench, k);
+      if(level == CTM_SIMD_NONE)
+        scalar = seconds;
+      printf("%-10s %-7s %10.0f %8.2f\n", kernelNames[k], SIMD_NAMES[level],
+        bytes / seconds / 1e6, scalar / seconds);
+      if(csv)
+        fprintf(csv, "%s,%s,1,%f,%f\n", kernelNames[k], SIMD_NAMES[level],
+          seconds * 1e3, bytes / seconds / 1e6);
+    }
+  }
+  free(bench.mPlanes);
+  free(bench.mInts);
+  free(bench.mDeltas);
+  free(bench.mFloats);
+
+  // MG2 decode of the synthetic mesh. The throughput is of the decoded
+  // arrays.
+  if(!_ctmToolMakeGrid(&mesh, side))
+  {
+    printf("Out of memory\n");
+    return 1;
+  }
+  _ctmSimdLimit(bestLevel);
+  error = _ctmToolEncode(&mesh, CTM_METHOD_MG2, &buffer);
+  if(error != CTM_NONE)
+  {
+    printf("Encode failed: %s\n", ctmErrorString(error));
+    return 1;
+  }
+  decodedBytes = sizeof(CTMfloat) * 12 * (size_t) mesh.mVertexCount +
+    sizeof(CTMuint) * 3 * (size_t) mesh.mTriangleCount;
+  printf("\nMG2 mesh: %u vertices, %u triangles, %u KB compressed, %u processors\n",
+    mesh.mVertexCount, mesh.mTriangleCount, (CTMuint) (buffer.mSize / 1024), processors);
+  printf("%-7s %8s %10s %10s %8s\n", "simd", "threads", "ms", "MB/s", "speedup");
+  // The scalar kernels on one thread are the baseline, then the best
+  // kernels on every thread count up to the number of processors
+  for(k = 0; k < 2; ++ k)
+  {
+    level = k ? bestLevel : CTM_SIMD_NONE;
+    _ctmSimdLimit(level);
+    for(t = 0; t < sizeof(threads) / sizeof(threads[0]); ++ t)
+    {
+      double seconds;
+      if((!k && t > 0) || (t > 0 && threads[t] > processors))
+        break;
+      seconds = _ctmBenchDecode(&buffer, threads[t]);
+      if(seconds < 0.0)
+        return 1;
+      if(!k)
+        scalarSeconds = seconds;
+      printf("%-7s %8u %10.1f %10.0f %8.2f\n", SIMD_NAMES[level], threads[t],
+        seconds * 1e3, decodedBytes / seconds / 1e6, scalarSeconds / seconds);
+      if(csv)
+        fprintf(csv, "MG2 decode,%s,%u,%f,%f\n", SIMD_NAMES[level], threads[t],
+          seconds * 1e3, decodedBytes / seconds / 1e6);
+    }
+  }
+
+  _ctmToolFreeMesh(&mesh);
+  free(buffer.mData);
+  if(csv)
+    fclose(csv);
+  return 0;
+}
@@ -0,0 +1,274 @@
+//-----------------------------------------------------------------------------
+// Product:     OpenCTM
+// File:        ctmtest.c
+// Description: Checks that the vector kernels and the threaded MG2 decoder
+//              give exactly the same results as the scalar, single threaded
+//              code. Exits with the number of failed checks.
+//-----------------------------------------------------------------------------
+// This file is an addition to the original OpenCTM distribution, and is
+// provided under the same terms as the rest of the library.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//     distribution.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "ctmtools.h"
+#include "internal.h"
+
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2" };
+
+//-----------------------------------------------------------------------------
+// _ctmTestKernels() - Run every kernel at aLevel and at the scalar level on
+// the same random input, for each element size, signedness and a range of
+// counts that leave different tails for the scalar code. Returns the number
+// of mismatches.
+//-----------------------------------------------------------------------------
+static int _ctmTestKernels(int aLevel)
+{
+  static const CTMuint counts[] = { 0, 1, 15, 16, 17, 31, 32, 33, 47, 64, 100, 1001, 4099 };
+  CTMuint state = 12345, size, c, i;
+  CTMint signedInts;
+  int failures = 0;
+
+  for(size = 1; size <= 4; ++ size)
+  {
+    for(c = 0; c < sizeof(counts) / sizeof(counts[0]); ++ c)
+    {
+      for(signedInts = 0; signedInts <= 1; ++ signedInts)
+      {
+        CTMuint count = counts[c], n = count * size;
+        size_t bytes = sizeof(CTMint) * n + 1;
+        unsigned char * planes = (unsigned char *) malloc(bytes);
+        unsigned char * packed = (unsigned char *) malloc(bytes);
+        unsigned char * expectedPacked = (unsigned char *) malloc(bytes);
+        CTMint * ints = (CTMint *) malloc(bytes);
+        CTMint * expectedInts = (CTMint *) malloc(bytes);
+        for(i = 0; i < n * 4; ++ i)
+          planes[i] = (unsigned char) _ctmToolRandom(&state);
+
+        // Unpack, then pack the result again, which must give back the
+        // original planes
+        _ctmSimdLimit(CTM_SIMD_NONE);
+        _ctmUnpackPlanes(planes, expectedInts, count, size, signedInts);
+        _ctmPackPlanes(expectedInts, expectedPacked, count, size, signedInts);
+        _ctmSimdLimit(aLevel);
+        _ctmUnpackPlanes(planes, ints, count, size, signedInts);
+        _ctmPackPlanes(ints, packed, count, size, signedInts);
+        if(memcmp(ints, expectedInts, sizeof(CTMint) * n))
+        {
+          printf("  unpack mismatch: size %u, count %u, signed %d\n", size, count, signedInts);
+          ++ failures;
+        }
+        if(memcmp(packed, expectedPacked, n * 4) || memcmp(packed, planes, n * 4))
+        {
+          printf("  pack mismatch: size %u, count %u, signed %d\n", size, count, signedInts);
+          ++ failures;
+        }
+
+        // The UV and attribute maps are restored from deltas two and four
+        // components at a time
+        if(size == 2 || size == 4)
+        {
+          CTMfloat * values = (CTMfloat *) malloc(bytes);
+          CTMfloat * expectedValues = (CTMfloat *) malloc(bytes);
+          for(i = 0; i < n; ++ i)
+            ints[i] = (CTMint) (_ctmToolRandom(&state) % 2001) - 1000;
+          _ctmSimdLimit(CTM_SIMD_NONE);
+          _ctmRestoreDeltas(ints, expectedValues, count, size, 0.001f);
+          _ctmSimdLimit(aLevel);
+          _ctmRestoreDeltas(ints, values, count, size, 0.001f);
+          if(memcmp(values, expectedValues, sizeof(CTMfloat) * n))
+          {
+            printf("  delta restore mismatch: size %u, count %u\n", size, count);
+            ++ failures;
+          }
+          free(values);
+          free(expectedValues);
+        }
+
+        free(planes);
+        free(packed);
+        free(expectedPacked);
+        free(ints);
+        free(expectedInts);
+      }
+    }
+  }
+  return failures;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmTestDecode() - Decode aBuffer with aThreads threads and compare every
+// array with aExpected. If aExpected is empty, it is filled in instead.
+// Returns the number of mismatches.
+//-----------------------------------------------------------------------------
+static int _ctmTestDecode(_CTMtoolbuffer * aBuffer, CTMuint aThreads,
+  _CTMtoolmesh * aExpected)
+{
+  CTMcontext context = ctmNewContext(CTM_IMPORT);
+  CTMuint vertexCount, triangleCount;
+  const CTMfloat * arrays[4];
+  const CTMuint * indices;
+  CTMfloat ** expected[4];
+  size_t sizes[4];
+  int failures = 0, i;
+
+  ctmDecodeThreads(context, aThreads);
+  aBuffer->mOffset = 0;
+  ctmLoadCustom(context, _ctmToolRead, aBuffer);
+  if(ctmGetError(context) != CTM_NONE)
+  {
+    printf("  load failed: %s\n", ctmErrorString(ctmGetError(context)));
+    ctmFreeContext(context);
+    return 1;
+  }
+
+  vertexCount = ctmGetInteger(context, CTM_VERTEX_COUNT);
+  triangleCount = ctmGetInteger(context, CTM_TRIANGLE_COUNT);
+  arrays[0] = ctmGetFloatArray(context, CTM_VERTICES);
+  arrays[1] = ctmGetFloatArray(context, CTM_NORMALS);
+  arrays[2] = ctmGetFloatArray(context, CTM_UV_MAP_1);
+  arrays[3] = ctmGetFloatArray(context, CTM_ATTRIB_MAP_1);
+  indices = ctmGetIntegerArray(context, CTM_INDICES);
+  expected[0] = &aExpected->mVertices;
+  expected[1] = &aExpected->mNormals;
+  expected[2] = &aExpected->mUVs;
+  expected[3] = &aExpected->mAttribs;
+  sizes[0] = sizeof(CTMfloat) * 3 * vertexCount;
+  sizes[1] = sizeof(CTMfloat) * 3 * vertexCount;
+  sizes[2] = sizeof(CTMfloat) * 2 * vertexCount;
+  sizes[3] = sizeof(CTMfloat) * 4 * vertexCount;
+
+  if(!aExpected->mIndices)
+  {
+    aExpected->mVertexCount = vertexCount;
+    aExpected->mTriangleCount = triangleCount;
+    aExpected->mIndices = (CTMuint *) malloc(sizeof(CTMuint) * 3 * triangleCount);
+    memcpy(aExpected->mIndices, indices, sizeof(CTMuint) * 3 * triangleCount);
+    for(i = 0; i < 4; ++ i)
+    {
+      *expected[i] = (CTMfloat *) malloc(sizes[i]);
+      memcpy(*expected[i], arrays[i], sizes[i]);
+    }
+  }
+  else if(vertexCount != aExpected->mVertexCount ||
+          triangleCount != aExpected->mTriangleCount ||
+          memcmp(indices, aExpected->mIndices, sizeof(CTMuint) * 3 * triangleCount))
+  {
+    ++ failures;
+  }
+  else
+  {
+    for(i = 0; i < 4; ++ i)
+      if(memcmp(arrays[i], *expected[i], sizes[i]))
+        ++ failures;
+  }
+
+  ctmFreeContext(context);
+  return failures;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmTestMethod() - Encode aMesh with aMethod and check that every thread
+// count and instruction set decodes it exactly as the scalar code on one
+// thread does. Returns the number of mismatches.
+//-----------------------------------------------------------------------------
+static int _ctmTestMethod(const _CTMtoolmesh * aMesh, CTMenum aMethod,
+  const char * aName, int aBestLevel)
+{
+  static const CTMuint threads[] = { 1, 2, 3, 5, 16 };
+  _CTMtoolbuffer buffer;
+  _CTMtoolmesh expected;
+  CTMenum error;
+  CTMuint t;
+  int level, failures = 0;
+
+  // Encode with the scalar packer, so the stream doesn't depend on the
+  // kernels being tested
+  _ctmSimdLimit(CTM_SIMD_NONE);
+  error = _ctmToolEncode(aMesh, aMethod, &buffer);
+  if(error != CTM_NONE)
+  {
+    printf("%s: encode failed: %s\n", aName, ctmErrorString(error));
+    free(buffer.mData);
+    return 1;
+  }
+
+  memset(&expected, 0, sizeof(expected));
+  failures += _ctmTestDecode(&buffer, 1, &expected);
+  for(level = CTM_SIMD_NONE; level <= aBestLevel; ++ level)
+  {
+    _ctmSimdLimit(level);
+    for(t = 0; t < sizeof(threads) / sizeof(threads[0]); ++ t)
+    {
+      int mismatches = _ctmTestDecode(&buffer, threads[t], &expected);
+      if(mismatches)
+        printf("  %s: %s on %u threads differs\n", aName, SIMD_NAMES[level], threads[t]);
+      failures += mismatches;
+    }
+  }
+
+  // RAW stores the floats and indices as they are
+  if(aMethod == CTM_METHOD_RAW && !failures &&
+     (memcmp(expected.mVertices, aMesh->mVertices, sizeof(CTMfloat) * 3 * aMesh->mVertexCount) ||
+      memcmp(expected.mIndices, aMesh->mIndices, sizeof(CTMuint) * 3 * aMesh->mTriangleCount)))
+  {
+    printf("  %s: decoded mesh differs from the input\n", aName);
+    ++ failures;
+  }
+
+  printf("%s: %s\n", aName, failures ? "FAILED" : "identical");
+  _ctmToolFreeMesh(&expected);
+  free(buffer.mData);
+  return failures;
+}
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(void)
+{
+  _CTMtoolmesh mesh;
+  int bestLevel, level, failures = 0;
+
+  bestLevel = _ctmSimdLimit(CTM_SIMD_AVX2);
+  printf("Best instruction set: %s\n", SIMD_NAMES[bestLevel]);
+
+  for(level = CTM_SIMD_SSE2; level <= bestLevel; ++ level)
+  {
+    int mismatches = _ctmTestKernels(level);
+    printf("%s kernels: %s\n", SIMD_NAMES[level], mismatches ? "FAILED" : "match scalar");
+    failures += mismatches;
+  }
+
+  // Large enough (90000 vertices) for the threaded MG2 decoder
+  if(!_ctmToolMakeGrid(&mesh, 300))
+  {
+    printf("Out of memory\n");
+    return 1;
+  }
+  failures += _ctmTestMethod(&mesh, CTM_METHOD_RAW, "RAW", bestLevel);
+  failures += _ctmTestMethod(&mesh, CTM_METHOD_MG1, "MG1", bestLevel);
+  failures += _ctmTestMethod(&mesh, CTM_METHOD_MG2, "MG2", bestLevel);
+  _ctmToolFreeMesh(&mesh);
+
+  printf("%d failures\n", failures);
+  return failures;
+}
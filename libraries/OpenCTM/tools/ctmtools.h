@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+// Product:     OpenCTM
+// File:        ctmtools.h
+// Description: Synthetic meshes, in-memory streams and timing for the test
+//              and benchmark tools.
+//-----------------------------------------------------------------------------
+// This file is an addition to the original OpenCTM distribution, and is
+// provided under the same terms as the rest of the library.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//     distribution.
+//-----------------------------------------------------------------------------
+
+#ifndef __OPENCTM_TOOLS_H_
+#define __OPENCTM_TOOLS_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "openctm.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// _CTMtoolmesh - A mesh with normals, one UV map and one attribute map.
+//-----------------------------------------------------------------------------
+typedef struct {
+  CTMuint mVertexCount;
+  CTMuint mTriangleCount;
+  CTMfloat * mVertices;
+  CTMfloat * mNormals;
+  CTMfloat * mUVs;
+  CTMfloat * mAttribs;
+  CTMuint * mIndices;
+} _CTMtoolmesh;
+
+//-----------------------------------------------------------------------------
+// _CTMtoolbuffer - A growable memory buffer, written with ctmSaveCustom() and
+// read back with ctmLoadCustom().
+//-----------------------------------------------------------------------------
+typedef struct {
+  unsigned char * mData;
+  size_t mSize;
+  size_t mCapacity;
+  size_t mOffset;
+} _CTMtoolbuffer;
+
+//-----------------------------------------------------------------------------
+// _ctmToolSeconds() - A monotonic clock.
+//-----------------------------------------------------------------------------
+static double _ctmToolSeconds(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (double) count.QuadPart / (double) frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolRandom() - A small, repeatable random number generator.
+//-----------------------------------------------------------------------------
+static CTMuint _ctmToolRandom(CTMuint * aState)
+{
+  *aState = *aState * 1103515245u + 12345u;
+  return (*aState >> 8) ^ (*aState << 20);
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolMakeGrid() - A rippled aSide x aSide grid of vertices, with two
+// triangles per cell. A side of 725 gives just over a million triangles.
+//-----------------------------------------------------------------------------
+static int _ctmToolMakeGrid(_CTMtoolmesh * aMesh, CTMuint aSide)
+{
+  CTMuint i, j, k, t = 0;
+  aMesh->mVertexCount = aSide * aSide;
+  aMesh->mTriangleCount = 2 * (aSide - 1) * (aSide - 1);
+  aMesh->mVertices = (CTMfloat *) malloc(sizeof(CTMfloat) * 3 * aMesh->mVertexCount);
+  aMesh->mNormals = (CTMfloat *) malloc(sizeof(CTMfloat) * 3 * aMesh->mVertexCount);
+  aMesh->mUVs = (CTMfloat *) malloc(sizeof(CTMfloat) * 2 * aMesh->mVertexCount);
+  aMesh->mAttribs = (CTMfloat *) malloc(sizeof(CTMfloat) * 4 * aMesh->mVertexCount);
+  aMesh->mIndices = (CTMuint *) malloc(sizeof(CTMuint) * 3 * aMesh->mTriangleCount);
+  if(!aMesh->mVertices || !aMesh->mNormals || !aMesh->mUVs ||
+     !aMesh->mAttribs || !aMesh->mIndices)
+    return 0;
+
+  for(i = 0; i < aSide; ++ i)
+  {
+    for(j = 0; j < aSide; ++ j)
+    {
+      CTMfloat x = (CTMfloat) j / (CTMfloat) aSide;
+      CTMfloat y = (CTMfloat) i / (CTMfloat) aSide;
+      CTMfloat z = sinf(x * 20.0f) * cosf(y * 17.0f) * 0.1f;
+      CTMfloat nx = -cosf(x * 20.0f), ny = sinf(y * 17.0f);
+      CTMfloat len = sqrtf(nx * nx + ny * ny + 1.0f);
+      k = i * aSide + j;
+      aMesh->mVertices[k * 3] = x;
+      aMesh->mVertices[k * 3 + 1] = y;
+      aMesh->mVertices[k * 3 + 2] = z;
+      aMesh->mNormals[k * 3] = nx / len;
+      aMesh->mNormals[k * 3 + 1] = ny / len;
+      aMesh->mNormals[k * 3 + 2] = 1.0f / len;
+      aMesh->mUVs[k * 2] = x;
+      aMesh->mUVs[k * 2 + 1] = y;
+      aMesh->mAttribs[k * 4] = z;
+      aMesh->mAttribs[k * 4 + 1] = x * y;
+      aMesh->mAttribs[k * 4 + 2] = 1.0f;
+      aMesh->mAttribs[k * 4 + 3] = x;
+    }
+  }
+
+  for(i = 0; i < aSide - 1; ++ i)
+  {
+    for(j = 0; j < aSide - 1; ++ j)
+    {
+      k = i * aSide + j;
+      aMesh->mIndices[t ++] = k;
+      aMesh->mIndices[t ++] = k + 1;
+      aMesh->mIndices[t ++] = k + aSide;
+      aMesh->mIndices[t ++] = k + 1;
+      aMesh->mIndices[t ++] = k + aSide + 1;
+      aMesh->mIndices[t ++] = k + aSide;
+    }
+  }
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolFreeMesh() - Free the arrays of a mesh.
+//-----------------------------------------------------------------------------
+static void _ctmToolFreeMesh(_CTMtoolmesh * aMesh)
+{
+  free(aMesh->mVertices);
+  free(aMesh->mNormals);
+  free(aMesh->mUVs);
+  free(aMesh->mAttribs);
+  free(aMesh->mIndices);
+  memset(aMesh, 0, sizeof(_CTMtoolmesh));
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolWrite() - CTMwritefn for a _CTMtoolbuffer.
+//-----------------------------------------------------------------------------
+static CTMuint CTMCALL _ctmToolWrite(const void * aBuf, CTMuint aCount,
+  void * aUserData)
+{
+  _CTMtoolbuffer * buffer = (_CTMtoolbuffer *) aUserData;
+  if(buffer->mSize + aCount > buffer->mCapacity)
+  {
+    size_t capacity = (buffer->mSize + aCount) * 2;
+    unsigned char * data = (unsigned char *) realloc(buffer->mData, capacity);
+    if(!data)
+      return 0;
+    buffer->mData = data;
+    buffer->mCapacity = capacity;
+  }
+  memcpy(buffer->mData + buffer->mSize, aBuf, aCount);
+  buffer->mSize += aCount;
+  return aCount;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolRead() - CTMreadfn for a _CTMtoolbuffer.
+//-----------------------------------------------------------------------------
+static CTMuint CTMCALL _ctmToolRead(void * aBuf, CTMuint aCount,
+  void * aUserData)
+{
+  _CTMtoolbuffer * buffer = (_CTMtoolbuffer *) aUserData;
+  if(buffer->mOffset + aCount > buffer->mSize)
+    aCount = (CTMuint) (buffer->mSize - buffer->mOffset);
+  memcpy(aBuf, buffer->mData + buffer->mOffset, aCount);
+  buffer->mOffset += aCount;
+  return aCount;
+}
+
+//-----------------------------------------------------------------------------
+// _ctmToolEncode() - Encode a mesh into a buffer with the given method.
+// Returns the OpenCTM error, if any.
+//-----------------------------------------------------------------------------
+static CTMenum _ctmToolEncode(const _CTMtoolmesh * aMesh, CTMenum aMethod,
+  _CTMtoolbuffer * aBuffer)
+{
+  CTMenum error;
+  CTMcontext context = ctmNewContext(CTM_EXPORT);
+  ctmDefineMesh(context, aMesh->mVertices, aMesh->mVertexCount,
+    aMesh->mIndices, aMesh->mTriangleCount, aMesh->mNormals);
+  ctmAddUVMap(context, aMesh->mUVs, "uv", NULL);
+  ctmAddAttribMap(context, aMesh->mAttribs, "attrib");
+  ctmCompressionMethod(context, aMethod);
+  memset(aBuffer, 0, sizeof(_CTMtoolbuffer));
+  ctmSaveCustom(context, _ctmToolWrite, aBuffer);
+  error = ctmGetError(context);
+  ctmFreeContext(context);
+  return error;
+}
+
+#endif // __OPENCTM_TOOLS_H_